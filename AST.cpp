@@ -1,10 +1,19 @@
 /** @file AST.cpp
  @author Anthony Campos
  @date 12/07/2021
- This implementation file implements a Abstract Syntax Tree 
+ This implementation file implements a Abstract Syntax Tree
    that represents a postfix math expression */
 
 #include "AST.h"
+#include "VariableStore.h"
+#include "WorkStealingPool.h"
+#include "LineArena.h"
+#include "Stats.h"
+#include "Tracer.h"
+
+#include <functional>
+#include <limits>
+#include <new>
 
 
 /** AST Class  */
@@ -29,9 +38,10 @@ AST::AST(std::vector<Token>& postfixExpr)
 
 
 /** AST Copy Constructor*/
-AST::AST(const AST& sourceTree) {
-	// call helper method copyTree
-	root_ = copyTree(sourceTree.root_);
+AST::AST(const AST& sourceTree)
+	:root_(sourceTree.root_) {
+	// nodes are shared, only the reference count changes
+	retain(root_);
 
 } // end copy constructor
 
@@ -44,9 +54,10 @@ AST& AST::operator=(const AST& ast) {
 		return *this;
 	} // end if
 
-	// do copy
-	clearTree(root_);
-	root_ = copyTree(ast.root_);
+	// share the other tree, retain first in case both point at the same node
+	retain(ast.root_);
+	release(root_);
+	root_ = ast.root_;
 	// return the existing object so we can chain this operator
 	return *this;
 
@@ -54,8 +65,8 @@ AST& AST::operator=(const AST& ast) {
 
 /** AST copy destructor*/
 AST::~AST() {
-	// call helper method clearTree
-	clearTree(root_);
+	// drop this tree's reference to the shared nodes
+	release(root_);
 
 } // end of destructor
 
@@ -63,383 +74,1225 @@ AST::~AST() {
 std::string AST::toInfix() const {
 	//store string object
 	std::string str;
+	str.reserve(reserveSize());
 
 	//call toInFixHelper
-	toInfixHelper(root_, str);
+	toInfixHelper(str, nullptr);
 
 	return str; // return string created
 
 } // end of toInfix
 
+/** toInfix */
+void AST::toInfix(std::ostream& out) const {
+
+	Tracer::Span span("AST::toInfix");
+
+	std::string chunk;
+	toInfixHelper(chunk, &out);
+
+} // end of toInfix
+
+/** appendInfix */
+void AST::appendInfix(std::string& str) const {
+
+	str.reserve(str.size() + reserveSize());
+	toInfixHelper(str, nullptr);
+
+} // end of appendInfix
+
 /** toPostfix() */
 std::string AST::toPostfix() const {
 	//store string object
 	std::string str;
+	str.reserve(reserveSize());
 
 	//call toPostfixHelper
-	toPostfixHelper(root_, str);
+	toPostfixHelper(str, nullptr);
 
 	return str; // return string created
 } // end toPostfix
 
+/** toPostfix */
+void AST::toPostfix(std::ostream& out) const {
+
+	std::string chunk;
+	toPostfixHelper(chunk, &out);
+
+} // end of toPostfix
+
+/** appendPostfix */
+void AST::appendPostfix(std::string& str) const {
+
+	str.reserve(str.size() + reserveSize());
+	toPostfixHelper(str, nullptr);
+
+} // end of appendPostfix
+
 /** calculate */
-std::string AST::calculate() const {
+std::string AST::calculate(WorkStealingPool* pool) const {
 	// string to store answer
 	std::string answer = "";
-	std::stack<Token> answerStack;
-	calculateHelper(root_, answerStack);
-	
+
 	// safe guard
-	if (!answerStack.empty()) {
-		// answer should be only element in stack
-		answer = answerStack.top().getValue();
+	if (root_ != nullptr) {
+
+		Integer result;
+		Program::Status status = calculate(result, pool);
+		answer = resultToString(status, result);
+
 	} // end if
-	
+
 	return answer; // return answer
 
 } // end calculate
 
+/** calculate */
+Program::Status AST::calculate(Integer& result, WorkStealingPool* pool) const {
+
+	Stats::Timer timer(Stats::Stage::calculate);
+	Tracer::Span span("AST::calculate");
+
+	// a tree this large is worth the tasks, its size is known without a traversal
+	if (pool != nullptr && pool->size() > 1 && root_ != nullptr && root_->size_ >= parallelThreshold) {
+		return calculateParallel(result, *pool);
+	} // end if
+
+	// run a program instead of walking the tree, on int64 registers unless a
+	// result overflows. A root without a cached program is lowered into the
+	// thread's scratch program, so a line calculated once does not allocate one
+	thread_local Program scratchProgram;
+	const Program* programPtr = (root_ != nullptr) ? root_->program_.get() : &compile();
+
+	if (programPtr == nullptr) {
+		scratchProgram.clear();
+		lower(layout(), scratchProgram);
+		programPtr = &scratchProgram;
+	} // end if
+
+	const Program& program = *programPtr;
+	std::int64_t smallResult = 0;
+
+	if (program.runSmall(smallResult)) {
+		result = Integer(smallResult);
+		return Program::Status::ok;
+	} // end if
+
+	return program.runExact(result);
+
+} // end calculate
+
+/** calculateParallel */
+Program::Status AST::calculateParallel(Integer& result, WorkStealingPool& pool) const {
+
+	// subtrees of at most a grain become tasks, about eight per worker
+	const std::uint64_t grain = std::max<std::uint64_t>(parallelThreshold / 4, root_->size_ / (8 * pool.size()));
+
+	/** Part a task subtree, or an operator above the grain joining two earlier parts */
+	struct Part {
+		const Node* node_;
+		std::uint32_t left_;
+		std::uint32_t right_;
+		bool task_;
+		Integer value_;
+		Program::Status status_;
+	};
+
+	// parts in post order, a shared node is one part
+	std::vector<Part> parts;
+	std::vector<std::uint32_t> taskParts;
+	std::unordered_map<const Node*, std::uint32_t> partOf;
+
+	std::vector<std::pair<const Node*, bool>> steps;
+	std::vector<std::uint32_t> partStack;
+
+	steps.emplace_back(root_, false);
+
+	while (!steps.empty()) {
+
+		const Node* curPtr = steps.back().first;
+		bool childrenDone = steps.back().second;
+		steps.pop_back();
+
+		std::uint32_t index = static_cast<std::uint32_t>(parts.size());
+
+		if (!childrenDone) {
+
+			auto found = partOf.find(curPtr);
+			if (found != partOf.end()) {
+				partStack.push_back(found->second);
+				continue;
+			} // end if
+
+			// split an operator above the grain into its operands
+			if (curPtr->size_ > grain && isOperator(curPtr->tok_.getType())) {
+				steps.emplace_back(curPtr, true);
+				steps.emplace_back(curPtr->right_, false);
+				steps.emplace_back(curPtr->left_, false);
+				continue;
+			} // end if
+
+			parts.push_back({ curPtr, 0, 0, true, Integer(), Program::Status::ok });
+			taskParts.push_back(index);
+
+		}
+		else {
+
+			std::uint32_t right = partStack.back();
+			partStack.pop_back();
+			std::uint32_t left = partStack.back();
+			partStack.pop_back();
+
+			parts.push_back({ curPtr, left, right, false, Integer(), Program::Status::ok });
+
+		} // end if
+
+		partOf.emplace(curPtr, index);
+		partStack.push_back(index);
+
+	} // end while
+
+	// fork: each task compiles and runs its own program, the tree is only read
+	pool.run(taskParts.size(), [&](std::size_t task, std::size_t) {
+
+		Tracer::Span span("AST::calculateParallel task");
+		Part& part = parts[taskParts[task]];
+		Program program;
+		std::pmr::unordered_map<const Node*, std::uint32_t> registers(LineArena::resource());
+
+		compileHelper(part.node_, program, registers);
+		part.status_ = program.evaluate(part.value_);
+
+	});
+
+	// join: apply the operators above the grain in the order the whole program would
+	for (Part& part : parts) {
+
+		if (!part.task_) {
+			Program program;
+			std::uint32_t left = program.emitConst(parts[part.left_].value_);
+			std::uint32_t right = program.emitConst(parts[part.right_].value_);
+			program.emitOp(part.node_->tok_.getOp(), left, right);
+			part.status_ = program.evaluate(part.value_);
+		} // end if
+
+		if (part.status_ != Program::Status::ok) {
+			return part.status_;
+		} // end if
+
+	} // end for
+
+	result = parts.back().value_;
+	return Program::Status::ok;
+
+} // end of calculateParallel
+
+/** resultToString */
+std::string AST::resultToString(Program::Status status, const Integer& result) {
+
+	std::string answer;
+
+	if (status == Program::Status::divideByZero) {
+		answer = "Math Error, Division By Zero";
+	}
+	else if (status == Program::Status::tooLarge) {
+		answer = "Math Error, Result Too Large";
+	}
+	else {
+		result.appendTo(answer);
+	} // end if
+
+	return answer;
+
+} // end of resultToString
+
+/** compile */
+const Program& AST::compile() const {
+
+	static const Program emptyProgram;
+
+	if (root_ == nullptr) {
+		return emptyProgram;
+	} // end if
+
+	// compile once per root node
+	if (root_->program_ == nullptr) {
+		std::unique_ptr<Program> program(new Program());
+		lower(layout(), *program);
+		MemoryAccount::allocated(MemoryAccount::Origin::programs, program->memoryBytes());
+		root_->program_ = std::move(program);
+	} // end if
+
+	return *root_->program_;
+
+} // end of compile
+
 /** containsVariable */
 bool AST::containsVariable() const {
-	
+
 	// calls helper method
 	return containsVariable(root_);
 
 } // end of containsVariable
 
-/** AST mutators*/
+/** isVariable */
+bool AST::isVariable(std::uint32_t& symbol) const {
 
-/** build */
-bool AST::build(const std::vector<Token>& tokensToAdd) {
+	if (root_ != nullptr && root_->tok_.getType() == TokType::variable) {
+		symbol = root_->tok_.getSymbol();
+		return true;
+	} // end if
 
-	// base case
-	if (tokensToAdd.empty()) {
-		return false;
+	return false;
+
+} // end of isVariable
+
+/** variables */
+std::vector<std::uint32_t> AST::variables() const {
+
+	std::vector<std::uint32_t> symbols;
+
+	if (root_ == nullptr || !root_->hasVariable_) {
+		return symbols;
 	} // end if
 
-	// create an empty stack to store tree pointers
-	std::stack<Node*> nodeStack;
+	// variable leaves are shared, so each has one entry
+	for (const Entry& entry : layout().entries_) {
+		if (entry.tok_.getType() == TokType::variable) {
+			symbols.push_back(entry.tok_.getSymbol());
+		} // end if
+	} // end for
+
+	std::sort(symbols.begin(), symbols.end());
 
-	for (auto token : tokensToAdd) {
+	return symbols;
 
-		// if the current token is an operator
-		if (isOperator(token.getType())) {
+} // end of variables
+
+/** uniqueNodeCount */
+std::size_t AST::uniqueNodeCount() const {
+
+	// the layout holds each distinct node once
+	return (root_ != nullptr) ? layout().entries_.size() : 0;
+
+} // end of uniqueNodeCount
+
+/** expandedNodeCount */
+std::uint64_t AST::expandedNodeCount() const {
+
+	return (root_ != nullptr) ? root_->size_ : 0;
+
+} // end of expandedNodeCount
+
+/** liveNodeCount */
+std::size_t AST::liveNodeCount() {
 
-			Node* rightPtr = nodeStack.top();
-			nodeStack.pop();
+	return internTable().size();
 
-			Node* leftPtr = nodeStack.top();
-			nodeStack.pop();
+} // end of liveNodeCount
 
-			// construct a new binary tree whose root is the operator and whose
-			// left and right children point to `y` and `x`, respectively
-			Node* newNodePtr = new Node(token);
+/** memoryBytes */
+std::size_t AST::memoryBytes() const {
 
-			newNodePtr->right_ = rightPtr;
-			rightPtr = nullptr;
+	if (root_ == nullptr) {
+		return 0;
+	} // end if
+
+	const Layout& flat = layout();
+	std::size_t bytes = flat.entries_.size() * sizeof(Node) + sizeof(Layout) + flat.entries_.capacity() * sizeof(Entry);
+
+	if (root_->program_ != nullptr) {
+		bytes += root_->program_->memoryBytes();
+	} // end if
+
+	return bytes;
+
+} // end of memoryBytes
+
+/** AST mutators*/
+
+/** build */
+bool AST::build(const std::vector<Token>& tokensToAdd) {
 
-			newNodePtr->left_ = leftPtr;
-			leftPtr = nullptr;
+	Builder builder;
 
-			// push the current node onto the stack
-			nodeStack.push(newNodePtr);
-			newNodePtr = nullptr;
+	for (const Token& token : tokensToAdd) {
 
+		// if the current token is an operator, combine the top two nodes,
+		// otherwise push a leaf for the operand
+		if (isOperator(token.getType())) {
+			if (!builder.apply(token)) {
+				return false;
+			} // end if
 		}
 		else {
-			// if the current token is an operand, create a new binary tree node
-			// whose root is the operand and push it into the stack
-			nodeStack.push(new Node(token));
-
+			builder.operand(token);
 		} // end if
 
 	} // end for
 
-	root_ = nodeStack.top();
-
-	return true;
+	return builder.finish(*this);
 
 } // end build
 
-/** simplify */
-AST AST::simplify(std::map<std::string, AST>& variableStore) const {
+/** partialEvaluate */
+bool AST::partialEvaluate(VariableStore& variableStore, AST& residual, Integer& value, Program::Status& status,
+	WorkStealingPool* pool) const {
 
-	// search AST
-	// if varible found in variable store
-	// replace variable with expression stored in variable
-	AST newTree = *this;
-	// call helper method
-	simplifyHelper(newTree.root_, variableStore);
-	return newTree; // return new tree
+	Stats::Timer timer(Stats::Stage::simplify);
+	Tracer::Span span("AST::partialEvaluate");
 
-} // end of simplify
+	Partial result;
 
-/** AST Class private methods */
+	if (root_ != nullptr) {
+		partialEvaluateHelper(root_, variableStore, pool, result);
+	} // end if
 
-/** getHeightHelper */
-int AST::getHeightHelper(const Node* subTreePtr) const {
+	// the residual tree takes the reference the caller owns
+	const Node* residualPtr = (root_ != nullptr) ? materialize(result) : nullptr;
+	release(residual.root_);
+	residual.root_ = residualPtr;
+	release(result.node_);
 
-	// base case
-	if (subTreePtr == nullptr) {
-		return 0;
-	}
-	else {
-		return 1 + std::max(getHeightHelper(subTreePtr->left_), getHeightHelper(subTreePtr->right_));
+	value = result.value_;
+	status = result.status_;
+
+	return result.closed_;
+
+} // end of partialEvaluate
+
+/** flatten */
+const std::pmr::vector<AST::Entry>& AST::flatten() const {
+
+	static const std::pmr::vector<Entry> noEntries;
+
+	return (root_ != nullptr) ? layout().entries_ : noEntries;
+
+} // end of flatten
+
+/** fromEntries */
+AST AST::fromEntries(const Entry* entries, std::size_t count) {
+
+	AST newTree;
+
+	if (count == 0) {
+		return newTree;
 	} // end if
 
-} // end of getHeightHelper
+	// node of each entry, each holding a reference until the tree is built
+	std::pmr::vector<const Node*> nodes(LineArena::resource());
+	nodes.reserve(count);
+
+	for (std::size_t i = 0; i < count; ++i) {
+
+		const Entry& entry = entries[i];
+		bool isOp = isOperator(entry.tok_.getType());
+
+		nodes.push_back(makeNode(entry.tok_, isOp ? nodes[entry.left_] : nullptr, isOp ? nodes[entry.right_] : nullptr));
+
+	} // end for
+
+	// the root's reference is handed to the tree, the others are dropped
+	newTree.root_ = nodes.back();
+	nodes.pop_back();
+
+	for (const Node* nodePtr : nodes) {
+		release(nodePtr);
+	} // end for
+
+	return newTree;
+
+} // end of fromEntries
+
+/** AST Class private methods */
+
+/** precedence */
+int AST::precedence(const Token& tok) {
+
+	switch (tok.getOp()) {
+	case OpCode::add:
+	case OpCode::sub:
+		return 1;
+	case OpCode::mul:
+	case OpCode::div:
+		return 2;
+	case OpCode::pow:
+		return 3;
+	default:
+		return 4;
+	} // end switch
+
+} // end of precedence
+
+/** reserveSize */
+std::size_t AST::reserveSize() const {
+
+	// most tokens print as a character or two plus a space, large trees
+	// grow the buffer as usual past the cap
+	const std::uint64_t maxReserve = std::uint64_t(1) << 24;
+
+	return static_cast<std::size_t>(std::min(expandedNodeCount() * 3, maxReserve));
+
+} // end of reserveSize
 
 /** isOperator */
-bool AST::isOperator(const TokType& type) const {
+bool AST::isOperator(const TokType& type) {
 
 	return (type == TokType::addminusop || type == TokType::muldivop || type == TokType::powop);
 
 } // end for isOperator
 
-/** copyTree */
+/** internTable */
+std::pmr::unordered_multimap<std::size_t, const AST::Node*>& AST::internTable() {
+
+	thread_local std::pmr::unordered_multimap<std::size_t, const Node*> table(&nodeResource(MemoryAccount::Origin::internTable));
+	return table;
+
+} // end of internTable
+
+/** nodeResource */
+std::pmr::memory_resource& AST::nodeResource(MemoryAccount::Origin origin) {
+
+	// the heap the pool holds is counted as the node pool, and what it hands
+	// out is counted under the origin asked for
+	thread_local MemoryAccount::Resource heap(MemoryAccount::Origin::nodePool, std::pmr::new_delete_resource());
+	thread_local std::pmr::unsynchronized_pool_resource pool(&heap);
+	thread_local MemoryAccount::Resource nodes(MemoryAccount::Origin::nodes, &pool);
+	thread_local MemoryAccount::Resource layouts(MemoryAccount::Origin::layouts, &pool);
+	thread_local MemoryAccount::Resource entries(MemoryAccount::Origin::internTable, &pool);
 
+	switch (origin) {
+	case MemoryAccount::Origin::layouts:
+		return layouts;
+	case MemoryAccount::Origin::internTable:
+		return entries;
+	default:
+		return nodes;
+	} // end switch
+
+} // end of nodeResource
 
+/** makeNode */
+const AST::Node* AST::makeNode(const Token& tok, const Node* left, const Node* right) {
 
-AST::Node* AST::copyTree(const Node* oldTreePtr) const {
+	// key on the token and the identity of the already unique children
+	std::size_t hash = tok.payloadHash();
+	hash ^= (static_cast<std::size_t>(tok.getType()) << 16 | static_cast<std::size_t>(tok.getOp()) << 8 | static_cast<std::size_t>(tok.isBigNumber()))
+		+ 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<const Node*>()(left) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	hash ^= std::hash<const Node*>()(right) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
 
-	//initilaize new node for the new tree. 
-	Node* newTreePtr = (oldTreePtr != nullptr) ? new Node(oldTreePtr->tok_) : nullptr;
-	// copy tree nodes during a preorder traversal
+	auto& table = internTable();
+	auto range = table.equal_range(hash);
 
-	if (oldTreePtr != nullptr) {
-		
-		// copy node
-		newTreePtr->left_ = copyTree(oldTreePtr->left_);
-		newTreePtr->right_ = copyTree(oldTreePtr->right_);
+	for (auto it = range.first; it != range.second; ++it) {
 
+		const Node* candidate = it->second;
+		if (candidate->left_ == left && candidate->right_ == right &&
+			candidate->tok_.getType() == tok.getType() && candidate->tok_.getOp() == tok.getOp() &&
+			candidate->tok_.samePayload(tok)) {
+			// structurally identical node exists, share it
+			Stats::add(Stats::Counter::nodesShared);
+			retain(candidate);
+			return candidate;
+		} // end if
+
+	} // end for
+
+	// new node holds a reference to each child
+	Stats::add(Stats::Counter::nodesCreated);
+	retain(left);
+	retain(right);
+	const Node* newNodePtr = new (nodeResource().allocate(sizeof(Node), alignof(Node))) Node(tok, left, right, hash);
+	table.emplace(hash, newNodePtr);
+
+	return newNodePtr;
+
+} // end of makeNode
+
+/** retain */
+void AST::retain(const Node* nodePtr) {
+
+	if (nodePtr != nullptr) {
+		++nodePtr->refCount_;
+	} // end if
+
+} // end of retain
+
+/** release */
+void AST::release(const Node* nodePtr) {
+
+	if (nodePtr == nullptr || --nodePtr->refCount_ != 0) {
+		return;
 	} // end if
-	// else tree is empty (newTreePtr is nullptr)
 
-	return newTreePtr;
+	// nodes whose last reference is gone, freed from a worklist so a long
+	// chain does not recurse once per level
+	std::pmr::vector<const Node*> deadNodes(1, nodePtr, LineArena::resource());
+	auto& table = internTable();
+
+	while (!deadNodes.empty()) {
+
+		const Node* deadPtr = deadNodes.back();
+		deadNodes.pop_back();
 
-} // end copyTree
+		// remove the node from the intern table
+		auto range = table.equal_range(deadPtr->hash_);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == deadPtr) {
+				table.erase(it);
+				break;
+			} // end if
+		} // end for
 
-/** clearTree */
-void AST::clearTree(Node*& subTreePtr) {
+		for (const Node* childPtr : { deadPtr->left_, deadPtr->right_ }) {
+			if (childPtr != nullptr && --childPtr->refCount_ == 0) {
+				deadNodes.push_back(childPtr);
+			} // end if
+		} // end for
 
-	// made it passed by reference
+		// release memory back to the pool
+		deadPtr->~Node();
+		nodeResource().deallocate(const_cast<Node*>(deadPtr), sizeof(Node), alignof(Node));
 
-	if (subTreePtr != nullptr) {
-		
-		clearTree(subTreePtr->left_);
-		clearTree(subTreePtr->right_);
-		
-		// release memory
-		delete subTreePtr;
-		subTreePtr = nullptr;
+	} // end while
 
+} // end of release
+
+/** layout */
+const AST::Layout& AST::layout() const {
+
+	if (root_->layout_ != nullptr) {
+		return *root_->layout_;
 	} // end if
 
-} // end clearTree
+	// the layout and its entries come from the node pool, so the layout of a
+	// line's tree reuses the memory of the previous line's
+	std::pmr::memory_resource& resource = nodeResource(MemoryAccount::Origin::layouts);
+	Layout* flatPtr = new (resource.allocate(sizeof(Layout), alignof(Layout))) Layout(&resource);
+	std::pmr::vector<Entry>& entries = flatPtr->entries_;
+
+	// entry index of each shared node already flattened
+	std::pmr::unordered_map<const Node*, std::uint32_t> indexOf(LineArena::resource());
+
+	// nodes still to visit, an operator is pushed a second time marked true
+	// to append it once both operand indices are on the index stack
+	std::pmr::vector<std::pair<const Node*, bool>> steps(LineArena::resource());
+	std::pmr::vector<std::uint32_t> operandIndices(LineArena::resource());
+
+	steps.emplace_back(root_, false);
+
+	while (!steps.empty()) {
 
-/** doMath */
-std::string AST::doMath(const Token& tokenOptr, const Token& leftOperand, const Token& rightOperand) const {
+		const Node* curPtr = steps.back().first;
+		bool operandsDone = steps.back().second;
+		steps.pop_back();
 
-	// stores result of the evaluation 
-	int result = 0;
-	// converts the provided string objects to int
-	int leftOp = std::stoi(leftOperand.getValue());
-	int rightOp = std::stoi(rightOperand.getValue());
+		std::uint32_t index = static_cast<std::uint32_t>(entries.size());
+
+		if (!operandsDone) {
+
+			// shared subtree already flattened
+			if (curPtr->refCount_ > 1) {
+				auto found = indexOf.find(curPtr);
+				if (found != indexOf.end()) {
+					operandIndices.push_back(found->second);
+					continue;
+				} // end if
+			} // end if
+
+			if (isOperator(curPtr->tok_.getType())) {
+				steps.emplace_back(curPtr, true);
+				steps.emplace_back(curPtr->right_, false);
+				steps.emplace_back(curPtr->left_, false);
+				continue;
+			} // end if
+
+			entries.push_back({ curPtr->tok_, 0, 0 });
 
-	// switch to determine operation to use. 
-	switch (tokenOptr.getType())
-	{
-	case TokType::addminusop:
-		//do + or -
-		if (tokenOptr.getValue() != "-") {
-			result += (leftOp + rightOp);
 		}
 		else {
-			result += (leftOp - rightOp);
+
+			std::uint32_t right = operandIndices.back();
+			operandIndices.pop_back();
+			std::uint32_t left = operandIndices.back();
+			operandIndices.pop_back();
+
+			entries.push_back({ curPtr->tok_, left, right });
+
 		} // end if
-		break;
-	case TokType::muldivop:
-		//do * or /
-		if (tokenOptr.getValue() != "/") {
-			result += (leftOp * rightOp);
-		}
-		else {
-			result += (leftOp / rightOp);
-		}// end if
-		break;
-	case TokType::powop:
-		// do ^ 
-		result += static_cast<int>(pow(leftOp, rightOp));
-	default:
-		break;
-	} // end switch
 
-	// convert int back to string and return
-	return std::to_string(result);
-} // end of doMath
+		// only shared nodes can be reached again
+		if (curPtr->refCount_ > 1) {
+			indexOf.emplace(curPtr, index);
+		} // end if
+
+		operandIndices.push_back(index);
+
+	} // end while
+
+	// with nothing shared every node of the expanded tree has its own entry
+	flatPtr->tree_ = (entries.size() == root_->size_);
+	root_->layout_ = flatPtr;
+
+	return *flatPtr;
+
+} // end of layout
+
+/** lower */
+void AST::lower(const Layout& flat, Program& program) {
+
+	// operands come before their operator, so each entry's registers exist when it is emitted
+	for (const Entry& entry : flat.entries_) {
+
+		switch (entry.tok_.getType()) {
+		case TokType::addminusop:
+		case TokType::muldivop:
+		case TokType::powop:
+			program.emitOp(entry.tok_.getOp(), entry.left_, entry.right_);
+			break;
+		case TokType::variable:
+			program.emitVar(entry.tok_.getSymbol());
+			break;
+		default:
+			program.emitConst(entry.tok_.getInteger());
+			break;
+		} // end switch
+
+	} // end for
+
+} // end of lower
 
 /** containsVariable */
 bool AST::containsVariable(const Node* treePtr) const {
 
-	if (treePtr == nullptr) {
-		return false;
-	}
-	else if (treePtr->tok_.getType() == TokType::variable) {
-		return true;
-	} // search left child
-	else if (containsVariable(treePtr->left_)) {
-		return true;
-	}
-	else { // search right child
-		return containsVariable(treePtr->right_);
-	} // end if
+	// shared subtrees would be searched once per path, so each node
+	// records whether its subtree has a variable when it is created
+	return treePtr != nullptr && treePtr->hasVariable_;
 
-} // end of containsVariable 
+} // end of containsVariable
 
-/** replace */
-void AST::replace(Node*& subTreePtr, const Node* insertPtr) const {
+/** toInfixHelper */
+void AST::toInfixHelper(std::string& str, std::ostream* out) const {
 
-	// if node exisit replace values in node
-	if (subTreePtr != nullptr) {
-		subTreePtr->tok_.setValue(insertPtr->tok_.getValue());
-		subTreePtr->tok_.setType(insertPtr->tok_.getType());
-	} // end if
+	// bytes held before a streamed chunk is written out
+	const std::size_t chunkSize = 8192;
 
-	// if no node create a node to insert into tree
-	if (subTreePtr == nullptr) {
-		Node* newNode = new Node(insertPtr->tok_);
-		subTreePtr = newNode;
+	enum class Action : std::uint8_t { expand, expandParens, token, open, close };
 
-	} // end if
+	struct Step {
+		std::uint32_t index_;
+		Action action_;
+	};
 
-	// replace left node 
-	if (insertPtr != nullptr && insertPtr->left_ != nullptr) {
-		replace(subTreePtr->left_, insertPtr->left_);
-	}
-	// replace right node
-	if (insertPtr != nullptr && insertPtr->right_ != nullptr) {
-		replace(subTreePtr->right_, insertPtr->right_);
+	if (root_ == nullptr) {
+		return;
 	} // end if
 
-} // end replace
+	const std::pmr::vector<Entry>& entries = layout().entries_;
 
-/** toInfixHelper */
-void AST::toInfixHelper(const Node* treePtr, std::string& str) const {
+	// steps still to print, most recent last, so each node is visited once
+	std::pmr::vector<Step> steps(LineArena::resource());
+	bool first = true;
+
+	steps.push_back({ static_cast<std::uint32_t>(entries.size() - 1), Action::expand });
+
+	while (!steps.empty()) {
 
-	if (treePtr != nullptr) {
+		Step step = steps.back();
+		steps.pop_back();
 
-		TokType curTokenType = treePtr->tok_.getType();
-		//if token is a operator insert '('
+		const Entry& cur = entries[step.index_];
 
-		if (isOperator(curTokenType) && curTokenType != TokType::powop && getHeightHelper(treePtr) != getHeightHelper(root_)) {
+		if ((step.action_ == Action::expand || step.action_ == Action::expandParens) && isOperator(cur.tok_.getType())) {
 
-			str += "( ";
+			// every operator is left associative, so a right operand of
+			// equal precedence needs parentheses and a left one does not
+			int rank = precedence(cur.tok_);
 
+			if (step.action_ == Action::expandParens) {
+				steps.push_back({ step.index_, Action::close });
+			} // end if
+			steps.push_back({ cur.right_, precedence(entries[cur.right_].tok_) <= rank ? Action::expandParens : Action::expand });
+			steps.push_back({ step.index_, Action::token });
+			steps.push_back({ cur.left_, precedence(entries[cur.left_].tok_) < rank ? Action::expandParens : Action::expand });
+			if (step.action_ == Action::expandParens) {
+				steps.push_back({ step.index_, Action::open });
+			} // end if
+
+			continue;
 		} // end if
 
-		toInfixHelper(treePtr->left_, str);
+		if (!first) {
+			str += ' ';
+		} // end if
+		first = false;
 
-		str += treePtr->tok_.getValue() + " ";
-		
-		toInfixHelper(treePtr->right_, str);
-		//if token is a operator insert ')'
-		if (isOperator(curTokenType) && curTokenType != TokType::powop && getHeightHelper(treePtr) != getHeightHelper(root_)) {
-			str += ") ";
+		if (step.action_ == Action::open) {
+			str += '(';
+		}
+		else if (step.action_ == Action::close) {
+			str += ')';
+		}
+		else {
+			cur.tok_.appendTo(str);
+		} // end if
 
+		if (out != nullptr && str.size() >= chunkSize) {
+			out->write(str.data(), static_cast<std::streamsize>(str.size()));
+			str.clear();
 		} // end if
 
+	} // end while
+
+	if (out != nullptr) {
+		out->write(str.data(), static_cast<std::streamsize>(str.size()));
+		str.clear();
 	} // end if
 
 } // end of toInfixHelper
 
 /** toPostfixHelper */
-void AST::toPostfixHelper(const Node* treePtr, std::string& str) const {
-	
-	if (treePtr != nullptr) {
+void AST::toPostfixHelper(std::string& str, std::ostream* out) const {
+
+	// bytes held before a streamed chunk is written out
+	const std::size_t chunkSize = 8192;
+
+	if (root_ == nullptr) {
+		return;
+	} // end if
 
-		toPostfixHelper(treePtr->left_, str);
-		toPostfixHelper(treePtr->right_, str);
+	const Layout& flat = layout();
+	const std::pmr::vector<Entry>& entries = flat.entries_;
+	bool first = true;
 
-		str += treePtr->tok_.getValue();
+	// appends an entry's token, writing full chunks out
+	auto appendEntry = [&](const Entry& entry) {
 
-		if (getHeightHelper(treePtr) != 0) {
+		if (!first) {
+			str += ' ';
+		} // end if
+		first = false;
 
-			str += " ";
+		entry.tok_.appendTo(str);
 
+		if (out != nullptr && str.size() >= chunkSize) {
+			out->write(str.data(), static_cast<std::streamsize>(str.size()));
+			str.clear();
 		} // end if
 
+	};
+
+	if (flat.tree_) {
+
+		// nothing is shared, so the entries already are the postfix order
+		for (const Entry& entry : entries) {
+			appendEntry(entry);
+		} // end for
+
+	}
+	else {
+
+		// entries still to print, an operator is pushed a second time marked
+		// true so its token follows both operands
+		std::pmr::vector<std::pair<std::uint32_t, bool>> steps(LineArena::resource());
+		steps.emplace_back(static_cast<std::uint32_t>(entries.size() - 1), false);
+
+		while (!steps.empty()) {
+
+			std::pair<std::uint32_t, bool> step = steps.back();
+			steps.pop_back();
+
+			const Entry& cur = entries[step.first];
+
+			if (!step.second && isOperator(cur.tok_.getType())) {
+				steps.emplace_back(step.first, true);
+				steps.emplace_back(cur.right_, false);
+				steps.emplace_back(cur.left_, false);
+				continue;
+			} // end if
+
+			appendEntry(cur);
+
+		} // end while
+
+	} // end if
+
+	if (out != nullptr) {
+		out->write(str.data(), static_cast<std::streamsize>(str.size()));
+		str.clear();
 	} // end if
 
 } // end of toPostfixHelper
 
 
-/** calculateHelper */
-void AST::calculateHelper(const Node* treePtr, std::stack<Token>& tokenStack) const {
+/** compileHelper */
+std::uint32_t AST::compileHelper(const Node* treePtr, Program& program, std::pmr::unordered_map<const Node*, std::uint32_t>& registers) const {
+
+	// nodes still to visit, an operator is pushed a second time marked true
+	// to emit it once both operand registers are on the register stack
+	std::pmr::vector<std::pair<const Node*, bool>> steps(LineArena::resource());
+	std::pmr::vector<std::uint32_t> operandRegs(LineArena::resource());
+
+	steps.emplace_back(treePtr, false);
+
+	while (!steps.empty()) {
 
-	if (treePtr != nullptr) {
+		const Node* curPtr = steps.back().first;
+		bool operandsDone = steps.back().second;
+		steps.pop_back();
 
-		calculateHelper(treePtr->left_, tokenStack);
-		calculateHelper(treePtr->right_, tokenStack);
-		// if current node is an operand, pop off operands on the stack for use
-		if (isOperator(treePtr->tok_.getType())) {
+		std::uint32_t reg = 0;
 
-			// get left and right operands
-			Token leftOp = tokenStack.top();
-			tokenStack.pop();
+		if (!operandsDone) {
 
-			Token rightOp = tokenStack.top();
-			tokenStack.pop();
-									
-			// create a node for our answer
-			Token answerToken;
-			answerToken.setValue(doMath(treePtr->tok_, rightOp, leftOp));
+			// shared subtree already emitted
+			if (curPtr->refCount_ > 1) {
+				auto found = registers.find(curPtr);
+				if (found != registers.end()) {
+					operandRegs.push_back(found->second);
+					continue;
+				} // end if
+			} // end if
+
+			// if current node is an operator, emit its operands first
+			if (isOperator(curPtr->tok_.getType())) {
+				steps.emplace_back(curPtr, true);
+				steps.emplace_back(curPtr->right_, false);
+				steps.emplace_back(curPtr->left_, false);
+				continue;
+			} // end if
+
+			if (curPtr->tok_.getType() == TokType::variable) {
+				reg = program.emitVar(curPtr->tok_.getSymbol());
+			}
+			else {
+				// if the current token is a number
+				reg = program.emitConst(curPtr->tok_.getInteger());
+			} // end if
 
-			// push the answer token onto the stack
-			tokenStack.push(answerToken);
-			
 		}
 		else {
-			// if the current token is an operand
-			tokenStack.push(treePtr->tok_);
+
+			std::uint32_t rightReg = operandRegs.back();
+			operandRegs.pop_back();
+			std::uint32_t leftReg = operandRegs.back();
+			operandRegs.pop_back();
+
+			reg = program.emitOp(curPtr->tok_.getOp(), leftReg, rightReg);
+
 		} // end if
-		
-	} // end if
-	
-} // end of calculateHelper
 
-/** simplifyHelper */
-void AST::simplifyHelper(Node*& treePtr, const std::map<std::string, AST>& variableStore) const{
-	// create iterator to search variableStore
-	std::map<std::string, AST>::const_iterator it;
+		// only shared nodes can be reached again
+		if (curPtr->refCount_ > 1) {
+			registers.emplace(curPtr, reg);
+		} // end if
+
+		operandRegs.push_back(reg);
+
+	} // end while
+
+	return operandRegs.back();
+
+} // end of compileHelper
+
+/** partialEvaluateHelper */
+void AST::partialEvaluateHelper(const Node* treePtr, VariableStore& variableStore, WorkStealingPool* pool, Partial& result) {
+
+	// nodes still to visit, an operator is pushed a second time marked true
+	// to combine its operands once both are on the result stack, each entry of
+	// the result stack and of done owns one reference to its node
+	std::pmr::vector<std::pair<const Node*, bool>> steps(LineArena::resource());
+	std::pmr::vector<Partial> results(LineArena::resource());
+	std::pmr::unordered_map<const Node*, Partial> done(LineArena::resource());
+
+	// cleared once a large subtree does not fold, so its own large subtrees are not calculated again
+	bool calculateLarge = pool != nullptr && pool->size() > 1;
+
+	steps.emplace_back(treePtr, false);
+
+	while (!steps.empty()) {
+
+		const Node* curPtr = steps.back().first;
+		bool operandsDone = steps.back().second;
+		steps.pop_back();
+
+		Partial part;
+
+		if (!operandsDone) {
+
+			// shared subtree already evaluated, a node with one reference can only be reached once
+			auto found = (curPtr->refCount_ > 1) ? done.find(curPtr) : done.end();
+			if (found != done.end()) {
+				retain(found->second.node_);
+				results.push_back(found->second);
+				continue;
+			} // end if
+
+			bool isOperatorNode = curPtr->left_ != nullptr && curPtr->right_ != nullptr;
+			bool descend = isOperatorNode;
+
+			if (isOperatorNode && calculateLarge && !curPtr->hasVariable_ && curPtr->size_ >= parallelThreshold) {
+
+				// a large subtree without variables is calculated across the workers as a whole,
+				// one that has no value is evaluated node by node like any other
+				AST subtree;
+				retain(curPtr);
+				subtree.root_ = curPtr;
+				part.status_ = subtree.calculate(part.value_, pool);
+				descend = (part.status_ != Program::Status::ok);
+
+				if (descend) {
+					part = Partial();
+					calculateLarge = false;
+				} // end if
+
+			} // end if
+
+			if (descend) {
+
+				// evaluate both children first
+				steps.emplace_back(curPtr, true);
+				steps.emplace_back(curPtr->right_, false);
+				steps.emplace_back(curPtr->left_, false);
+				continue;
+
+			}
+			else if (curPtr->tok_.getType() == TokType::number) {
+
+				retain(curPtr);
+				part.node_ = curPtr;
+				part.value_ = curPtr->tok_.getInteger();
+
+			}
+			else if (curPtr->tok_.getType() == TokType::variable) {
 
-	// base case
-	if (treePtr == nullptr) {	
+				std::uint32_t symbol = curPtr->tok_.getSymbol();
+
+				if (variableStore.value(symbol, part.value_, part.status_)) {
+
+					// a closed variable is its value, unless it has none
+					if (part.status_ != Program::Status::ok) {
+						part.node_ = variableStore.substituted(symbol)->root_;
+					} // end if
+
+					Stats::add(Stats::Counter::substitutions);
+
+				}
+				else if (const AST* substitutedExpress = variableStore.substituted(symbol)) {
+
+					// replace the variable with its cached substituted expression
+					part.closed_ = false;
+					part.node_ = substitutedExpress->root_;
+					Stats::add(Stats::Counter::substitutions);
+
+				}
+				else {
+
+					// an unassigned variable is its own value
+					part.closed_ = false;
+					part.node_ = curPtr;
+
+				} // end if
+
+				retain(part.node_);
+
+			}
+			else if (!isOperatorNode) {
+
+				retain(curPtr);
+				part.node_ = curPtr;
+				part.closed_ = false;
+
+			} // end if
+
+		}
+		else {
+
+			Partial right = std::move(results.back());
+			results.pop_back();
+			Partial left = std::move(results.back());
+			results.pop_back();
+
+			part.closed_ = left.closed_ && right.closed_;
+
+			if (part.closed_) {
+				fold(curPtr->tok_.getOp(), left, right, part);
+			} // end if
+
+			// an open or failed subtree is kept as an operator over its evaluated operands
+			if (!part.closed_ || part.status_ != Program::Status::ok) {
+
+				const Node* leftPtr = materialize(left);
+				const Node* rightPtr = materialize(right);
+
+				if (leftPtr == curPtr->left_ && rightPtr == curPtr->right_) {
+					// nothing replaced, reuse this node
+					retain(curPtr);
+					part.node_ = curPtr;
+				}
+				else {
+					part.node_ = makeNode(curPtr->tok_, leftPtr, rightPtr);
+				} // end if
+
+				release(leftPtr);
+				release(rightPtr);
+
+			} // end if
+
+			release(left.node_);
+			release(right.node_);
+
+		} // end if
+
+		if (curPtr->refCount_ > 1) {
+			retain(part.node_);
+			done.emplace(curPtr, part);
+		} // end if
+
+		results.push_back(std::move(part));
+
+	} // end while
+
+	for (auto& entry : done) {
+		release(entry.second.node_);
+	} // end for
+
+	result = std::move(results.back());
+
+} // end of partialEvaluateHelper
+
+/** fold */
+void AST::fold(OpCode op, const Partial& left, const Partial& right, Partial& result) {
+
+	// the operand evaluated first reports its error first, as the program would
+	if (left.status_ != Program::Status::ok || right.status_ != Program::Status::ok) {
+		result.status_ = (left.status_ != Program::Status::ok) ? left.status_ : right.status_;
 		return;
 	} // end if
 
-	if (treePtr->tok_.getType() == TokType::variable) {
-		
-		// search variable store for the given variable in the current expression
-		it = variableStore.find(treePtr->tok_.getValue());
-
-		// if iterator does not equal end, variable found
-		if (it != variableStore.end()) {
-			// replace the variable with its expression
-			replace(treePtr, it->second.root_);
+	switch (op) {
+	case OpCode::add:
+		result.value_ = Integer::add(left.value_, right.value_);
+		break;
+	case OpCode::sub:
+		result.value_ = Integer::sub(left.value_, right.value_);
+		break;
+	case OpCode::mul:
+		result.value_ = Integer::mul(left.value_, right.value_);
+		break;
+	case OpCode::div:
+		if (!Integer::div(left.value_, right.value_, result.value_)) {
+			result.status_ = Program::Status::divideByZero;
+		} // end if
+		break;
+	case OpCode::pow:
+		if (!Integer::pow(left.value_, right.value_, result.value_, Program::maxResultBits)) {
+			result.status_ = Program::Status::tooLarge;
 		} // end if
+		break;
+	default:
+		break;
+	} // end switch
+
+} // end of fold
+
+/** materialize */
+const AST::Node* AST::materialize(const Partial& partial) {
+
+	if (partial.node_ != nullptr) {
+		retain(partial.node_);
+		return partial.node_;
 	} // end if
 
-	// search down left child
-	if (treePtr != nullptr && treePtr->left_ != nullptr) {
-		simplifyHelper(treePtr->left_, variableStore);
+	// only closed subtrees with a value fold, so the leaf is that value
+	Token tok(TokType::number);
+
+	if (!partial.value_.isNegative()) {
+		tok.setInteger(partial.value_);
+		return makeNode(tok, nullptr, nullptr);
 	} // end if
 
-	// search down right child
-	if(treePtr != nullptr && treePtr->right_ != nullptr){ // search right tree
-		simplifyHelper(treePtr->right_, variableStore);
+	// a number token cannot be negative, so a negative value is 0 minus its magnitude
+	const Node* zeroPtr = makeNode(tok, nullptr, nullptr);
+	tok.setInteger(Integer::sub(Integer(0), partial.value_));
+	const Node* magnitudePtr = makeNode(tok, nullptr, nullptr);
+	const Node* differencePtr = makeNode(Token(TokType::addminusop, OpCode::sub), zeroPtr, magnitudePtr);
+
+	release(zeroPtr);
+	release(magnitudePtr);
+
+	return differencePtr;
+
+} // end of materialize
+
+
+/** Builder Class  */
+
+/** Builder destructor */
+AST::Builder::~Builder() {
+
+	clear();
+
+} // end of Builder destructor
+
+/** operand */
+void AST::Builder::operand(const Token& tok) {
+
+	// find or create the leaf node and push it
+	nodes_.push_back(makeNode(tok, nullptr, nullptr));
+
+} // end of operand
+
+/** apply */
+bool AST::Builder::apply(const Token& tok) {
+
+	if (nodes_.size() < 2) {
+		return false;
 	} // end if
 
-} // end of simplifyHelper
+	const Node* rightPtr = nodes_.back();
+	nodes_.pop_back();
+	const Node* leftPtr = nodes_.back();
+
+	// find or construct the node whose root is the operator and whose
+	// left and right children are the top two nodes
+	nodes_.back() = makeNode(tok, leftPtr, rightPtr);
+
+	// the new node holds its own references to its children
+	release(leftPtr);
+	release(rightPtr);
+
+	return true;
+
+} // end of apply
+
+/** finish */
+bool AST::Builder::finish(AST& tree) {
+
+	if (nodes_.size() != 1) {
+		clear();
+		return false;
+	} // end if
+
+	// the pushed reference is handed to the tree
+	release(tree.root_);
+	tree.root_ = nodes_.back();
+	nodes_.clear();
+
+	return true;
+
+} // end of finish
+
+/** clear */
+void AST::Builder::clear() {
+
+	for (const Node* nodePtr : nodes_) {
+		release(nodePtr);
+	} // end for
+	nodes_.clear();
+
+} // end of clear
 
 
 /** Node Class  */
@@ -447,8 +1300,41 @@ void AST::simplifyHelper(Node*& treePtr, const std::map<std::string, AST>& varia
 /** Node Class public methods */
 
 /** Node Constructor */
-AST::Node::Node(Token t) 
-:tok_(t), left_(nullptr), right_(nullptr){
+AST::Node::Node(const Token& t, const Node* left, const Node* right, std::size_t hash)
+:tok_(t), left_(left), right_(right), hash_(hash), size_(1), hasVariable_(t.getType() == TokType::variable), refCount_(1), layout_(nullptr) {
+
+	const std::uint64_t maxSize = std::numeric_limits<std::uint64_t>::max();
+
+	// add the children's sizes, saturating for very deep shared chains
+	for (const Node* childPtr : { left, right }) {
+		if (childPtr != nullptr) {
+			size_ = (childPtr->size_ > maxSize - size_) ? maxSize : size_ + childPtr->size_;
+			hasVariable_ = hasVariable_ || childPtr->hasVariable_;
+		} // end if
+	} // end for
+
 } // end of Node Constructor
 
-/** Node Class private methods */
\ No newline at end of file
+/** Node Destructor */
+AST::Node::~Node() {
+
+	if (layout_ != nullptr) {
+		layout_->~Layout();
+		nodeResource(MemoryAccount::Origin::layouts).deallocate(layout_, sizeof(Layout), alignof(Layout));
+	} // end if
+
+	if (program_ != nullptr) {
+		MemoryAccount::deallocated(MemoryAccount::Origin::programs, program_->memoryBytes());
+	} // end if
+
+} // end of Node Destructor
+
+/** Node Class private methods */
+
+
+/** Layout Class  */
+
+/** Layout Constructor */
+AST::Layout::Layout(std::pmr::memory_resource* resource)
+	:entries_(resource), tree_(false) {
+} // end of Layout Constructor
@@ -1,13 +1,15 @@
 /** @file AST.h
  @author Anthony Campos
  @date 12/07/2021
- This header class file implements a Abstract Syntax Tree 
+ This header class file implements a Abstract Syntax Tree
  that represents a postfix math expression */
 
 #pragma once
 
 // included classes
 #include "Token.h"
+#include "Program.h"
+#include "MemoryAccount.h"
 
 // included libraries
 #include <vector>
@@ -15,9 +17,26 @@
 #include <iostream>
 #include <stack>
 #include <map>
-
-
-/** Abstract Syntax Tree Class*/
+#include <unordered_map>
+#include <memory_resource>
+#include <memory>
+#include <cstdint>
+
+class VariableStore;
+class WorkStealingPool;
+
+
+/** Abstract Syntax Tree Class
+ Nodes are immutable and hash-consed: structurally identical subtrees are
+ stored once in a shared intern table and reference counted, so an AST is
+ a DAG and copying one is O(1). The intern table is per thread, so an AST
+ must be built, copied and released on one thread. The first traversal of
+ a root flattens its distinct nodes into a contiguous post order Layout of
+ compact entries addressed by index, cached on the root, and printing,
+ compiling and listing variables scan that array instead of chasing node
+ pointers. Every traversal keeps its pending nodes on an explicit stack, so
+ machine generated expressions hundreds of thousands of levels deep do not
+ overflow the call stack.*/
 class AST {
 
 public:
@@ -42,122 +61,354 @@ public:
    @return AST oject is now equal to right hand AST boject*/
    AST& operator=(const AST& ast);
 
-   /** toInfix builds a string object in infix form of the AST object 
+   /** toInfix builds a string object in infix form of the AST object, with only the
+   parentheses needed to keep precedence and left associativity
    @return a string in infix form per the tokens in the AST object*/
    std::string toInfix() const;
 
+   /** toInfix writes the infix form of the AST object to a stream in chunks
+   @parm std::ostream [out] stream to write to*/
+   void toInfix(std::ostream& out) const;
+
+   /** appendInfix appends the infix form of the AST object to a caller's buffer
+   @parm std::string [str] buffer to append to*/
+   void appendInfix(std::string& str) const;
+
    /** toPostfix builds a string object in postfix form of the AST object
    @return a string in postfix form per the tokens in the AST object*/
    std::string toPostfix() const;
 
+   /** toPostfix writes the postfix form of the AST object to a stream in chunks
+   @parm std::ostream [out] stream to write to*/
+   void toPostfix(std::ostream& out) const;
+
+   /** appendPostfix appends the postfix form of the AST object to a caller's buffer
+   @parm std::string [str] buffer to append to*/
+   void appendPostfix(std::string& str) const;
+
    /** calculate calculates the result of the expression stored in the AST
-   @return the calculated result of the AST object as a string*/
-   std::string calculate() const;
+   @parm WorkStealingPool* [pool] workers to split a large tree across, or nullptr
+   @return the calculated result of the AST object as a string, or a math error message*/
+   std::string calculate(WorkStealingPool* pool = nullptr) const;
+
+   /** calculate calculates the exact value of the expression stored in the AST, a tree of
+   at least parallelThreshold nodes is split across the pool's workers when one is given
+   @pre the pool is not running a batch, so it must not be called from one of its tasks
+   @parm Integer [result] the value of the expression, WorkStealingPool* [pool] workers or nullptr
+   @return ok, or why there is no value*/
+   Program::Status calculate(Integer& result, WorkStealingPool* pool = nullptr) const;
+
+   // expanded node count from which calculate splits a tree across a pool
+   static constexpr std::uint64_t parallelThreshold = std::uint64_t(1) << 16;
+
+   /** resultToString
+   @parm Program::Status [status] status returned by calculate, Integer [result] value when status is ok
+   @return the value as text, or a math error message*/
+   static std::string resultToString(Program::Status status, const Integer& result);
+
+   /** compile lowers the expression into a flat register program, the program
+   is cached on the root node so every AST sharing that root reuses it
+   @return the compiled program, variables are read with loadVar instructions*/
+   const Program& compile() const;
 
    /** containsVariable
    @return true if the AST object containes a token that holds a variable*/
    bool containsVariable() const;
 
+   /** isVariable
+   @parm std::uint32_t [symbol] set to the variable's symbol id
+   @return true if the whole expression is a single variable*/
+   bool isVariable(std::uint32_t& symbol) const;
+
+   /** variables
+   @return the distinct symbol ids of the variables in the expression, in increasing order*/
+   std::vector<std::uint32_t> variables() const;
+
+   /** uniqueNodeCount counts the distinct nodes reachable from the root
+   @return the number of nodes actually stored for this expression*/
+   std::size_t uniqueNodeCount() const;
+
+   /** expandedNodeCount the size the expression would have as a plain tree
+   @return the number of nodes of the fully expanded tree, saturated at UINT64_MAX*/
+   std::uint64_t expandedNodeCount() const;
+
+   /** memoryBytes counts the memory stored for the expression, once per distinct node
+   @return the bytes of its nodes, its layout and its cached program*/
+   std::size_t memoryBytes() const;
+
+   /** liveNodeCount
+   @return the number of nodes currently held by the calling thread's intern table*/
+   static std::size_t liveNodeCount();
+
    /** AST mutators*/
 
    /** build builds out the tree struture of the AST object pre the provided vector
    @post if successful, an AST object is filled based off the Tokens in
    tokensToAdd
-   @parm std::vector<Token> [tokensToAdd] the vector to fill the tree with
-   @return true if successful*/
+   @parm std::vector<Token> [tokensToAdd] the vector to fill the tree with, in postfix order
+   @return true if successful, false if the tokens are not a single postfix expression*/
    bool build(const std::vector<Token>& tokensToAdd);
 
-   /** simplify the expression by replacing variables with their assigned expression if any
-   @post creates a new AST object that is a simplified
-   @parm std::map<std::string, AST>& [variableStore] holds variables and their assigned expressions
-   @return a new AST object that is a simplifed version of the current AST object*/
-   AST simplify(std::map<std::string, AST>& variableStore) const;
+   /** partialEvaluate replaces every assigned variable with its value or substituted expression and
+   folds every closed subtree to its value in one pass, so new nodes are only made for what is left
+   @post residual holds the expression left, a closed subtree with no value is kept as an operator
+   over its folded operands, and a negative value is written 0 - n, since a number token cannot be negative
+   @parm VariableStore& [variableStore] holds variables and their cached values and substituted expressions,
+   AST [residual] expression left, Integer [value] value when the expression is closed,
+   Program::Status [status] ok or why a closed expression has no value,
+   WorkStealingPool* [pool] workers to calculate a large subtree without variables across, or nullptr
+   @return true if no variable is left*/
+   bool partialEvaluate(VariableStore& variableStore, AST& residual, Integer& value, Program::Status& status,
+      WorkStealingPool* pool = nullptr) const;
 
 
+   /** Builder assembles an AST from postfix order operands and operators*/
+   class Builder;
+
+   /** Entry Struct one node of a Layout */
+   struct Entry {
+
+      // node token
+      Token tok_;
+
+      // index of the left operand's entry, unused for a leaf
+      std::uint32_t left_;
+
+      // index of the right operand's entry, unused for a leaf
+      std::uint32_t right_;
+
+   };
+
+   /** flatten
+   @return the distinct nodes of the expression in post order with the root last,
+   empty for an empty AST, valid while a tree holds the root*/
+   const std::pmr::vector<Entry>& flatten() const;
+
+   /** fromEntries builds the expression a flattened tree describes
+   @pre each operator's operand indices are below its own
+   @parm Entry* [entries] nodes in post order with the root last, std::size_t [count] number of entries
+   @return the expression, shared with every tree already holding its nodes*/
+   static AST fromEntries(const Entry* entries, std::size_t count);
+
+   /** isOperator determine if the token's type is an
+   operator per its TokType value
+   @parm TokType [token] the given's token's type
+   @return true if the provided TopType is an Operator*/
+   static bool isOperator(const TokType& token);
+
 private:
 
+   /** Layout Struct
+    the distinct nodes of a tree in post order, each operand's entry comes
+    before its operator's and the root is the last entry*/
+   struct Layout {
+
+      /** Layout Constructor */
+      explicit Layout(std::pmr::memory_resource* resource);
+
+      // entries in post order
+      std::pmr::vector<Entry> entries_;
+
+      // true if no entry is an operand twice, so the entries are the expanded tree in post order
+      bool tree_;
+
+   };
+
    /** Node Struct */
    struct Node {
 
       /** Node Constructor */
-      Node(Token t);
+      Node(const Token& t, const Node* left, const Node* right, std::size_t hash);
+
+      /** Node Destructor frees the cached layout */
+      ~Node();
 
       /** Node Attributes  */
 
       // holds the input toke
-      Token tok_;
+      const Token tok_;
 
       // left child pointer for tree struture
-      Node* left_;
+      const Node* const left_;
 
       // right child pointer for tree structure
-      Node* right_;
+      const Node* const right_;
+
+      // hash of the token and child pointers, key into the intern table
+      const std::size_t hash_;
+
+      // number of nodes of the expanded subtree rooted here
+      std::uint64_t size_;
+
+      // true if the subtree rooted here has a variable token
+      bool hasVariable_;
+
+      // number of parents and AST objects holding this node
+      mutable std::size_t refCount_;
+
+      // compiled program when this node has been the root of a calculation
+      mutable std::unique_ptr<const Program> program_;
+
+      // flattened tree when this node has been the root of a traversal, allocated from nodeResource
+      mutable Layout* layout_;
+
+   };
+
+   /** Partial Struct a subtree after partial evaluation*/
+   struct Partial {
+
+      // node of the subtree left, owning one reference, nullptr if it folded to value_
+      const Node* node_ = nullptr;
+
+      // true if the subtree has no variable left
+      bool closed_ = true;
+
+      // value of a closed subtree
+      Integer value_;
+
+      // ok or why a closed subtree has no value
+      Program::Status status_ = Program::Status::ok;
 
    };
 
    /** Abstract Syntax Tree Attributes*/
 
    // pointer root of the tree struture
-   Node* root_;
+   const Node* root_;
 
    /** AST public private*/
 
-   /** getHeightHelper returns the hight of the tree
-   @parm Node*[subTreePtr] the starting node to check
-   @returns the hight of the tree as an interger value*/
-   int getHeightHelper(const Node* subTreePtr) const;
-
-   /** isOperator determine if the token's type is an 
-   operator per its TokType value
-   @parm TokType [token] the given's token's type
-   @return true if the provided TopType is an Operator*/
-   bool isOperator(const TokType& token) const;
-
-   /** copyTree copies a tree provided another tree's root
-   @post provided tree copied and pointer to the copy returned
-   @parm Node* [oldTreePtr] tree's root to copy
-   @return a copy of the provided tree*/
-   Node* copyTree(const Node* oldTreePtr) const;
-
-   /** copyTree destroys the tree object
-   @post all memory for the AST object is deallocated
-   @parm Node* [subTreePtr] pointer to the root of the tree*/
-   void clearTree(Node*& subTreePtr);
-
-   /** doMath does the math for two operands and one operator
-   @post calculated the result of the provided operands and operator
-   @param Token[tokenOptr] the operator Token[leftOperand] left operand Token[rightOperand] right operand
-   @return a string representation of calculated math expression*/
-   std::string doMath(const Token& tokenOptr, const Token& leftOperand, const Token& rightOperand) const;
-   
-   /** containsVariable searchs the tree for a variable token
+   /** precedence the binding strength of a token's operator
+   @parm Token [tok] token to check
+   @returns 1 for + and -, 2 for * and /, 3 for ^ and 4 for operands*/
+   static int precedence(const Token& tok);
+
+   /** reserveSize a buffer size estimate for printing the tree
+   @return bytes to reserve before printing*/
+   std::size_t reserveSize() const;
+
+   /** internTable the calling thread's table of every live node keyed by its hash
+   @return reference to the intern table*/
+   static std::pmr::unordered_multimap<std::size_t, const Node*>& internTable();
+
+   /** nodeResource the calling thread's pool that nodes, layouts and intern table entries are
+   allocated from, a freed node's memory is reused by the next node
+   @parm MemoryAccount::Origin [origin] nodes, layouts or internTable, what the memory is counted as
+   @return reference to the pool counting under the origin*/
+   static std::pmr::memory_resource& nodeResource(MemoryAccount::Origin origin = MemoryAccount::Origin::nodes);
+
+   /** makeNode finds or creates the node holding the token and children
+   @post returned node's reference count is incremented for the caller
+   @parm Token [tok] node token, Node* [left] left child, Node* [right] right child
+   @return the unique node with the given token and children*/
+   static const Node* makeNode(const Token& tok, const Node* left, const Node* right);
+
+   /** retain adds a reference to a node
+   @parm Node* [nodePtr] node to reference, may be nullptr*/
+   static void retain(const Node* nodePtr);
+
+   /** release drops a reference to a node
+   @post a node no longer referenced is removed from the intern table, its children released without recursion
+   @parm Node* [nodePtr] node to release, may be nullptr*/
+   static void release(const Node* nodePtr);
+
+   /** layout flattens the tree the first time it is needed and caches it on the root
+   @pre the tree is not empty
+   @return the distinct nodes of the tree in post order*/
+   const Layout& layout() const;
+
+   /** lower appends an instruction per entry, so entry i's value is register i
+   @parm Layout [flat] flattened tree, Program [program] empty program to append to*/
+   static void lower(const Layout& flat, Program& program);
+
+   /** containsVariable checks the tree for a variable token, answered by the flag each node computes once
    @parm Node* [treePtr] root of the tree, starting point
    @return true if the tree contains a variable, false otherwise*/
    bool containsVariable(const Node* treePtr) const;
 
-   /** replace recrusively inserts a expression tree at a specific variable location, replacing that variable with its expression if any
-   @post variable stored at the specific node location will be replaced with its assigned expression
-   @parm Node* [subTreePtr] root of the tree, starting point, Node* [insertPtr] root of the tree to insert  */
-   void replace(Node*& subTreePtr, const Node* insertPtr) const;
-
-   /** toInfixHelper recuisve methods that does the work for the toInfix method
+   /** toInfixHelper does the work for the toInfix methods in one in order pass over the layout
    @post constructs a string in infix form by traversing the tree
-   @parm Node* [treePtr] tree root pointer, string [str] to store the constructed string in*/
-   void toInfixHelper(const Node* treePtr, std::string& str) const;
+   @parm string [str] to store the constructed string in,
+   std::ostream* [out] if not nullptr, str is written to out and cleared whenever it fills a chunk*/
+   void toInfixHelper(std::string& str, std::ostream* out) const;
+
+   /** toPostfixHelper does the work for the toPostfix methods in one post order pass over the layout
+   @post constructs a string in postfix form by traversing the tree
+   @parm string [str] to store the constructed string in,
+   std::ostream* [out] if not nullptr, str is written to out and cleared whenever it fills a chunk*/
+   void toPostfixHelper(std::string& str, std::ostream* out) const;
+
+   /** calculateParallel cuts the tree into subtrees of about a grain each, evaluates
+   them as tasks on the pool and combines their values in post order on the calling
+   thread, so the first error reported is the one the sequential program would hit
+   @parm Integer [result] the value of the expression, WorkStealingPool [pool] workers
+   @return ok, or why there is no value*/
+   Program::Status calculateParallel(Integer& result, WorkStealingPool& pool) const;
+
+   /** compileHelper traversal of a subtree in postfix order on an explicit stack emitting an instruction per node,
+   used by the tasks of calculateParallel, which only read the nodes and so cannot flatten them
+   @post the subtree's instructions are appended to program, shared subtrees are only emitted once
+   @param Node*[treePtr] root of the tree, Program [program] program to append to,
+   std::unordered_map<const Node*, std::uint32_t>[registers] registers of nodes already emitted
+   @return the register holding the subtree's value*/
+   std::uint32_t compileHelper(const Node* treePtr, Program& program, std::pmr::unordered_map<const Node*, std::uint32_t>& registers) const;
+
+   /** partialEvaluateHelper evaluates the tree bottom up on an explicit stack, substituting
+   variables and folding every closed operator whose operands have values
+   @post the result's node reference is owned by the caller, shared subtrees are only evaluated once
+   @param Node*[treePtr] root of the tree, starting point, VariableStore [variableStore] variable storage to reference,
+   WorkStealingPool* [pool] workers for large subtrees without variables, Partial [result] the evaluated tree*/
+   static void partialEvaluateHelper(const Node* treePtr, VariableStore& variableStore, WorkStealingPool* pool, Partial& result);
+
+   /** fold applies an operator to the values of two closed subtrees
+   @parm OpCode [op] operation, Partial [left] left operand, Partial [right] right operand, Partial [result] value and status set
+   @post the first error of the operands, in post order, is kept*/
+   static void fold(OpCode op, const Partial& left, const Partial& right, Partial& result);
+
+   /** materialize gives the node of an evaluated subtree, a number leaf if it folded to a value, 0 - n if the value is negative
+   @parm Partial [partial] evaluated subtree
+   @return the node, its reference owned by the caller*/
+   static const Node* materialize(const Partial& partial);
+
+}; // end of AST
+
+/** Builder Class
+ assembles an AST from operands and operators given in postfix order, so a
+ parser can emit nodes as it reads tokens without a postfix token vector*/
+class AST::Builder {
 
-   /** toPostfixHelper recuisve methods that does the work for the toPostfix method
-   @post constructs a string in infix form by traversing the tree
-   @parm Node* [treePtr] tree root pointer, string [str] to store the constructed string in*/
-   void toPostfixHelper(const Node* treePtr, std::string& str) const;
+public:
+
+   /** Builder constructor*/
+   Builder() = default;
 
-   /** calculateHelper recursive traversal of the tree in postfix order calculated the result of the expression tree
-   @post calculates the result of the expression tree and calls doMath to do the operation, and stores the result on the top of the tokenStack
-   @param Node*[treePtr] root of the tree std::stack<Token>[tokenStack] result stack */
-   void calculateHelper(const Node* treePtr, std::stack<Token>& tokenStack) const;
+   /** Builder destructor releases the nodes not handed to a tree*/
+   ~Builder();
+
+   Builder(const Builder&) = delete;
+   Builder& operator=(const Builder&) = delete;
+
+   /** operand pushes a leaf for a number or variable token
+   @parm Token [tok] operand token*/
+   void operand(const Token& tok);
+
+   /** apply replaces the top two nodes with an operator node over them
+   @parm Token [tok] operator token
+   @return false if fewer than two nodes are pushed*/
+   bool apply(const Token& tok);
+
+   /** finish hands the single pushed node to a tree
+   @post the builder is empty
+   @parm AST [tree] tree to set
+   @return false if there is not exactly one node pushed*/
+   bool finish(AST& tree);
+
+   /** clear releases every pushed node*/
+   void clear();
+
+private:
 
-   /** simplifyHelper recursive method searches the tree for variables that have assigned expressions, if one is found replace is called to insert a that variables expression/replace it
-   @post the provided tree has been simplifed by replaces variables with their expressions
-   @param Node*[treePtr] root of the tree, starting point, std::map<std::string, AST> [variableStore] variable expression storage to reference*/
-   void simplifyHelper(Node*& treePtr, const std::map<std::string, AST>& variableStore) const;
+   // nodes pushed and not yet combined, each owns one reference
+   std::vector<const Node*> nodes_;
 
-}; // end of AST
\ No newline at end of file
+}; // end of Builder
@@ -0,0 +1,323 @@
+/** @file BatchEvaluator.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a column evaluator that runs one
+	compiled Program over arrays of variable bindings, a block of rows
+	per instruction at a time */
+
+#include "BatchEvaluator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+/** Column Kernels
+ Each kernel returns true if any lane overflowed or divided by zero, the
+ block is then redone one row at a time on the exact path.*/
+
+namespace {
+
+	/** addColumns dst[i] = left[i] + right[i] */
+	bool addColumns(std::int64_t* dst, const std::int64_t* left, const std::int64_t* right, std::size_t count) {
+
+		std::size_t i = 0;
+		bool overflow = false;
+#if defined(__AVX2__)
+		// a sum overflowed when its sign differs from both operands' signs
+		__m256i overflowBits = _mm256_setzero_si256();
+		for (; i + 4 <= count; i += 4) {
+			__m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+			__m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+			__m256i sum = _mm256_add_epi64(l, r);
+			overflowBits = _mm256_or_si256(overflowBits, _mm256_and_si256(_mm256_xor_si256(l, sum), _mm256_xor_si256(r, sum)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), sum);
+		} // end for
+		overflow = _mm256_movemask_pd(_mm256_castsi256_pd(overflowBits)) != 0;
+#elif defined(__SSE2__)
+		__m128i overflowBits = _mm_setzero_si128();
+		for (; i + 2 <= count; i += 2) {
+			__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+			__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+			__m128i sum = _mm_add_epi64(l, r);
+			overflowBits = _mm_or_si128(overflowBits, _mm_and_si128(_mm_xor_si128(l, sum), _mm_xor_si128(r, sum)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), sum);
+		} // end for
+		overflow = _mm_movemask_pd(_mm_castsi128_pd(overflowBits)) != 0;
+#endif
+		for (; i < count; ++i) {
+			overflow |= __builtin_add_overflow(left[i], right[i], &dst[i]);
+		} // end for
+
+		return overflow;
+
+	} // end of addColumns
+
+	/** subColumns dst[i] = left[i] - right[i] */
+	bool subColumns(std::int64_t* dst, const std::int64_t* left, const std::int64_t* right, std::size_t count) {
+
+		std::size_t i = 0;
+		bool overflow = false;
+#if defined(__AVX2__)
+		// a difference overflowed when the operands' signs differ and its sign differs from the left
+		__m256i overflowBits = _mm256_setzero_si256();
+		for (; i + 4 <= count; i += 4) {
+			__m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + i));
+			__m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + i));
+			__m256i difference = _mm256_sub_epi64(l, r);
+			overflowBits = _mm256_or_si256(overflowBits, _mm256_and_si256(_mm256_xor_si256(l, r), _mm256_xor_si256(l, difference)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), difference);
+		} // end for
+		overflow = _mm256_movemask_pd(_mm256_castsi256_pd(overflowBits)) != 0;
+#elif defined(__SSE2__)
+		__m128i overflowBits = _mm_setzero_si128();
+		for (; i + 2 <= count; i += 2) {
+			__m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + i));
+			__m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + i));
+			__m128i difference = _mm_sub_epi64(l, r);
+			overflowBits = _mm_or_si128(overflowBits, _mm_and_si128(_mm_xor_si128(l, r), _mm_xor_si128(l, difference)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), difference);
+		} // end for
+		overflow = _mm_movemask_pd(_mm_castsi128_pd(overflowBits)) != 0;
+#endif
+		for (; i < count; ++i) {
+			overflow |= __builtin_sub_overflow(left[i], right[i], &dst[i]);
+		} // end for
+
+		return overflow;
+
+	} // end of subColumns
+
+	/** mulColumns dst[i] = left[i] * right[i], AVX2 has no 64 bit multiply so
+	 this is a plain loop */
+	bool mulColumns(std::int64_t* dst, const std::int64_t* left, const std::int64_t* right, std::size_t count) {
+
+		bool overflow = false;
+		for (std::size_t i = 0; i < count; ++i) {
+			overflow |= __builtin_mul_overflow(left[i], right[i], &dst[i]);
+		} // end for
+
+		return overflow;
+
+	} // end of mulColumns
+
+	/** divColumns dst[i] = left[i] / right[i] */
+	bool divColumns(std::int64_t* dst, const std::int64_t* left, const std::int64_t* right, std::size_t count) {
+
+		bool failed = false;
+		for (std::size_t i = 0; i < count; ++i) {
+			// never trap, the failing row is redone on the exact path
+			if (right[i] == 0 || (right[i] == -1 && left[i] == std::numeric_limits<std::int64_t>::min())) {
+				dst[i] = 0;
+				failed = true;
+			}
+			else {
+				dst[i] = left[i] / right[i];
+			} // end if
+		} // end for
+
+		return failed;
+
+	} // end of divColumns
+
+	/** powColumns dst[i] = left[i] ^ right[i] by squaring, the exponent is a
+	 constant so every lane takes the same branches */
+	bool powColumns(std::int64_t* dst, const std::int64_t* left, const std::int64_t* right, std::size_t count) {
+
+		bool overflow = false;
+		for (std::size_t i = 0; i < count; ++i) {
+			std::int64_t base = left[i];
+			std::int64_t exponent = right[i];
+			std::int64_t result = 1;
+			while (exponent > 0) {
+				if (exponent & 1) {
+					overflow |= __builtin_mul_overflow(result, base, &result);
+				} // end if
+				exponent >>= 1;
+				if (exponent > 0) {
+					overflow |= __builtin_mul_overflow(base, base, &base);
+				} // end if
+			} // end while
+			dst[i] = result;
+		} // end for
+
+		return overflow;
+
+	} // end of powColumns
+
+} // end namespace
+
+
+/** BatchEvaluator Class public methods */
+
+/** BatchEvaluator constructor */
+BatchEvaluator::BatchEvaluator(const Program& program)
+	:program_(program), failedRow_(0), failedStatus_(Program::Status::ok) {
+} // end constructor
+
+/** bind */
+bool BatchEvaluator::bind(std::uint32_t symbol, const std::int64_t* values, std::size_t count) {
+
+	if (values == nullptr && count != 0) {
+		return false;
+	} // end if
+
+	if (symbol >= columns_.size()) {
+		columns_.resize(symbol + 1, nullptr);
+		columnSizes_.resize(symbol + 1, 0);
+		bound_.resize(symbol + 1, false);
+	} // end if
+
+	columns_[symbol] = values;
+	columnSizes_[symbol] = count;
+	bound_[symbol] = true;
+
+	return true;
+
+} // end of bind
+
+/** unboundSymbol */
+bool BatchEvaluator::unboundSymbol(std::uint32_t& symbol) const {
+
+	for (const Program::Instruction& instr : program_.getCode()) {
+
+		if (instr.kind_ == Program::Kind::loadVar && (instr.a_ >= bound_.size() || !bound_[instr.a_])) {
+			symbol = instr.a_;
+			return true;
+		} // end if
+
+	} // end for
+
+	return false;
+
+} // end of unboundSymbol
+
+/** evaluate */
+bool BatchEvaluator::evaluate(std::int64_t* results, std::size_t count) {
+
+	const std::vector<Program::Instruction>& code = program_.getCode();
+	const std::vector<std::int64_t>& constants = program_.getConstants();
+
+	// check every column read covers the rows
+	std::uint32_t symbol = 0;
+	if (code.empty() || unboundSymbol(symbol)) {
+		return false;
+	} // end if
+
+	for (const Program::Instruction& instr : code) {
+		if (instr.kind_ == Program::Kind::loadVar && columnSizes_[instr.a_] < count) {
+			return false;
+		} // end if
+	} // end for
+
+	// column of rows each instruction reads or writes for the current block
+	std::vector<const std::int64_t*> regs(code.size(), nullptr);
+	registers_.resize(code.size() * blockSize);
+
+	// constants are the same for every block, fill them once
+	for (std::size_t i = 0; i < code.size(); ++i) {
+		if (code[i].kind_ == Program::Kind::loadConst) {
+			std::int64_t* dst = registers_.data() + i * blockSize;
+			std::fill(dst, dst + blockSize, constants[code[i].a_]);
+			regs[i] = dst;
+		} // end if
+	} // end for
+
+	for (std::size_t start = 0; start < count; start += blockSize) {
+
+		std::size_t rows = std::min(blockSize, count - start);
+		bool failed = program_.hasBigConstants();
+
+		for (std::size_t i = 0; i < code.size(); ++i) {
+
+			const Program::Instruction& instr = code[i];
+			std::int64_t* dst = registers_.data() + i * blockSize;
+
+			switch (instr.kind_)
+			{
+			case Program::Kind::loadConst:
+				break;
+			case Program::Kind::loadVar:
+				// read straight from the bound column
+				regs[i] = columns_[instr.a_] + start;
+				break;
+			case Program::Kind::add:
+				failed |= addColumns(dst, regs[instr.a_], regs[instr.b_], rows);
+				regs[i] = dst;
+				break;
+			case Program::Kind::sub:
+				failed |= subColumns(dst, regs[instr.a_], regs[instr.b_], rows);
+				regs[i] = dst;
+				break;
+			case Program::Kind::mul:
+				failed |= mulColumns(dst, regs[instr.a_], regs[instr.b_], rows);
+				regs[i] = dst;
+				break;
+			case Program::Kind::div:
+				failed |= divColumns(dst, regs[instr.a_], regs[instr.b_], rows);
+				regs[i] = dst;
+				break;
+			case Program::Kind::pow:
+				failed |= powColumns(dst, regs[instr.a_], regs[instr.b_], rows);
+				regs[i] = dst;
+				break;
+			} // end switch
+
+		} // end for
+
+		std::memcpy(results + start, regs[code.size() - 1], rows * sizeof(std::int64_t));
+
+		// redo a block with an overflow one row at a time, the exact
+		// result may still fit even if an intermediate did not
+		for (std::size_t row = start; failed && row < start + rows; ++row) {
+
+			Integer result;
+			failedStatus_ = evaluateRow(row, result);
+
+			if (failedStatus_ != Program::Status::ok || !result.isSmall()) {
+				failedRow_ = row;
+				return false;
+			} // end if
+
+			results[row] = result.getSmall();
+
+		} // end for
+
+	} // end for
+
+	return true;
+
+} // end of evaluate
+
+/** evaluateRow */
+Program::Status BatchEvaluator::evaluateRow(std::size_t row, Integer& result) const {
+
+	std::vector<std::int64_t> variables(columns_.size(), 0);
+
+	for (std::size_t symbol = 0; symbol < columns_.size(); ++symbol) {
+		if (bound_[symbol] && row < columnSizes_[symbol]) {
+			variables[symbol] = columns_[symbol][row];
+		} // end if
+	} // end for
+
+	return program_.evaluate(result, variables.data());
+
+} // end of evaluateRow
+
+/** failedRow */
+std::size_t BatchEvaluator::failedRow() const {
+
+	return failedRow_;
+
+} // end of failedRow
+
+/** failedStatus */
+Program::Status BatchEvaluator::failedStatus() const {
+
+	return failedStatus_;
+
+} // end of failedStatus
@@ -0,0 +1,94 @@
+/** @file BatchEvaluator.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a column evaluator that runs one
+   compiled Program over arrays of variable bindings, a block of rows
+   per instruction at a time */
+
+#pragma once
+
+// included classes
+#include "Program.h"
+
+// included libraries
+#include <vector>
+#include <cstdint>
+
+
+/** BatchEvaluator Class
+ Instead of running the program once per row, every instruction is run
+ over a block of rows stored contiguously, so the operator kernels are
+ tight loops over int64 lanes that use SSE2/AVX2 where the build allows.
+ Every kernel also reports overflow, so results are exact or an error.*/
+class BatchEvaluator {
+
+public:
+
+   /** BatchEvaluator constructor
+   @parm Program [program] compiled expression, must outlive the evaluator*/
+   explicit BatchEvaluator(const Program& program);
+
+   /** BatchEvaluator public methods*/
+
+   /** bind binds a variable to a column of values
+   @post loadVar instructions for symbol read row i from values[i]
+   @parm std::uint32_t [symbol] symbol id of the variable, std::int64_t* [values] column,
+   std::size_t [count] number of values in the column
+   @return true if the variable was bound*/
+   bool bind(std::uint32_t symbol, const std::int64_t* values, std::size_t count);
+
+   /** unboundSymbol finds a variable the program reads that has no column
+   @parm std::uint32_t [symbol] set to the first unbound symbol id
+   @return true if a variable is unbound*/
+   bool unboundSymbol(std::uint32_t& symbol) const;
+
+   /** evaluate runs the program over every row, a block where a lane
+   overflows is redone one row at a time on the exact path
+   @pre every variable the program reads is bound with at least count values
+   @post results[i] holds the value of the expression for row i
+   @parm std::int64_t* [results] result column, std::size_t [count] number of rows
+   @return true if all rows were evaluated, false if a row has no int64 result*/
+   bool evaluate(std::int64_t* results, std::size_t count);
+
+   /** evaluateRow evaluates a single row exactly
+   @parm std::size_t [row] row to evaluate, Integer [result] value of the expression
+   @return ok, or why there is no result*/
+   Program::Status evaluateRow(std::size_t row, Integer& result) const;
+
+   /** failedRow
+   @return the row evaluate stopped at*/
+   std::size_t failedRow() const;
+
+   /** failedStatus
+   @return why evaluate stopped, ok if the exact result does not fit an int64*/
+   Program::Status failedStatus() const;
+
+private:
+
+   /** BatchEvaluator Attributes*/
+
+   // rows evaluated by each instruction at a time
+   static constexpr std::size_t blockSize = 256;
+
+   // program to evaluate
+   const Program& program_;
+
+   // bound columns indexed by symbol id
+   std::vector<const std::int64_t*> columns_;
+
+   // bound column lengths indexed by symbol id
+   std::vector<std::size_t> columnSizes_;
+
+   // true for every symbol id with a bound column
+   std::vector<bool> bound_;
+
+   // one block of rows per instruction
+   std::vector<std::int64_t> registers_;
+
+   // row evaluate stopped at
+   std::size_t failedRow_;
+
+   // why evaluate stopped
+   Program::Status failedStatus_;
+
+}; // end of BatchEvaluator
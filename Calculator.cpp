@@ -4,394 +4,909 @@
  This implementation file implements a Symbolic Algebra Calculator that reads in mathematical (algebraic) expressions and represents them in an internal data structure (AST Object) so that they can be manipulated  i.e., simplified, solved, or transformed. */
 
 #include"Calculator.h"
+#include"BatchEvaluator.h"
+#include"LineArena.h"
+#include"Stats.h"
+#include"Tracer.h"
+#include"MemoryAccount.h"
+
+#include<algorithm>
+#include<cctype>
+#include<chrono>
+
 
 
 /** Calculator Public methods*/
 
 /** echo */
-void Calculator::echo(std::istream& inputStream) {
-	
-	ITokStream input(inputStream);
-	// Token to insert char into
-	Token inputToken;
+std::uint64_t Calculator::echo(std::istream& inputStream, std::ostream& out) {
 
-	int curExpress = 0;
+	TextSink sink(out);
+	return echo(inputStream, sink);
 
-	do {
-		// create vector for expression
-		std::vector<Token> expressionVec{};
-		// insert char into token
-		input >> inputToken;
+} // end of echo
 
-		// if token value is not "." or a newline "\n"
-		if (inputToken.getType() != TokType::end && inputToken.getType() != TokType::newline) {
+/** echo */
+std::uint64_t Calculator::echo(std::istream& inputStream, ResultSink& sink) {
+
+	// lexer reading the input in blocks, the sink is flushed before it waits
+	// for input, so an interactive user sees every result without a flush per line,
+	// and only once the assignments shown are in the journal
+	Lexer input(inputStream);
+	input.setWaitHook([this, &sink]() {
+		if (journal_ != nullptr) {
+			journal_->commit();
+		} // end if
+		sink.flush();
+	});
 
-			// if token value is not "." or a newline "\n" 
-			while (inputToken.getType() != TokType::newline && inputToken.getType() != TokType::end) {
+	return echoLines(input, sink);
 
-				// store usable token in vector
-				expressionVec.push_back(inputToken);
+} // end of echo
 
-				//get another token
-				input >> inputToken;
+/** echo */
+std::uint64_t Calculator::echo(std::string_view script, std::ostream& out) {
 
-			} // end while
+	// lexer scanning the script in place
+	Lexer input(script);
+	TextSink sink(out);
+	return echoLines(input, sink);
 
-			displayAndEvaluateExpression(expressionVec, curExpress);
+} // end of echo
+
+/** echo */
+std::uint64_t Calculator::echo(std::string_view script, WorkStealingPool& pool, ResultSink& sink) {
+
+	Tracer::Span span("Calculator::echo");
+
+	// split the script into lines
+	std::vector<ScriptLine> lines;
+	lines.reserve(static_cast<std::size_t>(std::count(script.begin(), script.end(), '\n')) + 1);
+	std::size_t lineStart = 0;
+
+	while (lineStart < script.size()) {
+
+		std::size_t lineEnd = script.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos) {
+			lineEnd = script.size();
 		} // end if
 
-	} while (inputToken.getType() != TokType::end); // end do
+		lines.emplace_back();
+		lines.back().text_ = script.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
 
+	} // end while
 
-} // end of echo
+	// find what every line reads and writes
+	pool.run((lines.size() + linesPerTask - 1) / linesPerTask, [&](std::size_t task, std::size_t) {
+		for (std::size_t i = task * linesPerTask; i < lines.size() && i < (task + 1) * linesPerTask; ++i) {
+			scanLine(lines[i]);
+		} // end for
+	});
 
-/** Calculator Private methods*/
+	// run assignments and commands in order, every other line gets the snapshot of the
+	// variables as they are at that line, a new one is started after each assignment
+	std::deque<Snapshot> snapshots;
+	bool snapshotCurrent = false;
+	std::vector<std::size_t> deferred;
+	std::ostringstream buffer;
+	std::size_t lineCount = lines.size();
 
-/** tokensToString */
-std::string Calculator::tokensToString(const std::vector<Token>& tokens) const {
+	for (std::size_t i = 0; i < lines.size(); ++i) {
 
-	std::string tokenString = "";
-	for (size_t i = 0; i < tokens.size(); ++i) {
+		ScriptLine& line = lines[i];
 
-		tokenString += tokens[i].getValue();
+		if (!line.inOrder_ && !line.ends_) {
 
-		if (i != tokens.size() - 1) {
-			tokenString += " ";
-		} // end if
+			if (!snapshotCurrent) {
+				snapshots.emplace_back();
+				snapshotCurrent = true;
+			} // end if
 
-	} // end if
+			// look up only the variables no earlier line of this version read
+			Snapshot& snapshot = snapshots.back();
+			std::uint32_t unknown = line.reads_ & ~snapshot.known_;
+
+			for (std::uint32_t variable = 0; unknown != 0; ++variable, unknown >>= 1) {
+
+				if ((unknown & 1) == 0) {
+					continue;
+				} // end if
 
-	return tokenString;
-} // end of tokensToString
+				Integer value;
+				Program::Status status = Program::Status::ok;
 
-/** buildExpressionTrees */
-AST Calculator::buildAExpressionTree(std::vector<Token>& tokens) {
+				if (variableStore_.value(variable, value, status) && status == Program::Status::ok && value.isSmall()) {
+					snapshot.values_[variable] = value.getSmall();
+					snapshot.usable_ |= std::uint32_t(1) << variable;
+				} // end if
 
-	// if true tokens will be modified to remove variable
-	// and store the variable & expression in variableStorage_
-	std::string variable = "";
-	AST variableTree;
+				snapshot.known_ |= std::uint32_t(1) << variable;
 
-	if (checkForAssignment(tokens, variable)) {
-		variableTree.build(tokens);
+			} // end for
+
+			// a line reading a symbolic, failed or big variable is simplified in order
+			if ((line.reads_ & ~snapshot.usable_) == 0) {
+				line.snapshot_ = &snapshot;
+				deferred.push_back(i);
+				continue;
+			} // end if
 
-		// check if variable is already stored
-		std::map<std::string, AST>::iterator it;
-		it = variableStore_.find(variable);
-		if (it != variableStore_.end()) {
-			//variable is present, update variables expression
-			variableStore_.erase(it);
-			variableStore_.insert(std::pair<std::string, AST>(variable, variableTree));
-		}
-		else {
-			variableStore_.insert(std::pair<std::string, AST>(variable, variableTree));
 		} // end if
 
-	}
-	else {
-		variableTree.build(tokens);
-	} // end if
-	variable = "";
+		runInOrder(line, buffer);
 
-	return variableTree;
+		if (line.inOrder_) {
+			snapshotCurrent = false;
+		} // end if
 
-} // end of buildAExpressionTree
+		if (line.ends_) {
+			lineCount = i + 1;
+			break;
+		} // end if
 
-/** convertToPostfix */
-void Calculator::convertToPostfix(std::vector<Token>& curTokenVec) {
+	} // end for
 
-	std::stack<Token> tokenOpStack;
-	std::vector<Token> tempVec;
+	// parse and evaluate the deferred lines on the workers
+	pool.run((deferred.size() + linesPerTask - 1) / linesPerTask, [&](std::size_t task, std::size_t) {
+		for (std::size_t i = task * linesPerTask; i < deferred.size() && i < (task + 1) * linesPerTask; ++i) {
+			evaluateOnWorker(lines[deferred[i]]);
+		} // end for
+	});
 
-	if (!curTokenVec.empty()) {
+	// number the expressions each block starts at, then format the blocks on the workers
+	std::size_t blockCount = (lineCount + linesPerTask - 1) / linesPerTask;
+	std::vector<int> firstExpress(blockCount, 0);
+	std::vector<std::string> blockText(blockCount);
+	int curExpress = 0;
+	std::uint64_t nonBlankLines = 0;
 
-		for (auto curtoken : curTokenVec) {
+	for (std::size_t i = 0; i < lineCount; ++i) {
 
-			if (curtoken.getType() == TokType::number || curtoken.getType() == TokType::variable || curtoken.getType() == TokType::assign) {
-				// Append operand to end of postfix expression - step 1
-				tempVec.push_back(curtoken);
+		if (i % linesPerTask == 0) {
+			firstExpress[i / linesPerTask] = curExpress;
+		} // end if
 
-			}
-			else if (curtoken.getType() == TokType::lparen) {
-				// save '(' on stack - step 2
-				tokenOpStack.push(curtoken);
-			}
-			else if (curtoken.getType() == TokType::addminusop || curtoken.getType() == TokType::muldivop || curtoken.getType() == TokType::powop) {
+		curExpress += (lines[i].kind_ == Parser::Kind::expression) ? 1 : 0;
+		nonBlankLines += (lines[i].kind_ != Parser::Kind::blank) ? 1 : 0;
 
-				// process stack operators of greater precence - step 3
-				while (!tokenOpStack.empty() && tokenOpStack.top().getType() != TokType::lparen && precendence(curtoken) <= precendence(tokenOpStack.top())) {
+	} // end for
 
-					tempVec.push_back(tokenOpStack.top());
-					tokenOpStack.pop();
+	pool.run(blockCount, [&](std::size_t task, std::size_t) {
 
-				} // end while
+		int express = firstExpress[task];
+		std::string& text = blockText[task];
 
-				// save the operator
-				tokenOpStack.push(curtoken);
+		for (std::size_t i = task * linesPerTask; i < lineCount && i < (task + 1) * linesPerTask; ++i) {
 
-			}
-			else if (curtoken.getType() == TokType::rparen) {
+			const ScriptLine& line = lines[i];
 
-				// pop stack until matching '(' - step 4
-				while (tokenOpStack.top().getType() != TokType::lparen) {
+			switch (line.kind_) {
+			case Parser::Kind::command:
+				sink.appendCommand(text, line.input_, line.output_);
+				break;
+			case Parser::Kind::expression:
+				sink.appendResult(text, ++express, line.input_, line.resultKind_, line.output_);
+				break;
+			case Parser::Kind::syntaxError:
+				sink.appendSyntaxError(text, line.errorColumn_);
+				break;
+			default:
+				// blank line
+				break;
+			} // end switch
 
-					tempVec.push_back(tokenOpStack.top());
-					tokenOpStack.pop();
+		} // end for
 
-				} // end while
-				// remove the open parenthesis
-				tokenOpStack.pop();
+	});
 
-			}
-			else {
-				// Toktype unknown
-				// do nothing
+	// write the blocks in order
+	for (const std::string& text : blockText) {
+		sink.write(text);
+	} // end for
 
-			} // end if 
+	Stats::add(Stats::Counter::lines, nonBlankLines);
 
-		} // end for
+	if (journal_ != nullptr) {
+		journal_->commit();
+	} // end if
 
-		while (!tokenOpStack.empty()) {
+	return nonBlankLines;
 
-			tempVec.push_back(tokenOpStack.top());
+} // end of echo
 
-			tokenOpStack.pop();
-		} // end while
+/** setPool */
+void Calculator::setPool(WorkStealingPool* pool) {
 
-		// add end token
+	pool_ = pool;
+	variableStore_.setPool(pool);
 
-		curTokenVec.clear();
+} // end of setPool
 
-		for (auto token : tempVec) {
+/** setLatency */
+void Calculator::setLatency(LatencyRecorder* recorder) {
 
-			curTokenVec.push_back(token);
+	latency_ = recorder;
 
-		} // end for
+} // end of setLatency
+
+/** load */
+bool Calculator::load(const std::string& fileName, std::string& error) {
+
+	if (!variableStore_.load(fileName, error)) {
+		return false;
+	} // end if
+
+	// the journal's records no longer follow the store, so it restarts from the loaded one
+	if (journal_ != nullptr && !journal_->compact(variableStore_)) {
+		error = journal_->error();
+		return false;
+	} // end if
+
+	return true;
+
+} // end of load
+
+/** setJournal */
+bool Calculator::setJournal(Journal* journal, std::string& error) {
 
+	if (journal != nullptr && !journal->restore(variableStore_, error)) {
+		return false;
 	} // end if
 
+	journal_ = journal;
+	return true;
+
+} // end of setJournal
+
+/** setParseCache */
+void Calculator::setParseCache(ParseCache* cache) {
+
+	parseCache_ = cache;
+
+} // end of setParseCache
 
-} // end of convertToPostfix
+/** evaluate */
+Calculator::Result Calculator::evaluate(std::string_view line) {
 
- /** precedence */
-int Calculator::precendence(const Token& curToken) const {
-	// highest precendent is 3, lowest 1
-	int rank = 0;
+	// parse the line in place
+	Tracer::Span span("Calculator::evaluate");
+	LineArena::Scope lineScope;
+	Lexer input(line);
+	Parser parser(input);
+	Result result;
 
-	switch (curToken.getType()) {
-		case TokType::powop:
-			rank = 3;
+	parser.setCache(parseCache_);
+
+	switch (parser.parseLine()) {
+	case Parser::Kind::command: {
+
+		std::ostringstream report;
+		runCommand(parser.command(), parser.argument(), report);
+		result.kind_ = Result::Kind::command;
+		result.text_ = report.str();
+		break;
+
+	}
+	case Parser::Kind::expression: {
+
+		Program::Status status = Program::Status::ok;
+
+		switch (resolveParsed(parser, result.value_, status, result.expression_, result.text_)) {
+		case ResultSink::Kind::value:
+			result.kind_ = Result::Kind::value;
 			break;
-		case TokType::muldivop:
-			rank = 2;
+		case ResultSink::Kind::expression:
+			result.kind_ = Result::Kind::expression;
 			break;
-		case TokType::addminusop:
-			rank = 1;
+		default:
+			result.kind_ = Result::Kind::error;
+			if (result.text_.empty()) {
+				result.text_ = AST::resultToString(status, result.value_);
+			} // end if
 			break;
+		} // end switch
+
+		break;
+
+	}
+	case Parser::Kind::syntaxError:
+		result.kind_ = Result::Kind::syntaxError;
+		result.column_ = parser.errorColumn();
+		result.text_ = "Syntax Error At Column " + std::to_string(result.column_);
+		break;
+	default:
+		// blank line
+		break;
 	} // end switch
 
-	return rank; 
+	return result;
+
+} // end of evaluate
+
+/** prepare */
+bool Calculator::prepare(std::string_view expression, const std::vector<std::string>& parameters, Prepared& prepared, std::string& error) {
+
+	Tracer::Span span("Calculator::prepare");
+	LineArena::Scope lineScope;
+	Lexer input(expression);
+	Parser parser(input);
 
-} // end precendence
+	Parser::Kind kind = parser.parseLine();
 
-/** checkForAssignment */
-bool Calculator::checkForAssignment(std::vector<Token>& tokenChunk, std::string& variable) {
-	
-	// need to check if there is an assignment operator 
+	if (kind == Parser::Kind::syntaxError) {
+		error = "Syntax Error At Column " + std::to_string(parser.errorColumn()) + ", Expression Not Prepared";
+		return false;
+	} // end if
+
+	if (kind != Parser::Kind::expression || parser.isAssignment()) {
+		error = "Syntax Error, Only An Expression Can Be Prepared";
+		return false;
+	} // end if
 
-	//std::string variable = "";
-	decltype(tokenChunk.size()) searchIndex = 0;
-	bool assignFound = false;
+	// parameters take the values given to each evaluation instead of their stored expressions
+	std::vector<std::uint32_t> symbols;
+	bool storedParameter = false;
 
-	while (!assignFound && searchIndex < tokenChunk.size()) {
+	for (const std::string& name : parameters) {
 
-		if (tokenChunk[searchIndex].getType() == TokType::assign) {
+		// a parameter names a variable as the lexer reads it, a single letter of either case
+		if (name.size() != 1 || !isalpha(static_cast<unsigned char>(name[0]))) {
+			error = "Parameter \"" + name + "\" Is Not A Variable, Expression Not Prepared";
+			return false;
+		} // end if
+
+		std::uint32_t symbol = static_cast<std::uint32_t>(tolower(static_cast<unsigned char>(name[0])) - 'a');
+
+		if (std::find(symbols.begin(), symbols.end(), symbol) != symbols.end()) {
+			error = "Parameter " + std::string(Token::symbolName(symbol)) + " Is Given Twice, Expression Not Prepared";
+			return false;
+		} // end if
+
+		symbols.push_back(symbol);
+		storedParameter = storedParameter || variableStore_.isAssigned(symbol);
+
+	} // end for
+
+	AST simplifiedExpress;
+	Integer value;
+	Program::Status status = Program::Status::ok;
+
+	if (storedParameter) {
+		VariableStore unboundStore = variableStore_;
+		for (std::uint32_t symbol : symbols) {
+			unboundStore.erase(symbol);
+		} // end for
+		unboundStore.partialEvaluate(parser.expression(), simplifiedExpress, value, status);
+	}
+	else {
+		variableStore_.partialEvaluate(parser.expression(), simplifiedExpress, value, status);
+	} // end if
+
+	// lower the nodes into a program of the prepared handle's own, reading parameter slots
+	const std::pmr::vector<AST::Entry>& flat = simplifiedExpress.flatten();
+	std::pmr::vector<std::uint32_t> registers(LineArena::resource());
+	registers.reserve(flat.size());
+	prepared.program_.clear();
+	prepared.parameterCount_ = symbols.size();
+
+	for (const AST::Entry& entry : flat) {
+
+		const Token& tok = entry.tok_;
+
+		if (AST::isOperator(tok.getType())) {
+			registers.push_back(prepared.program_.emitOp(tok.getOp(), registers[entry.left_], registers[entry.right_]));
+		}
+		else if (tok.getType() == TokType::variable) {
+
+			std::size_t slot = std::find(symbols.begin(), symbols.end(), tok.getSymbol()) - symbols.begin();
+
+			if (slot == symbols.size()) {
+				error = "Variable " + std::string(Token::symbolName(tok.getSymbol())) + " Has No Value And Is Not A Parameter";
+				return false;
+			} // end if
+
+			registers.push_back(prepared.program_.emitVar(static_cast<std::uint32_t>(slot)));
 
-			assignFound = true;
-			variable = tokenChunk[0].getValue();
-			// if we find assignment update vector to remove variable & assign token
-			// erase the first 2 tokens
-			tokenChunk.erase(tokenChunk.begin(), tokenChunk.begin() + 2);
 		}
 		else {
-			++searchIndex;
+			registers.push_back(prepared.program_.emitConst(tok.getInteger()));
 		} // end if
 
-	} // end while
+	} // end for
+
+	return true;
+
+} // end of prepare
+
+/** evaluateBatch */
+bool Calculator::evaluateBatch(const std::string& expression, const std::map<std::uint32_t, std::vector<std::int64_t>>& columns,
+	std::vector<std::int64_t>& results, std::string& error) {
+
+	// parse the single line expression in place
+	Tracer::Span span("Calculator::evaluateBatch");
+	LineArena::Scope lineScope;
+	Lexer input(expression);
+	Parser parser(input);
+
+	Parser::Kind kind = parser.parseLine();
+
+	if (kind == Parser::Kind::syntaxError) {
+		error = "Syntax Error At Column " + std::to_string(parser.errorColumn()) + ", Batch Expression Skipped";
+		return false;
+	} // end if
+
+	if (kind != Parser::Kind::expression) {
+		error = "Syntax Error, Batch Expression Skipped";
+		return false;
+	} // end if
 
-	return assignFound;
+	if (parser.isAssignment()) {
+		error = "Batch Error, Batch Expression Cannot Assign";
+		return false;
+	} // end if
+
+	const AST& expressionTree = parser.expression();
+
+	// bound variables take their column values instead of their stored expressions
+	VariableStore unboundStore = variableStore_;
+	// rows are limited by the shortest column
+	std::size_t rows = columns.empty() ? 1 : columns.begin()->second.size();
+	for (const auto& column : columns) {
+		unboundStore.erase(column.first);
+		rows = std::min(rows, column.second.size());
+	} // end for
+
+	AST simplifiedExpress;
+	Integer value;
+	Program::Status status = Program::Status::ok;
+	unboundStore.partialEvaluate(expressionTree, simplifiedExpress, value, status);
+	BatchEvaluator batch(simplifiedExpress.compile());
+
+	for (const auto& column : columns) {
+		batch.bind(column.first, column.second.data(), column.second.size());
+	} // end for
+
+	std::uint32_t unbound = 0;
+	if (batch.unboundSymbol(unbound)) {
+		error = "Batch Error, Variable " + std::string(Token::symbolName(unbound)) + " Has No Value";
+		return false;
+	} // end if
 
-} // end checkForAssignment
+	results.resize(rows);
 
-/** isValidInput */
-bool Calculator::isValidInput(const std::vector<Token> expressToCheck) const {
+	if (!batch.evaluate(results.data(), rows)) {
 
-	bool valid = true;
-	std::stack<Token> examineStack;
+		std::string row = std::to_string(batch.failedRow() + 1);
 
-	// do need to compare last token to stack
-	for (size_t i = 0; i < expressToCheck.size() && valid; ++i) {
-		
-		TokType rhsType = expressToCheck[i].getType();
-		
-		//unkown token provided
-		if (rhsType == TokType::unknown) {
-			valid = false;
+		if (batch.failedStatus() == Program::Status::divideByZero) {
+			error = "Math Error, Division By Zero At Row " + row;
+		}
+		else {
+			error = "Math Error, Result Does Not Fit 64 Bits At Row " + row;
 		} // end if
 
-		if (i == 0) {
-			
-			if (rhsType == TokType::addminusop || rhsType == TokType::muldivop || rhsType == TokType::powop || rhsType == TokType::assign ) {
-				valid = false;
+		return false;
+	} // end if
+
+	return true;
+
+} // end of evaluateBatch
+
+/** Calculator Private methods*/
+
+/** assignVariable */
+bool Calculator::assignVariable(std::uint32_t variable, const AST& expression, std::string& error) {
+
+	Stats::Timer timer(Stats::Stage::assign);
+	Tracer::Span span("Calculator::assignVariable");
+
+	// the store keeps the old expression if the new one refers back to the variable
+	std::vector<std::uint32_t> cycle;
+
+	if (!variableStore_.assign(variable, expression, cycle)) {
+
+		error = "Cycle Error, ";
+		for (size_t i = 0; i < cycle.size(); ++i) {
+			error += Token::symbolName(cycle[i]);
+			if (i != cycle.size() - 1) {
+				error += " -> ";
 			} // end if
+		} // end for
 
-		} // end if
+		return false;
+	} // end if
+
+	// a failed journal keeps its error for the caller to report at exit
+	if (journal_ != nullptr) {
+		journal_->append(variable, expression);
+		journal_->compactIfDue(variableStore_);
+	} // end if
+
+	return true;
+
+} // end of assignVariable
+
+/** resolveVariable */
+ResultSink::Kind Calculator::resolveVariable(std::uint32_t variable, Integer& value, Program::Status& status, AST& symbolic) {
+
+	// read the variable's cached value or substituted expression
+	if (variableStore_.value(variable, value, status)) {
+		return (status == Program::Status::ok) ? ResultSink::Kind::value : ResultSink::Kind::error;
+	} // end if
+
+	symbolic = *variableStore_.substituted(variable);
+	return ResultSink::Kind::expression;
+
+} // end of resolveVariable
+
+/** resolveExpression */
+ResultSink::Kind Calculator::resolveExpression(const AST& expression, Integer& value, Program::Status& status, AST& symbolic) {
+
+	std::uint32_t variable = 0;
+
+	if (!expression.containsVariable()) {
+		status = expression.calculate(value, pool_);
+		return (status == Program::Status::ok) ? ResultSink::Kind::value : ResultSink::Kind::error;
+	} // end if
+
+	if (expression.isVariable(variable) && variableStore_.isAssigned(variable)) {
+		return resolveVariable(variable, value, status, symbolic);
+	} // end if
+
+	// substitute the stored variables and fold every closed subtree in one pass,
+	// what still has a variable is the result
+	AST residual;
+
+	if (variableStore_.partialEvaluate(expression, residual, value, status)) {
+		return (status == Program::Status::ok) ? ResultSink::Kind::value : ResultSink::Kind::error;
+	} // end if
+
+	symbolic = residual;
+	return ResultSink::Kind::expression;
+
+} // end of resolveExpression
+
+/** resolveParsed */
+ResultSink::Kind Calculator::resolveParsed(const Parser& parser, Integer& value, Program::Status& status, AST& symbolic, std::string& error) {
+
+	if (!parser.isAssignment()) {
+		return resolveExpression(parser.expression(), value, status, symbolic);
+	} // end if
+
+	// an assignment gives the variable's new value
+	if (assignVariable(parser.variable(), parser.expression(), error)) {
+		return resolveVariable(parser.variable(), value, status, symbolic);
+	} // end if
 
+	return ResultSink::Kind::error;
 
-		if (examineStack.empty() && rhsType == TokType::rparen) {
-			valid = false;
+} // end of resolveParsed
+
+/** echoLines */
+std::uint64_t Calculator::echoLines(Lexer& input, ResultSink& sink) {
+
+	// parsed a line at a time
+	Tracer::Span span("Calculator::echo");
+	Parser parser(input);
+	parser.setCache(parseCache_);
+
+	int curExpress = 0;
+	std::uint64_t lineCount = 0;
+
+	do {
+
+		// the line's scratch memory is rewound once it is displayed
+		LineArena::Scope lineScope;
+		Parser::Kind kind = Parser::Kind::blank;
+
+		{
+			Stats::Timer timer(Stats::Stage::parse);
+			kind = parser.parseLine();
+		}
+
+		if (kind != Parser::Kind::blank) {
+			Stats::add(Stats::Counter::lines);
 		} // end if
 
-		if (!examineStack.empty()) {
+		switch (kind) {
+		case Parser::Kind::command:
+			runCommand(parser.command(), parser.argument(), sink.beginCommand(parser.text()));
+			sink.endCommand();
+			++lineCount;
+			break;
+		case Parser::Kind::expression:
+			displayAndEvaluateExpression(parser, curExpress, sink);
+			++lineCount;
+			break;
+		case Parser::Kind::syntaxError:
+			sink.syntaxError(parser.errorColumn());
+			++lineCount;
+			break;
+		default:
+			// blank line
+			break;
+		} // end switch
 
-			TokType lhsType = examineStack.top().getType();
+	} while (!parser.atEnd()); // end do
 
-			if (rhsType == TokType::assign) {
+	if (journal_ != nullptr) {
+		journal_->commit();
+	} // end if
 
-				if (i != 1) {
-					
-					valid = false;
-				}
-				else {
-					
-					if (lhsType != TokType::variable) {
-						valid = false;
-					} // end if
+	return lineCount;
 
-				} // end if
-				
-			}
-			else if (lhsType == rhsType && rhsType != TokType::lparen && rhsType != TokType::rparen) {
-				// check for same type except for "(( or ))"
-				valid = false;
-			}
-			else if (lhsType == TokType::powop) {
+} // end of echoLines
 
-				if (rhsType != TokType::number) {
-					valid = false;
-				} // end if
-			}
-			else if (examineStack.top().getValue() == "/"){
+/** evaluateParsed */
+ResultSink::Kind Calculator::evaluateParsed(const Parser& parser, std::ostream& out) {
 
-				if (expressToCheck[i].getValue() == "0") {
-					valid = false;
-				} // end if
-		   }
-			else if (rhsType == TokType::rparen) {
-				
-				// remove ")"
-				//examineStack.pop();
+	Integer value;
+	Program::Status status = Program::Status::ok;
+	AST symbolic;
+	std::string error;
 
-				// empty () provided
-				if (examineStack.top().getType() == TokType::lparen) {
+	ResultSink::Kind kind = resolveParsed(parser, value, status, symbolic, error);
 
-					valid = false;
-				} // end if
+	if (kind == ResultSink::Kind::expression) {
+		symbolic.toInfix(out);
+	}
+	else if (!error.empty()) {
+		out << error;
+	}
+	else {
+		out << AST::resultToString(status, value);
+	} // end if
 
-				// if empty after, there was no "(" 
-				if (!examineStack.empty()) {
-					
-					while (!examineStack.empty() && examineStack.top().getType() != TokType::lparen) {
+	return kind;
 
-						if (examineStack.top().getType() != TokType::lparen) {
+} // end of evaluateParsed
 
-							if (!examineStack.empty()) {
-								examineStack.pop();
-							} // end if
+/** scanLine */
+void Calculator::scanLine(ScriptLine& line) {
 
-						} // end if
+	Lexer input(line.text_);
+	Token tok;
+	bool firstIsVariable = false;
 
-					} // end while
+	input >> tok;
 
-					// if the top is a "(" we found the match char, pop it from the stack
-					if (!examineStack.empty() && examineStack.top().getType() == TokType::lparen) {
-						examineStack.pop();
-					} 
-					else {
-						valid = false;
-					}// end if
-				}
-				else {
-					valid = false;
+	for (std::size_t position = 0; tok.getType() != TokType::end && tok.getType() != TokType::newline; ++position) {
 
-				} // end if
+		TokType type = tok.getType();
+
+		if (type == TokType::command && position == 0) {
+			line.inOrder_ = true;
+		}
+		else if (type == TokType::variable) {
 
+			if (tok.getSymbol() < 26) {
+				line.reads_ |= std::uint32_t(1) << tok.getSymbol();
+			}
+			else {
+				line.inOrder_ = true;
 			} // end if
 
-		} // end if
+			firstIsVariable = firstIsVariable || position == 0;
 
-		// push current token onto stack
-		// don't push ")" onto the stack
-		if (expressToCheck[i].getType() != TokType::rparen) {
-			examineStack.push(expressToCheck[i]);
+		}
+		else if (type == TokType::assign && position == 1 && firstIsVariable) {
+			line.inOrder_ = true;
 		} // end if
 
+		input >> tok;
+
 	} // end for
 
-	// pop from stack to see if their is a left over "("
-	for (size_t i = examineStack.size(); !examineStack.empty(); --i) {
-		
-		if (examineStack.top().getType() == TokType::lparen) {
-			valid = false;
-		} // end if
+	// a "." token ends the script as it does for the parser, the end of the line's own text reads
+	// as an empty one, and a command takes the rest of its line, so a "." in its argument is not read
+	line.ends_ = (tok.getType() == TokType::end && !input.lexeme().empty());
+
+} // end of scanLine
+
+/** runInOrder */
+void Calculator::runInOrder(ScriptLine& line, std::ostringstream& buffer) {
 
-		examineStack.pop();
+	Tracer::Span span("Calculator::runInOrder");
+	LineArena::Scope lineScope;
+	Lexer input(line.text_);
+	Parser parser(input);
+	parser.setCache(parseCache_);
+
+	{
+		Stats::Timer timer(Stats::Stage::parse);
+		line.kind_ = parser.parseLine();
+	}
+
+	line.input_ = parser.text();
+	buffer.str(std::string());
+
+	switch (line.kind_) {
+	case Parser::Kind::command:
+		runCommand(parser.command(), parser.argument(), buffer);
+		break;
+	case Parser::Kind::expression:
+		line.resultKind_ = evaluateParsed(parser, buffer);
+		break;
+	case Parser::Kind::syntaxError:
+		line.errorColumn_ = parser.errorColumn();
+		break;
+	default:
+		// blank line
+		break;
+	} // end switch
 
-	}// end for
+	line.output_ = buffer.str();
 
-	return valid;
+} // end of runInOrder
 
-} // end of isValidInput
+/** evaluateOnWorker */
+void Calculator::evaluateOnWorker(ScriptLine& line) {
+
+	// the line's tree lives and dies on this worker's intern table
+	Tracer::Span span("Calculator::evaluateOnWorker");
+	LineArena::Scope lineScope;
+	Lexer input(line.text_);
+	Parser parser(input);
+
+	{
+		Stats::Timer timer(Stats::Stage::parse);
+		line.kind_ = parser.parseLine();
+	}
+
+	line.input_ = parser.text();
+
+	if (line.kind_ == Parser::Kind::syntaxError) {
+		line.errorColumn_ = parser.errorColumn();
+	}
+	else if (line.kind_ == Parser::Kind::expression) {
+		Integer result;
+		Program::Status status = Program::Status::ok;
+		{
+			Stats::Timer timer(Stats::Stage::calculate);
+			status = parser.expression().compile().evaluate(result, line.snapshot_->values_);
+		}
+		line.output_ = AST::resultToString(status, result);
+		line.resultKind_ = (status == Program::Status::ok) ? ResultSink::Kind::value : ResultSink::Kind::error;
+	} // end if
+
+} // end of evaluateOnWorker
 
 /** displayAndEvaluateExpression */
-void Calculator::displayAndEvaluateExpression(std::vector<Token>& expressionVec, int& curExpress) {
+void Calculator::displayAndEvaluateExpression(const Parser& parser, int& curExpress, ResultSink& sink) {
+
+	Stats::Timer timer(Stats::Stage::print);
+	Tracer::Span span("Calculator::displayAndEvaluateExpression", curExpress + 1);
+	auto start = (latency_ != nullptr) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+	// the sink displays the input un altered with the result
+	std::ostream& out = sink.beginResult(++curExpress, parser.text());
+	ResultSink::Kind kind = evaluateParsed(parser, out);
+	sink.endResult(kind);
+
+	if (latency_ != nullptr) {
+		auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+		latency_->record((kind == ResultSink::Kind::expression) ? LatencyRecorder::Kind::symbolic : LatencyRecorder::Kind::numeric,
+			static_cast<std::uint64_t>(nanoseconds), curExpress, parser.text());
+	} // end if
+
+} // end of displayAndEvaluateExpression
+
+/** runCommand */
+void Calculator::runCommand(const Token& commandToken, const std::string& argument, std::ostream& out) {
 
-	// check for errors in syntax
-	if (isValidInput(expressionVec)) {
+	Tracer::Span span("Calculator::runCommand");
 
-		// first display input un altered 
-		std::cout << "in  [" << (++curExpress) << "]: " << tokensToString(expressionVec) << std::endl;
+	std::string_view name = Token::symbolName(commandToken.getSymbol());
+	std::string error;
 
-		// now convert tokens vector to postfix form.
-		convertToPostfix(expressionVec);
+	if (name == "nodes") {
 
-		//build AST tree
-		AST expression = buildAExpressionTree(expressionVec);
+		// report the stored and expanded size of every variable's expression
+		// before and after its variables are substituted
+		for (std::uint32_t variable = 0; variable < variableStore_.size(); ++variable) {
 
-		//if the expression has a variable simplify
+			if (!variableStore_.isAssigned(variable)) {
+				continue;
+			} // end if
+
+			const AST& storedExpress = variableStore_.expression(variable);
+			const AST& simplifiedExpress = *variableStore_.substituted(variable);
+
+			out << "nodes [" << Token::symbolName(variable) << "]: " << storedExpress.uniqueNodeCount() << " unique, "
+				<< storedExpress.expandedNodeCount() << " expanded, substituted " << simplifiedExpress.uniqueNodeCount()
+				<< " unique, " << simplifiedExpress.expandedNodeCount() << " expanded" << std::endl;
+		} // end for
 
-		if (!expression.containsVariable()) {
-			std::cout << "out [" << curExpress << "]: " << expression.calculate() << std::endl;
+		out << "nodes: " << AST::liveNodeCount() << " live" << std::endl;
+	}
+	else if (name == "stats") {
+
+		// totals of every thread so far
+		if (Stats::enabled()) {
+			Stats::report(out);
 		}
 		else {
+			out << "Stats Are Off, Run With --stats" << std::endl;
+		} // end if
 
-			//if the expression has a variable simplify
-			auto simplifiedExpress = expression.simplify(variableStore_);
+	}
+	else if (name == "mem") {
 
-			// if the expression still has a variable don't call calc. 
-			if (simplifiedExpress.containsVariable()) {
+		// report the memory every variable's expression holds before and after
+		// its variables are substituted, then the totals of every origin
+		for (std::uint32_t variable = 0; variable < variableStore_.size(); ++variable) {
 
-				std::cout << "out [" << curExpress << "]: " << simplifiedExpress.toInfix() << std::endl;
-			}
-			else {
-				std::cout << "out [" << curExpress << "]: " << simplifiedExpress.calculate() << std::endl;
+			if (!variableStore_.isAssigned(variable)) {
+				continue;
 			} // end if
 
+			const AST& storedExpress = variableStore_.expression(variable);
+			const AST& simplifiedExpress = *variableStore_.substituted(variable);
+
+			out << "mem [" << Token::symbolName(variable) << "]: " << storedExpress.uniqueNodeCount() << " nodes, "
+				<< storedExpress.memoryBytes() << " bytes, substituted " << simplifiedExpress.uniqueNodeCount()
+				<< " nodes, " << simplifiedExpress.memoryBytes() << " bytes" << std::endl;
+		} // end for
+
+		out << "mem [variable store]: " << variableStore_.memoryBytes() << " bytes" << std::endl;
+		MemoryAccount::report(out);
+
+	}
+	else if ((name == "save" || name == "load") && argument.empty()) {
+		out << "Command " << name << " Needs A File Name, Skipped" << std::endl;
+	}
+	else if (name == "cache") {
+
+		// lookups of the lines parsed so far
+		if (parseCache_ != nullptr) {
+			out << "cache: " << parseCache_->hits() << " hits, " << parseCache_->misses() << " misses, "
+				<< parseCache_->size() << " of " << parseCache_->capacity() << " lines" << std::endl;
+		}
+		else {
+			out << "Parse Cache Is Off, Run With --parse-cache" << std::endl;
+		} // end if
+
+	}
+	else if (name == "save") {
+
+		if (variableStore_.save(argument, error)) {
+			out << "Saved Variables To " << argument << std::endl;
+		}
+		else {
+			out << error << std::endl;
+		} // end if
+
+	}
+	else if (name == "load") {
+
+		if (load(argument, error)) {
+			out << "Loaded Variables From " << argument << std::endl;
+		}
+		else {
+			out << error << std::endl;
 		} // end if
+
 	}
 	else {
-		std::cout << "Syntax Error, Expression Skipped" << std::endl;
+		out << "Unknown Command, " << name << (argument.empty() ? "" : " ") << argument << " Skipped" << std::endl;
 	} // end if
 
+} // end of runCommand
 
-} // end of displayAndEvaluateExpression
+
+/** Prepared Class  */
+
+/** evaluate */
+Program::Status Calculator::Prepared::evaluate(const std::int64_t* values, Integer& result) const {
+
+	return program_.evaluate(result, values);
+
+} // end of evaluate
+
+/** parameterCount */
+std::size_t Calculator::Prepared::parameterCount() const {
+
+	return parameterCount_;
+
+} // end of parameterCount
@@ -10,16 +10,79 @@
 #include<iostream>
 #include<stack>
 #include<map>
+#include<deque>
+#include<sstream>
+#include<string>
+#include<string_view>
+#include<cstdint>
 
 // included Classes
 #include "Token.h"
-#include "ITokStream.h"
+#include "Lexer.h"
+#include "Parser.h"
 #include "AST.h"
+#include "VariableStore.h"
+#include "WorkStealingPool.h"
+#include "LatencyRecorder.h"
+#include "ResultSink.h"
+#include "Journal.h"
+#include "ParseCache.h"
 
 class Calculator{
 
 public:
 
+	/** Result Struct the typed result of a line run by evaluate*/
+	struct Result {
+
+		/** Kind of line and of its result*/
+		enum class Kind : std::uint8_t { value, expression, error, syntaxError, command, blank };
+
+		// what the line was and what it gave
+		Kind kind_ = Kind::blank;
+
+		// value of an expression or assignment
+		Integer value_;
+
+		// simplified expression of an expression or assignment that still has a variable
+		AST expression_;
+
+		// math, cycle or syntax error message, or a command's report
+		std::string text_;
+
+		// column of a syntax error
+		std::size_t column_ = 0;
+
+	}; // end of Result
+
+	/** Prepared Class an expression simplified against the stored variables once and compiled,
+	it keeps its own program, so it can be evaluated from any thread after the calculator changes or is gone*/
+	class Prepared {
+
+	public:
+
+		/** evaluate calculates the expression for one set of parameter values
+		@parm std::int64_t* [values] value of each parameter in the order prepare was given them,
+		Integer [result] value of the expression
+		@return ok, or why there is no result*/
+		Program::Status evaluate(const std::int64_t* values, Integer& result) const;
+
+		/** parameterCount
+		@return the number of values evaluate reads*/
+		std::size_t parameterCount() const;
+
+	private:
+
+		friend class Calculator;
+
+		// program reading parameter i with the loadVar instruction of symbol i
+		Program program_;
+
+		// number of parameters
+		std::size_t parameterCount_ = 0;
+
+	}; // end of Prepared
+
 	/** Calculator constructor*/
 	Calculator() = default;
 
@@ -30,55 +93,215 @@ public:
 	/** echo starts the calculator and ends/exits the when the char "."is entered.
 	takes user input and calls displayExpression to echo the user's input back to the console and the result of the expression
 	@post should of evaluated expression inputted that has correct syntax and echo it back to the user with its result
-	@parm std::istream [inputStream] the input stream to be tokenized by the ITokStream class*/
-	void echo(std::istream& inputStream);
+	@parm std::istream [inputStream] the input stream to be tokenized by the Lexer class and parsed a line at a time,
+	std::ostream [out] stream to echo to as text
+	@return the number of lines that were not blank*/
+	std::uint64_t echo(std::istream& inputStream, std::ostream& out = std::cout);
+
+	/** echo runs a stream's script as echo does, writing each line's record to a sink
+	@post the journal is committed and the sink flushed whenever the lexer is about to wait for input
+	@parm std::istream [inputStream] the input stream parsed a line at a time, ResultSink [sink] sink to write to
+	@return the number of lines that were not blank*/
+	std::uint64_t echo(std::istream& inputStream, ResultSink& sink);
+
+	/** echo runs a script held in memory, as echo does for a stream
+	@parm std::string_view [script] text of the script, std::ostream [out] stream to echo to as text
+	@return the number of lines that were not blank*/
+	std::uint64_t echo(std::string_view script, std::ostream& out);
+
+	/** echo runs a whole script with the output of echo, the lines that only read variables
+	are parsed and evaluated on the pool's workers against a snapshot of the variables
+	taken where the line appears, assignments and commands run in order on the calling thread
+	@parm std::string_view [script] text of the script, WorkStealingPool [pool] workers to evaluate on,
+	ResultSink [sink] sink to write to
+	@return the number of lines that were not blank*/
+	std::uint64_t echo(std::string_view script, WorkStealingPool& pool, ResultSink& sink);
+
+	/** evaluate runs one line as echo does and returns its result instead of formatting it,
+	an assignment is stored and a command's report is returned as text
+	@parm std::string_view [line] text of the line, only its first line is run
+	@return the typed result of the line*/
+	Result evaluate(std::string_view line);
+
+	/** prepare simplifies an expression against the stored variables, except its parameters, and compiles it
+	@parm std::string_view [expression] expression to prepare, std::vector<std::string> [parameters] names of the variables
+	given to each evaluation, in order, each a single letter of either case, Prepared [prepared] compiled expression,
+	std::string [error] error message
+	@return true if the expression was prepared, false on a syntax error, an assignment, a parameter that is not a
+	variable or is given twice, or a variable with no value that is not a parameter*/
+	bool prepare(std::string_view expression, const std::vector<std::string>& parameters, Prepared& prepared, std::string& error);
+
+	/** evaluateBatch evaluates one expression for every row of the bound columns, the
+	expression is simplified against the stored variables except the bound ones and compiled once
+	@post results holds the value of the expression for each row, or error describes the problem
+	@parm std::string [expression] expression to evaluate, std::map<std::uint32_t, std::vector<std::int64_t>> [columns]
+	values for each bound variable by symbol id, std::vector<std::int64_t> [results] result column, std::string [error] error message
+	@return true if every row was evaluated*/
+	bool evaluateBatch(const std::string& expression, const std::map<std::uint32_t, std::vector<std::int64_t>>& columns,
+		std::vector<std::int64_t>& results, std::string& error);
+
+	/** setPool sets the workers a result of at least AST::parallelThreshold nodes is calculated on
+	@pre the pool is not one whose tasks run this calculator
+	@parm WorkStealingPool* [pool] workers, or nullptr to always calculate on the calling thread*/
+	void setPool(WorkStealingPool* pool);
+
+	/** setLatency sets where the time of each expression line echo displays is recorded
+	@parm LatencyRecorder* [recorder] recorder to add to, or nullptr to not time lines*/
+	void setLatency(LatencyRecorder* recorder);
+
+	/** load replaces the stored variables with the ones of an image written by ":save"
+	@parm std::string [fileName] image to load, std::string [error] why the image was not loaded
+	@return true if the image was loaded*/
+	bool load(const std::string& fileName, std::string& error);
+
+	/** setJournal restores the stored variables from a journal, then records every accepted assignment in it
+	@post the records are committed whenever the lexer is about to wait for input and when a script ends
+	@parm Journal* [journal] journal to restore from and append to, std::string [error] why the journal was not restored
+	@return true if the journal was restored*/
+	bool setJournal(Journal* journal, std::string& error);
+
+	/** setParseCache sets the cache the lines parsed on the calling thread are looked up in
+	@pre the cache is used and destroyed on the thread that runs the calculator
+	@parm ParseCache* [cache] cache of parsed lines, or nullptr to parse every line*/
+	void setParseCache(ParseCache* cache);
 	
 private:
 
+	/** Snapshot Struct the values of the single letter variables at one version of variableStore_,
+	filled in as lines read them*/
+	struct Snapshot {
+
+		// value of each variable that has a usable one
+		std::int64_t values_[26];
+
+		// bit per variable looked up
+		std::uint32_t known_ = 0;
+
+		// bit per variable with a value that fits an int64
+		std::uint32_t usable_ = 0;
+
+	}; // end of Snapshot
+
+	/** ScriptLine Struct a line of a script run by the parallel echo*/
+	struct ScriptLine {
+
+		// text of the line without its newline
+		std::string_view text_;
+
+		// bit per variable the line reads
+		std::uint32_t reads_ = 0;
+
+		// true for an assignment or command, which run in order
+		bool inOrder_ = false;
+
+		// true if a "." token ends the script on this line
+		bool ends_ = false;
+
+		// values the line reads, nullptr if it runs in order
+		const Snapshot* snapshot_ = nullptr;
+
+		// kind of the line once parsed
+		Parser::Kind kind_ = Parser::Kind::blank;
+
+		// tokens of the line separated by single spaces
+		std::string input_;
+
+		// result of an expression, or the whole output of a command
+		std::string output_;
+
+		// kind of an expression's result
+		ResultSink::Kind resultKind_ = ResultSink::Kind::value;
+
+		// column of a syntax error
+		std::size_t errorColumn_ = 0;
+
+	}; // end of ScriptLine
+
+	// lines scanned or evaluated by one pool task
+	static constexpr std::size_t linesPerTask = 1024;
+
 	/** private attributes */
 
-	//holds variables and their expressions
-	std::map<std::string, AST> variableStore_;
+	//holds variables, by symbol id, their expressions and what depends on them
+	VariableStore variableStore_;
+
+	// workers large results are calculated on, nullptr for none
+	WorkStealingPool* pool_ = nullptr;
+
+	// recorder of each displayed line's time, nullptr for none
+	LatencyRecorder* latency_ = nullptr;
+
+	// journal of accepted assignments, nullptr for none
+	Journal* journal_ = nullptr;
+
+	// cache of parsed lines, nullptr for none
+	ParseCache* parseCache_ = nullptr;
 
 	/** Calculator Private methods*/
 
-	/** tokensToString creates a string representation of the token expression
-	@post a string has been created that represents the token vector
-	@parm std::vector<Token> [tokens] vector to create a string from
-	@returns a string representation of the vector*/
-	std::string tokensToString(const std::vector<Token>& tokens) const;
-
-	/** buildExpressionTree creates a AST tree object based of the provided token vector
-	@post a AST object is created, a call is made to checkForAssignment in the event the expression has an assignment if true variable and assign token is removed from the vector and stored in variableStore_
-	@parm std::vector<Token>& [tokens] expression to use for AST object build
-	@returns a AST object based off the provided expression*/
-	AST buildAExpressionTree(std::vector<Token>& tokens);
-
-	/** convertToPostfix updates the infix vector to postfix form
-	@post vector should now reflect a postfix expression
-	@parm std::vector<Token> [curTokenVec] vector to convert*/
-	void convertToPostfix(std::vector<Token>& curTokenVec);
-
-	/** precedence determine the precendence of a token that is the type of an operator
-	@parm Token [curToken] token to determine the precendence
-	@returns a integer value that represents the tokens precendence. 1 is the lowest 3 is the highest*/
-	int precendence(const Token& curToken) const;
-
-	/** checkForAssignment checks the expression for an assignment token
-	@post if assignment is true string variable is updated to that token.value_
-	@parm  std::vector<Token> [tokenChunk] expression to search, std::string [variable] to store the string representation of token.value_
-	@return true if the expression contains an assignment and updates variable to that token.value_*/
-	bool checkForAssignment(std::vector<Token>& tokenChunk, std::string& variable);
-
-	/** isValidInput checks the expression to confirm it has valid syntax given the assignments input parameters
-	@parm std::vector<Token> [expressToCheck]
-	@returns true if the vector is a valid expression, false otherwise*/
-	bool isValidInput(const std::vector<Token> expressToCheck) const;
-
-	/** displayAndEvaluateExpression displays and evaluates the expression 
-	@post displays the vector provided if isValidInput is true, calls tokensToString and displays the expressionVec, then builds a AST tree and calculates the expression and displays the result
-	@parm expressionVec*/
-	void displayAndEvaluateExpression(std::vector<Token>& expressionVec, int& curExpress);
+	/** assignVariable stores an expression for a variable
+	@post the variable's expression is replaced unless it would refer back to the variable
+	@parm std::uint32_t [variable] symbol id of the variable, AST [expression] expression to store, std::string [error] cycle error message
+	@returns false if the assignment would make the variable depend on itself*/
+	bool assignVariable(std::uint32_t variable, const AST& expression, std::string& error);
+
+	/** resolveVariable finds a stored variable's cached value or substituted expression
+	@parm std::uint32_t [variable] symbol id of an assigned variable, Integer [value] value of a value result,
+	Program::Status [status] status of the calculation, AST [symbolic] expression of an expression result
+	@return the kind of result*/
+	ResultSink::Kind resolveVariable(std::uint32_t variable, Integer& value, Program::Status& status, AST& symbolic);
+
+	/** resolveExpression simplifies and calculates an expression, an assigned variable on its own uses its cached value
+	@parm AST [expression] expression to evaluate, Integer [value] value of a value result,
+	Program::Status [status] status of the calculation, AST [symbolic] simplified expression if it still has a variable
+	@return the kind of result*/
+	ResultSink::Kind resolveExpression(const AST& expression, Integer& value, Program::Status& status, AST& symbolic);
+
+	/** resolveParsed evaluates a parsed expression line, storing an assignment in variableStore_
+	@parm Parser [parser] parser holding the parsed line, Integer [value] value of a value result, Program::Status [status]
+	status of the calculation, AST [symbolic] expression of an expression result, std::string [error] cycle error message
+	@return the kind of result, an error with an empty message is a math error described by status*/
+	ResultSink::Kind resolveParsed(const Parser& parser, Integer& value, Program::Status& status, AST& symbolic, std::string& error);
+
+	/** echoLines parses and runs every line the lexer reads until "." or the end of input
+	@parm Lexer [input] lexer over the script, ResultSink [sink] sink to write to
+	@return the number of lines that were not blank*/
+	std::uint64_t echoLines(Lexer& input, ResultSink& sink);
+
+	/** evaluateParsed evaluates a parsed expression line, storing an assignment in variableStore_
+	@post the value, simplified expression, math error or cycle error is written to out
+	@parm Parser [parser] parser holding the parsed line, std::ostream [out] stream to write the result to
+	@return the kind of result written*/
+	ResultSink::Kind evaluateParsed(const Parser& parser, std::ostream& out);
+
+	/** scanLine finds the variables a script line reads and whether it must run in order
+	@post reads_, inOrder_ and ends_ are set
+	@parm ScriptLine [line] line to scan*/
+	static void scanLine(ScriptLine& line);
+
+	/** runInOrder parses and runs a script line on the calling thread
+	@post kind_, input_, output_ and errorColumn_ are set, variableStore_ holds an assignment
+	@parm ScriptLine [line] line to run, std::ostringstream [buffer] reusable output buffer*/
+	void runInOrder(ScriptLine& line, std::ostringstream& buffer);
+
+	/** evaluateOnWorker parses and evaluates a line that only reads variables with usable values
+	@pre line.snapshot_ holds a value for every variable the line reads
+	@post kind_, input_, output_ and errorColumn_ are set
+	@parm ScriptLine [line] line to evaluate*/
+	static void evaluateOnWorker(ScriptLine& line);
+
+	/** displayAndEvaluateExpression displays and evaluates the expression, recording the time it takes in latency_
+	@post displays the parsed line, stores an assignment in variableStore_, then calculates the expression and displays the result
+	@parm Parser [parser] parser holding the parsed line, int [curExpress] number of the last expression displayed,
+	ResultSink [sink] sink to write the line's record to*/
+	void displayAndEvaluateExpression(const Parser& parser, int& curExpress, ResultSink& sink);
+
+	/** runCommand runs a calculator command entered as ":name" on its own line
+	@post the command's report is displayed, "nodes" reports the unique and expanded node counts of every stored variable,
+	"save <file>" and "load <file>" write and read the stored variables as an image
+	@parm Token [commandToken] command token holding the command name, std::string [argument] text after the name
+	as entered, std::ostream [out] stream to display to*/
+	void runCommand(const Token& commandToken, const std::string& argument, std::ostream& out);
 
 }; // end of Calculator
 
@@ -0,0 +1,114 @@
+/** @file CalculatorApi.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements the calculator's C interface, for callers
+	that reach it through a foreign function interface instead of C++ */
+
+#include "CalculatorApi.h"
+#include "Calculator.h"
+
+#include <new>
+#include <cstring>
+
+
+/** calc_calculator Struct the calculator behind the C handle*/
+struct calc_calculator {
+
+	Calculator calc_;
+
+};
+
+
+/** calc_create */
+calc_calculator* calc_create(void) {
+
+	return new (std::nothrow) calc_calculator();
+
+} // end of calc_create
+
+/** calc_destroy */
+void calc_destroy(calc_calculator* calc) {
+
+	delete calc;
+
+} // end of calc_destroy
+
+/** calc_evaluate_batch */
+size_t calc_evaluate_batch(calc_calculator* calc, const char* const* lines, const size_t* lengths, size_t count,
+	calc_result* results, char* text, size_t text_size) {
+
+	std::size_t textBytes = 0;
+	std::size_t line = 0;
+
+	// no exception may cross into the caller's language
+	try {
+
+		std::string bigValue;
+
+		for (; line < count; ++line) {
+
+			std::size_t length = (lengths != nullptr) ? lengths[line] : std::strlen(lines[line]);
+			Calculator::Result result = calc->calc_.evaluate(std::string_view(lines[line], length));
+			calc_result& out = results[line];
+			std::string_view resultText = result.text_;
+
+			out.column = static_cast<uint32_t>(result.column_);
+			out.value = 0;
+
+			switch (result.kind_) {
+			case Calculator::Result::Kind::value:
+				if (result.value_.isSmall()) {
+					out.kind = CALC_VALUE;
+					out.value = result.value_.getSmall();
+				}
+				else {
+					out.kind = CALC_BIG_VALUE;
+					bigValue = result.value_.toString();
+					resultText = bigValue;
+				} // end if
+				break;
+			case Calculator::Result::Kind::expression:
+				out.kind = CALC_EXPRESSION;
+				result.text_ = result.expression_.toInfix();
+				resultText = result.text_;
+				break;
+			case Calculator::Result::Kind::error:
+				out.kind = CALC_ERROR;
+				break;
+			case Calculator::Result::Kind::syntaxError:
+				out.kind = CALC_SYNTAX_ERROR;
+				break;
+			case Calculator::Result::Kind::command:
+				out.kind = CALC_COMMAND;
+				break;
+			default:
+				out.kind = CALC_BLANK;
+				break;
+			} // end switch
+
+			// a text that does not fit is left out, the caller can retry with the size returned
+			out.text_offset = textBytes;
+			out.text_length = 0;
+
+			if (textBytes + resultText.size() <= text_size) {
+				std::memcpy(text + textBytes, resultText.data(), resultText.size());
+				out.text_length = resultText.size();
+			} // end if
+
+			textBytes += resultText.size();
+
+		} // end for
+
+	}
+	catch (...) {
+
+		// the line that failed and the ones after it have no result
+		for (; line < count; ++line) {
+			results[line] = calc_result{ CALC_ERROR, 0, 0, textBytes, 0 };
+		} // end for
+
+	} // end try
+
+	return textBytes;
+
+} // end of calc_evaluate_batch
@@ -0,0 +1,69 @@
+/** @file CalculatorApi.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header file declares the calculator's C interface, for callers that
+   reach it through a foreign function interface instead of C++ */
+
+#pragma once
+
+/* included libraries */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define CALC_API __declspec(dllexport)
+#else
+#define CALC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/** calc_calculator a calculator with its own variables, used from the thread that created it*/
+typedef struct calc_calculator calc_calculator;
+
+/** kinds of calc_result, a value that does not fit an int64 is given as text*/
+enum { CALC_VALUE, CALC_BIG_VALUE, CALC_EXPRESSION, CALC_ERROR, CALC_SYNTAX_ERROR, CALC_COMMAND, CALC_BLANK };
+
+/** calc_result the result of one line of a batch*/
+typedef struct calc_result {
+
+   /* one of the CALC_ kinds */
+   int32_t kind;
+
+   /* column of a syntax error */
+   uint32_t column;
+
+   /* value of a CALC_VALUE */
+   int64_t value;
+
+   /* where the text of any other kind starts in the text buffer and its bytes, 0 bytes if it did not fit */
+   uint64_t text_offset;
+   uint64_t text_length;
+
+} calc_result;
+
+/** calc_create
+@return a new calculator with no variables, NULL if it could not be made*/
+CALC_API calc_calculator* calc_create(void);
+
+/** calc_destroy frees a calculator
+@parm calc_calculator* [calc] calculator to free, may be NULL*/
+CALC_API void calc_destroy(calc_calculator* calc);
+
+/** calc_evaluate_batch runs each line in order as the calculator's script would, assignments are stored
+@post results[i] holds the result of lines[i], the text of results that are not int64 values is packed
+into the text buffer until it is full, without terminating zeros
+@parm calc_calculator* [calc] calculator to run on, const char* const* [lines] lines to run,
+size_t* [lengths] bytes of each line, NULL if the lines end with a zero, size_t [count] number of lines,
+calc_result* [results] count results to fill, char* [text] buffer for the texts, size_t [text_size] bytes of the buffer
+@return the bytes the texts of every result need, larger than text_size if some did not fit*/
+CALC_API size_t calc_evaluate_batch(calc_calculator* calc, const char* const* lines, const size_t* lengths, size_t count,
+   calc_result* results, char* text, size_t text_size);
+
+
+#ifdef __cplusplus
+} /* end extern "C" */
+#endif
@@ -9,11 +9,14 @@
 
 // include libraries
 #include "Token.h"
+#include "Lexer.h"
 #include <istream>
 #include <iostream>
 
 
-/**  ITokStream */
+/**  ITokStream
+ A stream style adapter over Lexer, the stream is read in blocks so
+ characters past the last token may already be taken from it.*/
 class ITokStream {
 
 
@@ -40,15 +43,8 @@ private:
 
    /**  ITokStream Private attribute */
 
-   //stores the reference to the provided std::istream
-   std::istream& is_;
-
-   /**  ITokStream Private methods */
-
-    /** determineTokenType
-    @post the token's type_ set per the provided char
-    @param char [input], curToken [Token]*/
-   void determineTokenType(const char input, Token& curToken);
+   //scans the provided std::istream
+   Lexer lexer_;
 
 }; // end of ITokStream
 
@@ -0,0 +1,655 @@
+/** @file Integer.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements an exact integer that keeps small
+	values in an inline int64 and promotes to a heap bignum only when a
+	result overflows */
+
+#include "Integer.h"
+
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <limits>
+
+
+/** Integer Class public methods */
+
+/** Integer constructor */
+Integer::Integer(std::int64_t value)
+	:small_(value), big_(nullptr) {
+} // end constructor
+
+/** fromString */
+bool Integer::fromString(std::string_view digits, Integer& result) {
+
+	if (digits.empty()) {
+		return false;
+	} // end if
+
+	// try the inline value first
+	std::int64_t value = 0;
+	bool fits = true;
+
+	for (char digit : digits) {
+
+		if (digit < '0' || digit > '9') {
+			return false;
+		} // end if
+
+		if (fits && (__builtin_mul_overflow(value, 10, &value) || __builtin_add_overflow(value, digit - '0', &value))) {
+			fits = false;
+		} // end if
+
+	} // end for
+
+	if (fits) {
+		result = Integer(value);
+		return true;
+	} // end if
+
+	// read nine digits at a time into the limbs
+	Magnitude limbs;
+	std::size_t chunk = digits.size() % 9 == 0 ? 9 : digits.size() % 9;
+
+	for (std::size_t start = 0; start < digits.size(); start += chunk, chunk = 9) {
+
+		std::uint32_t chunkValue = 0;
+		std::uint32_t chunkScale = 1;
+
+		for (std::size_t i = start; i < start + chunk; ++i) {
+			chunkValue = chunkValue * 10 + static_cast<std::uint32_t>(digits[i] - '0');
+			chunkScale *= 10;
+		} // end for
+
+		mulAddSmall(limbs, chunkScale, chunkValue);
+
+	} // end for
+
+	result = fromMagnitude(false, limbs);
+	return true;
+
+} // end of fromString
+
+/** isSmall */
+bool Integer::isSmall() const {
+
+	return big_ == nullptr;
+
+} // end of isSmall
+
+/** getSmall */
+std::int64_t Integer::getSmall() const {
+
+	return small_;
+
+} // end of getSmall
+
+/** isZero */
+bool Integer::isZero() const {
+
+	// a bignum is never zero
+	return big_ == nullptr && small_ == 0;
+
+} // end of isZero
+
+/** bitLength */
+std::uint64_t Integer::bitLength() const {
+
+	if (big_ == nullptr) {
+		std::uint64_t absolute = small_ < 0 ? 0 - static_cast<std::uint64_t>(small_) : static_cast<std::uint64_t>(small_);
+		return absolute == 0 ? 0 : 64 - static_cast<std::uint64_t>(__builtin_clzll(absolute));
+	} // end if
+
+	const Magnitude& limbs = big_->limbs_;
+	return (limbs.size() - 1) * 32 + 32 - static_cast<std::uint64_t>(__builtin_clz(limbs.back()));
+
+} // end of bitLength
+
+/** toString */
+std::string Integer::toString() const {
+
+	std::string str;
+	appendTo(str);
+	return str;
+
+} // end of toString
+
+/** appendTo */
+void Integer::appendTo(std::string& str) const {
+
+	if (big_ == nullptr) {
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), small_);
+		str.append(buffer, result.ptr);
+		return;
+	} // end if
+
+	// peel off nine decimal digits at a time, lowest first
+	Magnitude limbs = big_->limbs_;
+	std::vector<std::uint32_t> chunks;
+
+	while (!limbs.empty()) {
+		chunks.push_back(divSmall(limbs, 1000000000u));
+	} // end while
+
+	if (big_->negative_) {
+		str += '-';
+	} // end if
+
+	str += std::to_string(chunks.back());
+
+	for (std::size_t i = chunks.size() - 1; i-- > 0;) {
+		std::string chunkText = std::to_string(chunks[i]);
+		str.append(9 - chunkText.size(), '0');
+		str += chunkText;
+	} // end for
+
+} // end of appendTo
+
+/** hash */
+std::size_t Integer::hash() const {
+
+	if (big_ == nullptr) {
+		return std::hash<std::int64_t>()(small_);
+	} // end if
+
+	std::size_t hash = big_->negative_ ? 1 : 0;
+	for (std::uint32_t limb : big_->limbs_) {
+		hash ^= std::hash<std::uint32_t>()(limb) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	} // end for
+
+	return hash;
+
+} // end of hash
+
+/** operator== */
+bool Integer::operator==(const Integer& rhs) const {
+
+	if (big_ == nullptr || rhs.big_ == nullptr) {
+		// values are normalized, a bignum never equals a small value
+		return big_ == nullptr && rhs.big_ == nullptr && small_ == rhs.small_;
+	} // end if
+
+	return big_->negative_ == rhs.big_->negative_ && big_->limbs_ == rhs.big_->limbs_;
+
+} // end of operator==
+
+/** operator!= */
+bool Integer::operator!=(const Integer& rhs) const {
+
+	return !(*this == rhs);
+
+} // end of operator!=
+
+/** add */
+Integer Integer::add(const Integer& left, const Integer& right) {
+
+	std::int64_t result = 0;
+	if (left.big_ == nullptr && right.big_ == nullptr && !__builtin_add_overflow(left.small_, right.small_, &result)) {
+		return Integer(result);
+	} // end if
+
+	return addSigned(left.isNegative(), left.magnitude(), right.isNegative(), right.magnitude());
+
+} // end of add
+
+/** sub */
+Integer Integer::sub(const Integer& left, const Integer& right) {
+
+	std::int64_t result = 0;
+	if (left.big_ == nullptr && right.big_ == nullptr && !__builtin_sub_overflow(left.small_, right.small_, &result)) {
+		return Integer(result);
+	} // end if
+
+	return addSigned(left.isNegative(), left.magnitude(), !right.isNegative() && !right.isZero(), right.magnitude());
+
+} // end of sub
+
+/** mul */
+Integer Integer::mul(const Integer& left, const Integer& right) {
+
+	std::int64_t result = 0;
+	if (left.big_ == nullptr && right.big_ == nullptr && !__builtin_mul_overflow(left.small_, right.small_, &result)) {
+		return Integer(result);
+	} // end if
+
+	return fromMagnitude(left.isNegative() != right.isNegative(), mulMagnitude(left.magnitude(), right.magnitude()));
+
+} // end of mul
+
+/** div */
+bool Integer::div(const Integer& left, const Integer& right, Integer& result) {
+
+	if (right.isZero()) {
+		return false;
+	} // end if
+
+	// only INT64_MIN / -1 overflows
+	if (left.big_ == nullptr && right.big_ == nullptr &&
+		!(left.small_ == std::numeric_limits<std::int64_t>::min() && right.small_ == -1)) {
+		result = Integer(left.small_ / right.small_);
+		return true;
+	} // end if
+
+	Magnitude dividend = left.magnitude();
+	Magnitude divisor = right.magnitude();
+
+	if (compareMagnitude(dividend, divisor) < 0) {
+		result = Integer(0);
+	}
+	else {
+		result = fromMagnitude(left.isNegative() != right.isNegative(), divMagnitude(dividend, divisor));
+	} // end if
+
+	return true;
+
+} // end of div
+
+/** pow */
+bool Integer::pow(const Integer& base, const Integer& exponent, Integer& result, std::uint64_t maxBits) {
+
+	if (exponent.isZero()) {
+		result = Integer(1);
+		return true;
+	} // end if
+
+	// 0, 1 and -1 stay small for any exponent
+	if (base.big_ == nullptr && base.small_ >= -1 && base.small_ <= 1) {
+		bool odd = exponent.big_ == nullptr ? (exponent.small_ & 1) != 0 : (exponent.big_->limbs_[0] & 1) != 0;
+		result = Integer((base.small_ == -1 && !odd) ? 1 : base.small_);
+		return true;
+	} // end if
+
+	// refuse results that cannot fit in maxBits
+	if (exponent.big_ != nullptr || exponent.small_ < 0 ||
+		static_cast<std::uint64_t>(exponent.small_) > maxBits / base.bitLength()) {
+		return false;
+	} // end if
+
+	std::uint64_t power = static_cast<std::uint64_t>(exponent.small_);
+
+	// inline squaring while nothing overflows
+	if (base.big_ == nullptr) {
+
+		std::int64_t square = base.small_;
+		std::int64_t value = 1;
+		bool overflow = false;
+		std::uint64_t remaining = power;
+
+		while (remaining > 0 && !overflow) {
+			if ((remaining & 1) && __builtin_mul_overflow(value, square, &value)) {
+				overflow = true;
+			} // end if
+			remaining >>= 1;
+			if (remaining > 0 && !overflow && __builtin_mul_overflow(square, square, &square)) {
+				overflow = true;
+			} // end if
+		} // end while
+
+		if (!overflow) {
+			result = Integer(value);
+			return true;
+		} // end if
+
+	} // end if
+
+	Integer square = base;
+	Integer value(1);
+
+	while (power > 0) {
+		if (power & 1) {
+			value = mul(value, square);
+		} // end if
+		power >>= 1;
+		if (power > 0) {
+			square = mul(square, square);
+		} // end if
+	} // end while
+
+	result = value;
+	return true;
+
+} // end of pow
+
+/** Integer Class private methods */
+
+/** fromMagnitude */
+Integer Integer::fromMagnitude(bool negative, Magnitude limbs) {
+
+	trim(limbs);
+
+	if (limbs.size() <= 2) {
+
+		std::uint64_t absolute = limbs.empty() ? 0 : limbs[0];
+		if (limbs.size() == 2) {
+			absolute |= static_cast<std::uint64_t>(limbs[1]) << 32;
+		} // end if
+
+		const std::uint64_t maxSmall = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max());
+
+		if (!negative && absolute <= maxSmall) {
+			return Integer(static_cast<std::int64_t>(absolute));
+		} // end if
+		if (negative && absolute <= maxSmall + 1) {
+			return Integer(static_cast<std::int64_t>(0 - absolute));
+		} // end if
+
+	} // end if
+
+	Integer result;
+	result.big_ = std::make_shared<const Big>(Big{ negative, std::move(limbs) });
+	return result;
+
+} // end of fromMagnitude
+
+/** isNegative */
+bool Integer::isNegative() const {
+
+	return big_ == nullptr ? small_ < 0 : big_->negative_;
+
+} // end of isNegative
+
+/** magnitude */
+Integer::Magnitude Integer::magnitude() const {
+
+	if (big_ != nullptr) {
+		return big_->limbs_;
+	} // end if
+
+	std::uint64_t absolute = small_ < 0 ? 0 - static_cast<std::uint64_t>(small_) : static_cast<std::uint64_t>(small_);
+	Magnitude limbs{ static_cast<std::uint32_t>(absolute), static_cast<std::uint32_t>(absolute >> 32) };
+	trim(limbs);
+
+	return limbs;
+
+} // end of magnitude
+
+/** compareMagnitude */
+int Integer::compareMagnitude(const Magnitude& left, const Magnitude& right) {
+
+	if (left.size() != right.size()) {
+		return left.size() < right.size() ? -1 : 1;
+	} // end if
+
+	for (std::size_t i = left.size(); i-- > 0;) {
+		if (left[i] != right[i]) {
+			return left[i] < right[i] ? -1 : 1;
+		} // end if
+	} // end for
+
+	return 0;
+
+} // end of compareMagnitude
+
+/** addMagnitude */
+Integer::Magnitude Integer::addMagnitude(const Magnitude& left, const Magnitude& right) {
+
+	const Magnitude& longer = left.size() >= right.size() ? left : right;
+	const Magnitude& shorter = left.size() >= right.size() ? right : left;
+
+	Magnitude sum(longer.size() + 1, 0);
+	std::uint64_t carry = 0;
+
+	for (std::size_t i = 0; i < longer.size(); ++i) {
+		carry += static_cast<std::uint64_t>(longer[i]) + (i < shorter.size() ? shorter[i] : 0);
+		sum[i] = static_cast<std::uint32_t>(carry);
+		carry >>= 32;
+	} // end for
+
+	sum[longer.size()] = static_cast<std::uint32_t>(carry);
+	trim(sum);
+
+	return sum;
+
+} // end of addMagnitude
+
+/** subMagnitude */
+Integer::Magnitude Integer::subMagnitude(const Magnitude& left, const Magnitude& right) {
+
+	Magnitude difference(left.size(), 0);
+	std::int64_t borrow = 0;
+
+	for (std::size_t i = 0; i < left.size(); ++i) {
+		std::int64_t cur = static_cast<std::int64_t>(left[i]) - (i < right.size() ? right[i] : 0) - borrow;
+		borrow = cur < 0 ? 1 : 0;
+		difference[i] = static_cast<std::uint32_t>(cur + (borrow << 32));
+	} // end for
+
+	trim(difference);
+
+	return difference;
+
+} // end of subMagnitude
+
+/** mulMagnitude */
+Integer::Magnitude Integer::mulMagnitude(const Magnitude& left, const Magnitude& right) {
+
+	// below this many limbs schoolbook is faster than splitting
+	const std::size_t karatsubaLimbs = 32;
+
+	if (left.empty() || right.empty()) {
+		return Magnitude();
+	} // end if
+
+	std::size_t half = std::max(left.size(), right.size()) / 2;
+
+	// very uneven operands gain nothing from splitting
+	if (std::min(left.size(), right.size()) < karatsubaLimbs || left.size() <= half || right.size() <= half) {
+		return mulSchoolbook(left, right);
+	} // end if
+
+	return mulKaratsuba(left, right);
+
+} // end of mulMagnitude
+
+/** mulSchoolbook */
+Integer::Magnitude Integer::mulSchoolbook(const Magnitude& left, const Magnitude& right) {
+
+	Magnitude product(left.size() + right.size(), 0);
+
+	for (std::size_t i = 0; i < left.size(); ++i) {
+
+		std::uint64_t carry = 0;
+		for (std::size_t j = 0; j < right.size(); ++j) {
+			carry += static_cast<std::uint64_t>(left[i]) * right[j] + product[i + j];
+			product[i + j] = static_cast<std::uint32_t>(carry);
+			carry >>= 32;
+		} // end for
+
+		product[i + right.size()] = static_cast<std::uint32_t>(carry);
+
+	} // end for
+
+	trim(product);
+
+	return product;
+
+} // end of mulSchoolbook
+
+/** mulKaratsuba */
+Integer::Magnitude Integer::mulKaratsuba(const Magnitude& left, const Magnitude& right) {
+
+	std::size_t half = std::max(left.size(), right.size()) / 2;
+
+	// left = leftHigh * B^half + leftLow, same for right
+	Magnitude leftLow(left.begin(), left.begin() + half);
+	Magnitude leftHigh(left.begin() + half, left.end());
+	Magnitude rightLow(right.begin(), right.begin() + half);
+	Magnitude rightHigh(right.begin() + half, right.end());
+	trim(leftLow);
+	trim(rightLow);
+
+	Magnitude low = mulMagnitude(leftLow, rightLow);
+	Magnitude high = mulMagnitude(leftHigh, rightHigh);
+	Magnitude middle = mulMagnitude(addMagnitude(leftLow, leftHigh), addMagnitude(rightLow, rightHigh));
+	middle = subMagnitude(subMagnitude(middle, low), high);
+
+	Magnitude product(left.size() + right.size() + 1, 0);
+	addShifted(product, low, 0);
+	addShifted(product, middle, half);
+	addShifted(product, high, 2 * half);
+	trim(product);
+
+	return product;
+
+} // end of mulKaratsuba
+
+/** addShifted */
+void Integer::addShifted(Magnitude& target, const Magnitude& addend, std::size_t shift) {
+
+	std::uint64_t carry = 0;
+	std::size_t i = 0;
+
+	for (; i < addend.size(); ++i) {
+		carry += static_cast<std::uint64_t>(target[i + shift]) + addend[i];
+		target[i + shift] = static_cast<std::uint32_t>(carry);
+		carry >>= 32;
+	} // end for
+
+	for (; carry != 0; ++i) {
+		carry += target[i + shift];
+		target[i + shift] = static_cast<std::uint32_t>(carry);
+		carry >>= 32;
+	} // end for
+
+} // end of addShifted
+
+/** mulAddSmall */
+void Integer::mulAddSmall(Magnitude& limbs, std::uint32_t factor, std::uint32_t addend) {
+
+	std::uint64_t carry = addend;
+
+	for (std::uint32_t& limb : limbs) {
+		carry += static_cast<std::uint64_t>(limb) * factor;
+		limb = static_cast<std::uint32_t>(carry);
+		carry >>= 32;
+	} // end for
+
+	if (carry != 0) {
+		limbs.push_back(static_cast<std::uint32_t>(carry));
+	} // end if
+
+} // end of mulAddSmall
+
+/** addSigned */
+Integer Integer::addSigned(bool leftNegative, const Magnitude& left, bool rightNegative, const Magnitude& right) {
+
+	if (leftNegative == rightNegative) {
+		return fromMagnitude(leftNegative, addMagnitude(left, right));
+	} // end if
+
+	// signs differ, subtract the smaller magnitude from the larger
+	if (compareMagnitude(left, right) >= 0) {
+		return fromMagnitude(leftNegative, subMagnitude(left, right));
+	} // end if
+
+	return fromMagnitude(rightNegative, subMagnitude(right, left));
+
+} // end of addSigned
+
+/** divSmall */
+std::uint32_t Integer::divSmall(Magnitude& limbs, std::uint32_t divisor) {
+
+	std::uint64_t remainder = 0;
+
+	for (std::size_t i = limbs.size(); i-- > 0;) {
+		std::uint64_t cur = (remainder << 32) | limbs[i];
+		limbs[i] = static_cast<std::uint32_t>(cur / divisor);
+		remainder = cur % divisor;
+	} // end for
+
+	trim(limbs);
+
+	return static_cast<std::uint32_t>(remainder);
+
+} // end of divSmall
+
+/** divMagnitude */
+Integer::Magnitude Integer::divMagnitude(const Magnitude& left, const Magnitude& right) {
+
+	if (right.size() == 1) {
+		Magnitude quotient = left;
+		divSmall(quotient, right[0]);
+		return quotient;
+	} // end if
+
+	const std::uint64_t base = std::uint64_t(1) << 32;
+	std::size_t n = right.size();
+	std::size_t m = left.size() - n;
+
+	// normalize so the divisor's top limb has its high bit set
+	int shift = __builtin_clz(right.back());
+	Magnitude divisor(n);
+	Magnitude dividend(left.size() + 1);
+
+	for (std::size_t i = n; i-- > 1;) {
+		divisor[i] = static_cast<std::uint32_t>((static_cast<std::uint64_t>(right[i]) << shift) | (static_cast<std::uint64_t>(right[i - 1]) >> (32 - shift)));
+	} // end for
+	divisor[0] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(right[0]) << shift);
+
+	dividend[left.size()] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(left.back()) >> (32 - shift));
+	for (std::size_t i = left.size(); i-- > 1;) {
+		dividend[i] = static_cast<std::uint32_t>((static_cast<std::uint64_t>(left[i]) << shift) | (static_cast<std::uint64_t>(left[i - 1]) >> (32 - shift)));
+	} // end for
+	dividend[0] = static_cast<std::uint32_t>(static_cast<std::uint64_t>(left[0]) << shift);
+
+	Magnitude quotient(m + 1, 0);
+
+	for (std::size_t j = m + 1; j-- > 0;) {
+
+		// estimate the quotient limb from the top two limbs
+		std::uint64_t numerator = (static_cast<std::uint64_t>(dividend[j + n]) << 32) | dividend[j + n - 1];
+		std::uint64_t qhat = numerator / divisor[n - 1];
+		std::uint64_t rhat = numerator % divisor[n - 1];
+
+		while (qhat >= base || qhat * divisor[n - 2] > ((rhat << 32) | dividend[j + n - 2])) {
+			--qhat;
+			rhat += divisor[n - 1];
+			if (rhat >= base) {
+				break;
+			} // end if
+		} // end while
+
+		// multiply and subtract
+		std::int64_t borrow = 0;
+		std::int64_t cur = 0;
+		for (std::size_t i = 0; i < n; ++i) {
+			std::uint64_t product = qhat * divisor[i];
+			cur = static_cast<std::int64_t>(dividend[i + j]) - borrow - static_cast<std::int64_t>(product & 0xFFFFFFFFu);
+			dividend[i + j] = static_cast<std::uint32_t>(cur);
+			borrow = static_cast<std::int64_t>(product >> 32) - (cur >> 32);
+		} // end for
+		cur = static_cast<std::int64_t>(dividend[j + n]) - borrow;
+		dividend[j + n] = static_cast<std::uint32_t>(cur);
+
+		quotient[j] = static_cast<std::uint32_t>(qhat);
+
+		// the estimate was one too large, add the divisor back
+		if (cur < 0) {
+			--quotient[j];
+			std::uint64_t carry = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				carry += static_cast<std::uint64_t>(dividend[i + j]) + divisor[i];
+				dividend[i + j] = static_cast<std::uint32_t>(carry);
+				carry >>= 32;
+			} // end for
+			dividend[j + n] = static_cast<std::uint32_t>(dividend[j + n] + carry);
+		} // end if
+
+	} // end for
+
+	trim(quotient);
+
+	return quotient;
+
+} // end of divMagnitude
+
+/** trim */
+void Integer::trim(Magnitude& limbs) {
+
+	while (!limbs.empty() && limbs.back() == 0) {
+		limbs.pop_back();
+	} // end while
+
+} // end of trim
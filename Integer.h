@@ -0,0 +1,185 @@
+/** @file Integer.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements an exact integer that keeps small
+   values in an inline int64 and promotes to a heap bignum only when a
+   result overflows */
+
+#pragma once
+
+// included libraries
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+
+
+/** Integer Class
+ Integers are immutable values, copying a bignum shares its limbs.*/
+class Integer {
+
+public:
+
+   /** Integer constructor
+   @parm std::int64_t [value] small value to hold*/
+   Integer(std::int64_t value = 0);
+
+   /** Integer public methods*/
+
+   /** fromString parses a run of decimal digits of any length
+   @parm std::string_view [digits] decimal digits, Integer [result] parsed value
+   @return true if digits is a non empty run of decimal digits*/
+   static bool fromString(std::string_view digits, Integer& result);
+
+   /** isSmall
+   @return true if the value fits the inline int64*/
+   bool isSmall() const;
+
+   /** getSmall
+   @pre isSmall() is true
+   @return the value as an int64*/
+   std::int64_t getSmall() const;
+
+   /** isZero
+   @return true if the value is 0*/
+   bool isZero() const;
+
+   /** isNegative
+   @return true if the value is below zero*/
+   bool isNegative() const;
+
+   /** bitLength
+   @return the number of bits of the magnitude*/
+   std::uint64_t bitLength() const;
+
+   /** toString
+   @return the decimal text of the value*/
+   std::string toString() const;
+
+   /** appendTo appends the decimal text of the value
+   @parm std::string [str] string to append to*/
+   void appendTo(std::string& str) const;
+
+   /** hash
+   @return a hash of the value, equal values hash equal*/
+   std::size_t hash() const;
+
+   /** operator==
+   @return true if both hold the same value*/
+   bool operator==(const Integer& rhs) const;
+
+   /** operator!=
+   @return true if the values differ*/
+   bool operator!=(const Integer& rhs) const;
+
+   /** add
+   @return left + right*/
+   static Integer add(const Integer& left, const Integer& right);
+
+   /** sub
+   @return left - right*/
+   static Integer sub(const Integer& left, const Integer& right);
+
+   /** mul, Karatsuba for large operands
+   @return left * right*/
+   static Integer mul(const Integer& left, const Integer& right);
+
+   /** div truncates toward zero like the built in operator
+   @parm Integer [left] dividend, Integer [right] divisor, Integer [result] quotient
+   @return false if right is zero*/
+   static bool div(const Integer& left, const Integer& right, Integer& result);
+
+   /** pow by squaring
+   @parm Integer [base] base, Integer [exponent] non negative exponent, Integer [result] base ^ exponent,
+   std::uint64_t [maxBits] largest result to compute
+   @return false if the result would be larger than maxBits bits*/
+   static bool pow(const Integer& base, const Integer& exponent, Integer& result, std::uint64_t maxBits);
+
+private:
+
+   /** Magnitude little endian base 2^32 limbs without leading zero limbs*/
+   using Magnitude = std::vector<std::uint32_t>;
+
+   /** Big Struct */
+   struct Big {
+
+      // true for negative values
+      bool negative_;
+
+      // absolute value
+      Magnitude limbs_;
+
+   };
+
+   /** Integer Attributes*/
+
+   // the value while big_ is empty
+   std::int64_t small_;
+
+   // the value once it does not fit an int64
+   std::shared_ptr<const Big> big_;
+
+   /** Integer private methods*/
+
+   /** fromMagnitude builds a normalized Integer, small when it fits
+   @parm bool [negative] sign, Magnitude [limbs] absolute value
+   @return the Integer*/
+   static Integer fromMagnitude(bool negative, Magnitude limbs);
+
+   /** magnitude
+   @return the absolute value as limbs*/
+   Magnitude magnitude() const;
+
+   /** compareMagnitude
+   @return -1, 0 or 1 as left is below, equal or above right*/
+   static int compareMagnitude(const Magnitude& left, const Magnitude& right);
+
+   /** addMagnitude
+   @return left + right*/
+   static Magnitude addMagnitude(const Magnitude& left, const Magnitude& right);
+
+   /** subMagnitude
+   @pre left is at least right
+   @return left - right*/
+   static Magnitude subMagnitude(const Magnitude& left, const Magnitude& right);
+
+   /** mulMagnitude picks schoolbook or Karatsuba by size
+   @return left * right*/
+   static Magnitude mulMagnitude(const Magnitude& left, const Magnitude& right);
+
+   /** mulSchoolbook
+   @return left * right*/
+   static Magnitude mulSchoolbook(const Magnitude& left, const Magnitude& right);
+
+   /** mulKaratsuba splits both operands in half and does three half size products
+   @return left * right*/
+   static Magnitude mulKaratsuba(const Magnitude& left, const Magnitude& right);
+
+   /** addShifted adds addend shifted up by whole limbs in place
+   @parm Magnitude [target] sum, large enough to hold it, Magnitude [addend] value to add, std::size_t [shift] limbs to shift addend by*/
+   static void addShifted(Magnitude& target, const Magnitude& addend, std::size_t shift);
+
+   /** mulAddSmall multiplies by a single limb and adds a single limb in place
+   @parm Magnitude [limbs] value to update, std::uint32_t [factor] multiplier, std::uint32_t [addend] value to add*/
+   static void mulAddSmall(Magnitude& limbs, std::uint32_t factor, std::uint32_t addend);
+
+   /** addSigned adds two signed magnitudes
+   @return the normalized sum*/
+   static Integer addSigned(bool leftNegative, const Magnitude& left, bool rightNegative, const Magnitude& right);
+
+   /** divSmall divides by a single limb in place
+   @parm Magnitude [limbs] dividend then quotient, std::uint32_t [divisor] non zero divisor
+   @return the remainder*/
+   static std::uint32_t divSmall(Magnitude& limbs, std::uint32_t divisor);
+
+   /** divMagnitude long division, Knuth algorithm D
+   @pre right is not zero
+   @return left / right*/
+   static Magnitude divMagnitude(const Magnitude& left, const Magnitude& right);
+
+   /** trim removes leading zero limbs
+   @parm Magnitude [limbs] limbs to trim*/
+   static void trim(Magnitude& limbs);
+
+}; // end of Integer
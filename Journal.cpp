@@ -0,0 +1,598 @@
+/** @file Journal.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements an append only journal of the calculator's
+	accepted assignments, replayed at start up to rebuild the variable store */
+
+#include "Journal.h"
+#include "StoreImage.h"
+#include "LineArena.h"
+#include "Tracer.h"
+
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+
+namespace {
+
+	// bytes of the header: magic, version, unused, checksum of the image the records follow
+	const std::size_t headerSize = 24;
+
+	// bytes before a record's body: its length and checksum
+	const std::size_t recordHeaderSize = 8;
+
+	/** appendVarint appends a number seven bits a byte, low bits first
+	@parm std::string [text] string to append to, std::uint64_t [number] number to append*/
+	void appendVarint(std::string& text, std::uint64_t number) {
+
+		while (number >= 0x80) {
+			text += static_cast<char>((number & 0x7f) | 0x80);
+			number >>= 7;
+		} // end while
+
+		text += static_cast<char>(number);
+
+	} // end of appendVarint
+
+	/** readVarint reads a number appendVarint appended
+	@parm char* [next] next byte to read, moved past the number, char* [end] end of the bytes, std::uint64_t [number] number read
+	@return false if the bytes end first or the number does not fit*/
+	bool readVarint(const char*& next, const char* end, std::uint64_t& number) {
+
+		number = 0;
+
+		for (int shift = 0; shift < 64 && next != end; shift += 7) {
+
+			std::uint8_t byte = static_cast<std::uint8_t>(*next++);
+			number |= std::uint64_t(byte & 0x7f) << shift;
+
+			if ((byte & 0x80) == 0) {
+				return true;
+			} // end if
+
+		} // end for
+
+		return false;
+
+	} // end of readVarint
+
+	/** appendFixed appends a number as little endian bytes
+	@parm std::string [text] string to append to, std::uint64_t [number] number to append, int [bytes] bytes to append*/
+	void appendFixed(std::string& text, std::uint64_t number, int bytes) {
+
+		for (int i = 0; i < bytes; ++i) {
+			text += static_cast<char>((number >> (8 * i)) & 0xff);
+		} // end for
+
+	} // end of appendFixed
+
+	/** readFixed reads a number appendFixed appended
+	@parm char* [data] first byte, int [bytes] bytes to read
+	@return the number*/
+	std::uint64_t readFixed(const char* data, int bytes) {
+
+		std::uint64_t number = 0;
+
+		for (int i = 0; i < bytes; ++i) {
+			number |= std::uint64_t(static_cast<std::uint8_t>(data[i])) << (8 * i);
+		} // end for
+
+		return number;
+
+	} // end of readFixed
+
+	/** recordChecksum
+	@parm char* [data] first byte of a record's body, std::size_t [size] bytes of the body
+	@return the low 32 bits of the body's FNV-1a hash*/
+	std::uint32_t recordChecksum(const char* data, std::size_t size) {
+
+		return static_cast<std::uint32_t>(StoreImage::checksum(data, size));
+
+	} // end of recordChecksum
+
+} // end namespace
+
+
+/** Journal Class public methods */
+
+/** Journal constructor */
+Journal::Journal(const std::string& fileName, std::size_t groupSize, std::uint64_t compactBytes)
+	:fileName_(fileName), imageName_(fileName + ".img"), groupSize_(std::max<std::size_t>(groupSize, 1)), compactBytes_(compactBytes) {
+} // end constructor
+
+/** Journal destructor */
+Journal::~Journal() {
+
+	commit();
+
+	if (file_ != nullptr) {
+		std::fclose(file_);
+	} // end if
+
+} // end destructor
+
+/** restore */
+bool Journal::restore(VariableStore& store, std::string& error) {
+
+	Tracer::Span span("Journal::restore");
+
+	std::ifstream journalFile(fileName_, std::ios::binary);
+
+	// a new journal follows no image
+	if (!journalFile) {
+
+		if (!writeEmpty(fileName_, 0) || !openForAppend()) {
+			error = "Could Not Create " + fileName_;
+			return false;
+		} // end if
+
+		return true;
+
+	} // end if
+
+	std::string contents((std::istreambuf_iterator<char>(journalFile)), std::istreambuf_iterator<char>());
+	journalFile.close();
+
+	if (contents.size() < headerSize || std::memcmp(contents.data(), magic, sizeof(magic)) != 0) {
+		error = fileName_ + " Is Not A Journal";
+		return false;
+	} // end if
+
+	if (readFixed(contents.data() + 8, 4) != version) {
+		error = fileName_ + " Was Written By Another Version";
+		return false;
+	} // end if
+
+	std::uint64_t followed = readFixed(contents.data() + 16, 8);
+	std::uint64_t imageChecksum = 0;
+	bool hasImage = StoreImage::readChecksum(imageName_, imageChecksum);
+
+	if (followed != 0 && !hasImage) {
+		error = fileName_ + " Follows " + imageName_ + ", Which Could Not Be Read";
+		return false;
+	} // end if
+
+	if (hasImage && !store.load(imageName_, error)) {
+		return false;
+	} // end if
+
+	// an image the journal does not name was saved by a compaction that stopped
+	// before it restarted the journal, the image already holds every record
+	if (hasImage && imageChecksum != followed) {
+
+		if (!writeEmpty(fileName_, imageChecksum) || !openForAppend()) {
+			error = "Could Not Write " + fileName_;
+			return false;
+		} // end if
+
+		return true;
+
+	} // end if
+
+	std::size_t whole = replay(contents, store);
+
+	// the torn tail is cut off so new records follow the last whole one
+	if (whole != contents.size()) {
+
+		std::error_code resizeError;
+		std::filesystem::resize_file(fileName_, whole, resizeError);
+
+		if (resizeError) {
+			error = "Could Not Truncate " + fileName_;
+			return false;
+		} // end if
+
+	} // end if
+
+	if (!openForAppend()) {
+		error = "Could Not Open " + fileName_;
+		return false;
+	} // end if
+
+	recordBytes_ = whole - headerSize;
+	return true;
+
+} // end of restore
+
+/** append */
+void Journal::append(std::uint32_t symbol, const AST& expression) {
+
+	const std::pmr::vector<AST::Entry>& flat = expression.flatten();
+
+	if (file_ == nullptr || flat.empty()) {
+		return;
+	} // end if
+
+	// the record names its symbols, so it does not depend on the ids of this run
+	names_.assign(1, symbol);
+	auto nameIndex = [this](std::uint32_t name) {
+		std::size_t index = std::find(names_.begin(), names_.end(), name) - names_.begin();
+		if (index == names_.size()) {
+			names_.push_back(name);
+		} // end if
+		return static_cast<std::uint64_t>(index);
+	};
+
+	for (const AST::Entry& entry : flat) {
+		if (entry.tok_.getType() == TokType::variable) {
+			nameIndex(entry.tok_.getSymbol());
+		} // end if
+	} // end for
+
+	body_.clear();
+	appendVarint(body_, names_.size());
+
+	for (std::uint32_t name : names_) {
+		std::string_view text = Token::symbolName(name);
+		appendVarint(body_, text.size());
+		body_.append(text.data(), text.size());
+	} // end for
+
+	// the variable assigned is the first name, then the nodes in post order
+	appendVarint(body_, 0);
+	appendVarint(body_, flat.size());
+
+	for (std::uint32_t i = 0; i < flat.size(); ++i) {
+
+		const Token& tok = flat[i].tok_;
+		bool big = tok.isBigNumber();
+
+		body_ += static_cast<char>(static_cast<std::uint8_t>(tok.getType()) | (static_cast<std::uint8_t>(tok.getOp()) << 4) | (big ? 0x80 : 0));
+
+		// operands are named by how far back they are, usually a byte each
+		if (AST::isOperator(tok.getType())) {
+			appendVarint(body_, i - flat[i].left_);
+			appendVarint(body_, i - flat[i].right_);
+		}
+		else if (tok.getType() == TokType::variable) {
+			appendVarint(body_, nameIndex(tok.getSymbol()));
+		}
+		else if (big) {
+			std::string digits = tok.getInteger().toString();
+			appendVarint(body_, digits.size());
+			body_ += digits;
+		}
+		else {
+			// zigzag, so small negative numbers stay short
+			std::uint64_t number = static_cast<std::uint64_t>(tok.getNumber());
+			appendVarint(body_, (number << 1) ^ (0 - (number >> 63)));
+		} // end if
+
+	} // end for
+
+	appendFixed(pending_, body_.size(), 4);
+	appendFixed(pending_, recordChecksum(body_.data(), body_.size()), 4);
+	pending_ += body_;
+
+	recordBytes_ += recordHeaderSize + body_.size();
+	++pendingCount_;
+
+	if (pendingCount_ >= groupSize_) {
+		commit();
+	} // end if
+
+} // end of append
+
+/** commit */
+bool Journal::commit() {
+
+	if (file_ == nullptr || pending_.empty()) {
+		return error_.empty();
+	} // end if
+
+	Tracer::Span span("Journal::commit");
+
+	// the whole group is written and synced once
+	bool written = std::fwrite(pending_.data(), 1, pending_.size(), file_) == pending_.size() && std::fflush(file_) == 0;
+
+#ifndef _WIN32
+	written = written && fsync(fileno(file_)) == 0;
+#else
+	written = written && _commit(_fileno(file_)) == 0;
+#endif
+
+	pending_.clear();
+	pendingCount_ = 0;
+
+	if (!written) {
+		return fail("Could Not Write " + fileName_);
+	} // end if
+
+	return true;
+
+} // end of commit
+
+/** compact */
+bool Journal::compact(VariableStore& store) {
+
+	if (file_ == nullptr) {
+		return error_.empty();
+	} // end if
+
+	Tracer::Span span("Journal::compact");
+
+	// the image holds the buffered records too, so they are dropped
+	pending_.clear();
+	pendingCount_ = 0;
+	std::fclose(file_);
+	file_ = nullptr;
+
+	// save syncs the image before it replaces the old one, and the journal only
+	// names it once it is in place, so a crash at any step leaves a store to restore
+	std::string error;
+	std::uint64_t imageChecksum = 0;
+
+	if (!store.save(imageName_, error)) {
+		return fail(error);
+	} // end if
+
+	if (!StoreImage::readChecksum(imageName_, imageChecksum)) {
+		return fail("Could Not Read " + imageName_);
+	} // end if
+
+	if (!writeEmpty(fileName_, imageChecksum) || !openForAppend()) {
+		return fail("Could Not Write " + fileName_);
+	} // end if
+
+	recordBytes_ = 0;
+	return true;
+
+} // end of compact
+
+/** compactIfDue */
+bool Journal::compactIfDue(VariableStore& store) {
+
+	if (recordBytes_ >= compactBytes_) {
+		return compact(store);
+	} // end if
+
+	return error_.empty();
+
+} // end of compactIfDue
+
+/** failed */
+bool Journal::failed() const {
+
+	return !error_.empty();
+
+} // end of failed
+
+/** error */
+const std::string& Journal::error() const {
+
+	return error_;
+
+} // end of error
+
+/** replayedCount */
+std::uint64_t Journal::replayedCount() const {
+
+	return replayedCount_;
+
+} // end of replayedCount
+
+/** Journal Class private methods */
+
+/** replay */
+std::size_t Journal::replay(const std::string& contents, VariableStore& store) {
+
+	Tracer::Span span("Journal::replay");
+
+	std::size_t next = headerSize;
+	std::vector<std::uint32_t> cycle;
+
+	while (contents.size() - next >= recordHeaderSize) {
+
+		std::size_t size = static_cast<std::size_t>(readFixed(contents.data() + next, 4));
+		std::uint32_t checksum = static_cast<std::uint32_t>(readFixed(contents.data() + next + 4, 4));
+		const char* body = contents.data() + next + recordHeaderSize;
+
+		if (contents.size() - next - recordHeaderSize < size || recordChecksum(body, size) != checksum) {
+			break;
+		} // end if
+
+		// each record is a line's worth of scratch
+		LineArena::Scope lineScope;
+		std::uint32_t symbol = 0;
+		AST expression;
+
+		if (!decode(body, size, symbol, expression)) {
+			break;
+		} // end if
+
+		// every record was accepted when it was written, so none makes a cycle
+		store.assign(symbol, expression, cycle);
+
+		next += recordHeaderSize + size;
+		++replayedCount_;
+
+	} // end while
+
+	return next;
+
+} // end of replay
+
+/** decode */
+bool Journal::decode(const char* data, std::size_t size, std::uint32_t& symbol, AST& expression) {
+
+	const char* next = data;
+	const char* end = data + size;
+	std::uint64_t count = 0;
+
+	if (!readVarint(next, end, count) || count == 0 || count > size) {
+		return false;
+	} // end if
+
+	std::pmr::vector<std::uint32_t> names(LineArena::resource());
+	names.reserve(static_cast<std::size_t>(count));
+
+	for (std::uint64_t i = 0; i < count; ++i) {
+
+		std::uint64_t length = 0;
+
+		if (!readVarint(next, end, length) || length == 0 || length > static_cast<std::uint64_t>(end - next)) {
+			return false;
+		} // end if
+
+		names.push_back(Token::internSymbol(std::string_view(next, static_cast<std::size_t>(length))));
+		next += length;
+
+	} // end for
+
+	std::uint64_t target = 0;
+	std::uint64_t nodeCount = 0;
+
+	if (!readVarint(next, end, target) || target >= names.size() || !readVarint(next, end, nodeCount)
+		|| nodeCount == 0 || nodeCount > static_cast<std::uint64_t>(end - next)) {
+		return false;
+	} // end if
+
+	std::pmr::vector<AST::Entry> flat(LineArena::resource());
+	flat.reserve(static_cast<std::size_t>(nodeCount));
+
+	for (std::uint32_t i = 0; i < nodeCount; ++i) {
+
+		if (next == end) {
+			return false;
+		} // end if
+
+		std::uint8_t tag = static_cast<std::uint8_t>(*next++);
+		TokType type = static_cast<TokType>(tag & 0x0f);
+		OpCode op = static_cast<OpCode>((tag >> 4) & 0x07);
+		bool big = (tag & 0x80) != 0;
+
+		if (op > OpCode::pow) {
+			return false;
+		} // end if
+
+		AST::Entry entry = { Token(type, op), 0, 0 };
+		std::uint64_t first = 0;
+		std::uint64_t second = 0;
+
+		if (AST::isOperator(type)) {
+
+			if (!readVarint(next, end, first) || !readVarint(next, end, second) || first == 0 || first > i
+				|| second == 0 || second > i || op == OpCode::none) {
+				return false;
+			} // end if
+
+			entry.left_ = static_cast<std::uint32_t>(i - first);
+			entry.right_ = static_cast<std::uint32_t>(i - second);
+
+		}
+		else if (type == TokType::variable) {
+
+			if (!readVarint(next, end, first) || first >= names.size()) {
+				return false;
+			} // end if
+
+			entry.tok_.setSymbol(names[static_cast<std::size_t>(first)]);
+
+		}
+		else if (type == TokType::number && big) {
+
+			if (!readVarint(next, end, first) || first == 0 || first > static_cast<std::uint64_t>(end - next)) {
+				return false;
+			} // end if
+
+			std::string_view digits(next, static_cast<std::size_t>(first));
+			bool negative = digits.front() == '-';
+			Integer value;
+			next += first;
+
+			if (!Integer::fromString(negative ? digits.substr(1) : digits, value)) {
+				return false;
+			} // end if
+
+			entry.tok_.setInteger(negative ? Integer::sub(Integer(0), value) : value);
+
+		}
+		else if (type == TokType::number) {
+
+			if (!readVarint(next, end, first)) {
+				return false;
+			} // end if
+
+			entry.tok_.setNumber(static_cast<std::int64_t>((first >> 1) ^ (0 - (first & 1))));
+
+		}
+		else {
+			return false;
+		} // end if
+
+		flat.push_back(entry);
+
+	} // end for
+
+	if (next != end) {
+		return false;
+	} // end if
+
+	symbol = names[static_cast<std::size_t>(target)];
+	expression = AST::fromEntries(flat.data(), flat.size());
+	return true;
+
+} // end of decode
+
+/** writeEmpty */
+bool Journal::writeEmpty(const std::string& fileName, std::uint64_t imageChecksum) {
+
+	std::string header(magic, sizeof(magic));
+	appendFixed(header, version, 4);
+	appendFixed(header, 0, 4);
+	appendFixed(header, imageChecksum, 8);
+
+	std::string temp = fileName + ".tmp";
+	std::ofstream journalFile(temp, std::ios::binary | std::ios::trunc);
+	journalFile.write(header.data(), static_cast<std::streamsize>(header.size()));
+	journalFile.close();
+
+	std::error_code renameError;
+
+	if (!journalFile || !StoreImage::syncFile(temp)) {
+		return false;
+	} // end if
+
+	std::filesystem::rename(temp, fileName, renameError);
+
+	return !renameError && StoreImage::syncDirectory(fileName);
+
+} // end of writeEmpty
+
+
+/** openForAppend */
+bool Journal::openForAppend() {
+
+	file_ = std::fopen(fileName_.c_str(), "ab");
+	return file_ != nullptr;
+
+} // end of openForAppend
+
+/** fail */
+bool Journal::fail(const std::string& error) {
+
+	if (error_.empty()) {
+		error_ = error;
+	} // end if
+
+	if (file_ != nullptr) {
+		std::fclose(file_);
+		file_ = nullptr;
+	} // end if
+
+	pending_.clear();
+	pendingCount_ = 0;
+
+	return false;
+
+} // end of fail
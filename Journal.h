@@ -0,0 +1,157 @@
+/** @file Journal.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements an append only journal of the calculator's
+   accepted assignments, replayed at start up to rebuild the variable store */
+
+#pragma once
+
+// included classes
+#include "AST.h"
+#include "VariableStore.h"
+
+// included libraries
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+
+/** Journal Class
+ Every accepted assignment is appended as a record holding the variable and
+ its expression already flattened to post order nodes, so replaying a
+ record builds the tree directly without the lexer or the parser. Records
+ are buffered and written with one fsync per group of groupSize records, or
+ sooner when commit is called, so a crash loses at most the group not yet
+ committed. A record carries its length and checksum, so a record torn by a
+ crash ends the replay and is cut off. Once the journal has grown by
+ compactBytes it is compacted: the store is saved as the image
+ "<journal>.img" and the journal restarts empty, naming the checksum of the
+ image its records follow.*/
+class Journal {
+
+public:
+
+   /** Journal constructor
+   @parm std::string [fileName] journal file, std::size_t [groupSize] records written per fsync,
+   std::uint64_t [compactBytes] bytes appended before the journal is compacted*/
+   explicit Journal(const std::string& fileName, std::size_t groupSize = defaultGroupSize,
+      std::uint64_t compactBytes = defaultCompactBytes);
+
+   /** Journal destructor commits the records still buffered*/
+   ~Journal();
+
+   Journal(const Journal&) = delete;
+   Journal& operator=(const Journal&) = delete;
+
+   /** Journal public methods*/
+
+   /** restore loads the journal's image if it has one and replays its records, then opens it to append
+   @post a torn record at the end is cut off, a journal that does not exist is created
+   @parm VariableStore [store] store to rebuild, std::string [error] why the journal could not be restored
+   @return true if the journal was restored*/
+   bool restore(VariableStore& store, std::string& error);
+
+   /** append buffers the record of an accepted assignment, committing the group once it is full
+   @parm std::uint32_t [symbol] variable assigned, AST [expression] expression as entered*/
+   void append(std::uint32_t symbol, const AST& expression);
+
+   /** commit writes the buffered records and waits for them to reach the disk
+   @return false if the journal has failed*/
+   bool commit();
+
+   /** compact saves the store as the journal's image and restarts the journal empty
+   @parm VariableStore [store] store holding every assignment appended
+   @return false if the journal has failed*/
+   bool compact(VariableStore& store);
+
+   /** compactIfDue compacts once the journal has grown by compactBytes
+   @parm VariableStore [store] store holding every assignment appended
+   @return false if the journal has failed*/
+   bool compactIfDue(VariableStore& store);
+
+   /** failed
+   @return true once a write has failed, later records are dropped*/
+   bool failed() const;
+
+   /** error
+   @return why the journal failed*/
+   const std::string& error() const;
+
+   /** replayedCount
+   @return number of records restore replayed*/
+   std::uint64_t replayedCount() const;
+
+   // records written per fsync
+   static constexpr std::size_t defaultGroupSize = 64;
+
+   // bytes appended before the journal is compacted
+   static constexpr std::uint64_t defaultCompactBytes = 8 * 1024 * 1024;
+
+   // first bytes of a journal
+   static constexpr char magic[8] = { 'C', 'A', 'L', 'C', 'J', 'R', 'N', 'L' };
+
+   // version written, journals of another version are refused
+   static constexpr std::uint32_t version = 1;
+
+private:
+
+   /** Journal Attributes*/
+
+   // journal file and the image it is compacted into
+   std::string fileName_;
+   std::string imageName_;
+
+   // records written per fsync and bytes appended before compacting
+   std::size_t groupSize_;
+   std::uint64_t compactBytes_;
+
+   // journal open to append, nullptr until restored or once failed
+   std::FILE* file_ = nullptr;
+
+   // records encoded and not yet written
+   std::string pending_;
+   std::size_t pendingCount_ = 0;
+
+   // bytes of records in the file and in pending_
+   std::uint64_t recordBytes_ = 0;
+
+   // scratch of append, symbols a record names and its body
+   std::vector<std::uint32_t> names_;
+   std::string body_;
+
+   // why the journal failed, empty while it works
+   std::string error_;
+
+   // records replayed by restore
+   std::uint64_t replayedCount_ = 0;
+
+   /** Journal private methods*/
+
+   /** replay rebuilds the store from the records of a journal's contents
+   @parm std::string [contents] whole journal, VariableStore [store] store to assign to
+   @return bytes of the header and the records that were whole*/
+   std::size_t replay(const std::string& contents, VariableStore& store);
+
+   /** decode rebuilds the assignment a record's body holds
+   @parm char* [data] first byte of the body, std::size_t [size] bytes of the body,
+   std::uint32_t [symbol] variable assigned, AST [expression] expression assigned
+   @return false if the body does not describe a valid expression*/
+   static bool decode(const char* data, std::size_t size, std::uint32_t& symbol, AST& expression);
+
+   /** writeEmpty replaces a file with a journal holding only its header, written aside and renamed over it
+   @parm std::string [fileName] file to replace, std::uint64_t [imageChecksum] checksum of the image the journal follows, 0 for none
+   @return true if the journal was written and reached the disk*/
+   static bool writeEmpty(const std::string& fileName, std::uint64_t imageChecksum);
+
+   /** openForAppend opens the journal to append records
+   @return true if the journal was opened*/
+   bool openForAppend();
+
+   /** fail records why the journal failed and closes it
+   @parm std::string [error] why the journal failed
+   @return false*/
+   bool fail(const std::string& error);
+
+}; // end of Journal
@@ -0,0 +1,216 @@
+/** @file LatencyRecorder.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a recorder of the time each expression
+	line takes, kept as log bucketed histograms plus the slowest lines */
+
+#include "LatencyRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+	/** slower orders lines so the fastest is at the front of a heap
+	@return true if left took longer than right*/
+	template <typename LineType>
+	bool slower(const LineType& left, const LineType& right) {
+
+		return left.nanoseconds_ > right.nanoseconds_;
+
+	} // end of slower
+
+} // end namespace
+
+
+/** LatencyRecorder Class public methods */
+
+/** LatencyRecorder constructor */
+LatencyRecorder::LatencyRecorder(std::size_t slowestCount)
+	:slowestCount_(slowestCount) {
+
+	slowest_.reserve(slowestCount);
+
+} // end constructor
+
+/** record */
+void LatencyRecorder::record(Kind kind, std::uint64_t nanoseconds, int expression, std::string_view input) {
+
+	histograms_[static_cast<int>(kind)].record(nanoseconds);
+
+	if (slowestCount_ == 0) {
+		return;
+	} // end if
+
+	// the text is only copied for a line that makes the list
+	if (slowest_.size() < slowestCount_) {
+		slowest_.push_back({ nanoseconds, expression, kind, std::string(input) });
+		std::push_heap(slowest_.begin(), slowest_.end(), slower<Line>);
+	}
+	else if (nanoseconds > slowest_.front().nanoseconds_) {
+		std::pop_heap(slowest_.begin(), slowest_.end(), slower<Line>);
+		Line& line = slowest_.back();
+		line.nanoseconds_ = nanoseconds;
+		line.expression_ = expression;
+		line.kind_ = kind;
+		line.input_.assign(input.data(), input.size());
+		std::push_heap(slowest_.begin(), slowest_.end(), slower<Line>);
+	} // end if
+
+} // end of record
+
+/** writeJson */
+void LatencyRecorder::writeJson(std::ostream& out) const {
+
+	const char* const kindNames[2] = { "numeric", "symbolic" };
+
+	out << "{\n";
+
+	for (int kind = 0; kind < 2; ++kind) {
+
+		const Histogram& histogram = histograms_[kind];
+
+		out << "  \"" << kindNames[kind] << "\": { \"count\": " << histogram.count()
+			<< ", \"p50_ns\": " << histogram.percentile(50.0)
+			<< ", \"p90_ns\": " << histogram.percentile(90.0)
+			<< ", \"p99_ns\": " << histogram.percentile(99.0)
+			<< ", \"p99_9_ns\": " << histogram.percentile(99.9)
+			<< ", \"max_ns\": " << histogram.max() << " },\n";
+
+	} // end for
+
+	// the heap holds the fastest first, write the slowest first
+	std::vector<Line> lines(slowest_);
+	std::sort(lines.begin(), lines.end(), slower<Line>);
+
+	out << "  \"slowest\": [";
+
+	for (std::size_t i = 0; i < lines.size(); ++i) {
+
+		out << (i == 0 ? "\n" : ",\n") << "    { \"expression\": " << lines[i].expression_
+			<< ", \"kind\": \"" << kindNames[static_cast<int>(lines[i].kind_)] << "\", \"ns\": " << lines[i].nanoseconds_
+			<< ", \"input\": ";
+		writeString(out, lines[i].input_);
+		out << " }";
+
+	} // end for
+
+	out << (lines.empty() ? "]\n" : "\n  ]\n") << "}" << std::endl;
+
+} // end of writeJson
+
+/** LatencyRecorder Class private methods */
+
+/** writeString */
+void LatencyRecorder::writeString(std::ostream& out, std::string_view text) {
+
+	const char* const hexDigits = "0123456789abcdef";
+
+	out << '"';
+
+	for (char c : text) {
+
+		unsigned char byte = static_cast<unsigned char>(c);
+
+		if (c == '"' || c == '\\') {
+			out << '\\' << c;
+		}
+		else if (byte < 0x20) {
+			out << "\\u00" << hexDigits[byte >> 4] << hexDigits[byte & 0xf];
+		}
+		else {
+			out << c;
+		} // end if
+
+	} // end for
+
+	out << '"';
+
+} // end of writeString
+
+
+/** Histogram Class  */
+
+/** Histogram constructor */
+LatencyRecorder::Histogram::Histogram()
+	:buckets_((64 - subBucketBits + 1) * subBucketCount, 0), count_(0), max_(0) {
+} // end constructor
+
+/** record */
+void LatencyRecorder::Histogram::record(std::uint64_t value) {
+
+	++buckets_[bucketOf(value)];
+	++count_;
+	max_ = std::max(max_, value);
+
+} // end of record
+
+/** percentile */
+std::uint64_t LatencyRecorder::Histogram::percentile(double percent) const {
+
+	if (count_ == 0) {
+		return 0;
+	} // end if
+
+	// the value with this many values at or below it
+	std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(count_)));
+	rank = std::min(std::max<std::uint64_t>(rank, 1), count_);
+
+	std::uint64_t seen = 0;
+
+	for (std::size_t bucket = 0; bucket < buckets_.size(); ++bucket) {
+		seen += buckets_[bucket];
+		if (seen >= rank) {
+			return std::min(highestIn(bucket), max_);
+		} // end if
+	} // end for
+
+	return max_;
+
+} // end of percentile
+
+/** count */
+std::uint64_t LatencyRecorder::Histogram::count() const {
+
+	return count_;
+
+} // end of count
+
+/** max */
+std::uint64_t LatencyRecorder::Histogram::max() const {
+
+	return max_;
+
+} // end of max
+
+/** bucketOf */
+std::size_t LatencyRecorder::Histogram::bucketOf(std::uint64_t value) {
+
+	// small values get a bucket each
+	if (value < subBucketCount) {
+		return static_cast<std::size_t>(value);
+	} // end if
+
+	// otherwise the power of two picks the row and the next bits the bucket in it
+	unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+	std::uint64_t sub = (value >> (exponent - subBucketBits)) - subBucketCount;
+
+	return static_cast<std::size_t>((exponent - subBucketBits + 1) * subBucketCount + sub);
+
+} // end of bucketOf
+
+/** highestIn */
+std::uint64_t LatencyRecorder::Histogram::highestIn(std::size_t bucket) {
+
+	if (bucket < subBucketCount) {
+		return bucket;
+	} // end if
+
+	unsigned exponent = static_cast<unsigned>(bucket / subBucketCount) + subBucketBits - 1;
+	std::uint64_t sub = bucket % subBucketCount;
+	unsigned shift = exponent - subBucketBits;
+
+	return ((subBucketCount + sub) << shift) + ((std::uint64_t(1) << shift) - 1);
+
+} // end of highestIn
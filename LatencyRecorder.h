@@ -0,0 +1,135 @@
+/** @file LatencyRecorder.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a recorder of the time each expression
+   line takes, kept as log bucketed histograms plus the slowest lines */
+
+#pragma once
+
+// included libraries
+#include <vector>
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <cstdint>
+
+
+/** LatencyRecorder Class
+ Lines with a numeric result and lines left symbolic are recorded in
+ separate histograms. Each histogram splits every power of two into
+ subBucketCount buckets, as HDR histograms do, so a percentile is off by at
+ most 1/subBucketCount of its value while recording stays an array
+ increment. The slowest lines are kept in a min heap of at most
+ slowestCount entries, so only a line slower than all of them copies its text.*/
+class LatencyRecorder {
+
+public:
+
+   /** Kind of result a line printed*/
+   enum class Kind : std::uint8_t { numeric, symbolic };
+
+   /** LatencyRecorder constructor
+   @parm std::size_t [slowestCount] number of slowest lines to keep*/
+   explicit LatencyRecorder(std::size_t slowestCount = 10);
+
+   /** LatencyRecorder public methods*/
+
+   /** record adds a line's time
+   @parm Kind [kind] kind of result, std::uint64_t [nanoseconds] time the line took,
+   int [expression] number the line was echoed with, std::string_view [input] text of the line*/
+   void record(Kind kind, std::uint64_t nanoseconds, int expression, std::string_view input);
+
+   /** writeJson writes the count, p50, p90, p99, p99.9 and max of each kind in
+   nanoseconds and the slowest lines, slowest first
+   @parm std::ostream [out] stream to write to*/
+   void writeJson(std::ostream& out) const;
+
+   // buckets each power of two is split into
+   static constexpr unsigned subBucketBits = 5;
+   static constexpr std::uint64_t subBucketCount = std::uint64_t(1) << subBucketBits;
+
+private:
+
+   /** Histogram Class counts of values in log spaced buckets*/
+   class Histogram {
+
+   public:
+
+      /** Histogram constructor*/
+      Histogram();
+
+      /** record counts a value
+      @parm std::uint64_t [value] value to count*/
+      void record(std::uint64_t value);
+
+      /** percentile
+      @parm double [percent] percentile to find, from 0 to 100
+      @return the highest value of the bucket holding that percentile, at most the largest value recorded*/
+      std::uint64_t percentile(double percent) const;
+
+      /** count
+      @return the number of values recorded*/
+      std::uint64_t count() const;
+
+      /** max
+      @return the largest value recorded*/
+      std::uint64_t max() const;
+
+   private:
+
+      // number of values in each bucket
+      std::vector<std::uint64_t> buckets_;
+
+      // number of values recorded
+      std::uint64_t count_;
+
+      // largest value recorded
+      std::uint64_t max_;
+
+      /** bucketOf
+      @parm std::uint64_t [value] value to place
+      @return the index of the bucket holding value*/
+      static std::size_t bucketOf(std::uint64_t value);
+
+      /** highestIn
+      @parm std::size_t [bucket] bucket index
+      @return the largest value the bucket holds*/
+      static std::uint64_t highestIn(std::size_t bucket);
+
+   }; // end of Histogram
+
+   /** Line Struct one of the slowest lines*/
+   struct Line {
+
+      // time the line took
+      std::uint64_t nanoseconds_;
+
+      // number the line was echoed with
+      int expression_;
+
+      // kind of result
+      Kind kind_;
+
+      // text of the line
+      std::string input_;
+
+   };
+
+   /** LatencyRecorder Attributes*/
+
+   // histogram of each kind, indexed by Kind
+   Histogram histograms_[2];
+
+   // slowest lines, a min heap on nanoseconds_
+   std::vector<Line> slowest_;
+
+   // number of slowest lines to keep
+   std::size_t slowestCount_;
+
+   /** LatencyRecorder private methods*/
+
+   /** writeString writes text as a JSON string
+   @parm std::ostream [out] stream to write to, std::string_view [text] text to quote*/
+   static void writeString(std::ostream& out, std::string_view text);
+
+}; // end of LatencyRecorder
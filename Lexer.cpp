@@ -0,0 +1,361 @@
+/** @file Lexer.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a tokenizer that scans a contiguous
+	buffer of algebraic expressions, either a caller's buffer or blocks
+	read from a stream, without copying the text of each token */
+
+#include "Lexer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <string>
+
+
+/** Lexer Class public methods */
+
+/** Lexer constructor over a caller's buffer */
+Lexer::Lexer(std::string_view buffer)
+	:is_(nullptr), pos_(buffer.data()), end_(buffer.data() + buffer.size()), lineStart_(pos_), lineEnd_(nullptr),
+	eof_(true), tokenCount_(0) {
+
+	findLineEnd();
+
+} // end constructor
+
+/** Lexer constructor over a stream */
+Lexer::Lexer(std::istream& inputStream, std::size_t blockSize)
+	:is_(&inputStream), storage_(std::max<std::size_t>(blockSize, 1)), pos_(storage_.data()), end_(storage_.data()),
+	lineStart_(pos_), lineEnd_(nullptr), eof_(false), tokenCount_(0) {
+} // end constructor
+
+/** Overloaded operator>> */
+Lexer& Lexer::operator>>(Token& rhs) {
+
+	// the newline token was read, the next line starts here
+	if (lineEnd_ == nullptr || pos_ > lineEnd_) {
+		findLineEnd();
+	} // end if
+
+	// skip white space
+	while (pos_ < end_ && *pos_ == ' ') {
+		++pos_;
+	} // end while
+
+	++tokenCount_;
+	const char* start = pos_;
+
+	// end of input reads as "."
+	if (pos_ == end_) {
+		rhs = tokenTable()[static_cast<unsigned char>('.')];
+		lexeme_ = std::string_view(pos_, 0);
+		return *this;
+	} // end if
+
+	char currChar = *pos_++;
+
+	// determine Token Type per currChar, the payload of a single character
+	// token is already set by the table
+	rhs = tokenTable()[static_cast<unsigned char>(currChar)];
+
+	if (rhs.getType() == TokType::number) {
+
+		// multi digit number, accumulated while it fits an int64
+		std::int64_t number = currChar - '0';
+		bool fits = true;
+
+		while (pos_ < end_ && isdigit(static_cast<unsigned char>(*pos_))) {
+			fits = fits && !__builtin_mul_overflow(number, 10, &number) && !__builtin_add_overflow(number, *pos_ - '0', &number);
+			++pos_;
+		} // end while
+
+		if (fits) {
+			rhs.setNumber(number);
+		}
+		else {
+			// digit run longer than an int64, parse it from the buffer
+			Integer value;
+			Integer::fromString(std::string_view(start, static_cast<std::size_t>(pos_ - start)), value);
+			rhs.setInteger(value);
+		} // end if
+
+	}
+	else if (currChar == ':') {
+
+		if (pos_ < end_ && isalpha(static_cast<unsigned char>(*pos_))) {
+
+			// calculator command, its name runs to the first space and the rest of the line is its argument
+			rhs.setType(TokType::command);
+			const char* nameEnd = std::find(pos_, lineEnd_, ' ');
+			const char* argumentStart = nameEnd;
+			const char* argumentEnd = lineEnd_;
+			pos_ = lineEnd_;
+
+			// trim white space and carriage returns around the argument
+			while (argumentStart < argumentEnd && *argumentStart == ' ') {
+				++argumentStart;
+			} // end while
+
+			while (argumentEnd > argumentStart && isspace(static_cast<unsigned char>(argumentEnd[-1]))) {
+				--argumentEnd;
+			} // end while
+
+			// command names are case insensitive and only the name is interned, the argument,
+			// such as a file name, is kept as entered and never enters the symbol table
+			std::string commandName(start + 1, nameEnd);
+			while (!commandName.empty() && isspace(static_cast<unsigned char>(commandName.back()))) {
+				commandName.pop_back();
+			} // end while
+
+			for (char& c : commandName) {
+				c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+			} // end for
+
+			rhs.setSymbol(Token::internSymbol(commandName));
+			argument_ = std::string_view(argumentStart, static_cast<std::size_t>(argumentEnd - argumentStart));
+
+		}
+		else if (pos_ < end_ && *pos_ == '=') {
+			++pos_;
+		}
+		else {
+			//special case
+			// incomplete assignment token provided
+			rhs.setType(TokType::unknown);
+			rhs.setNumber(':');
+		} // end if
+
+	}
+	lexeme_ = std::string_view(start, static_cast<std::size_t>(pos_ - start));
+
+	return *this;
+
+} // end of operator>>
+
+/** lexeme */
+std::string_view Lexer::lexeme() const {
+
+	return lexeme_;
+
+} // end of lexeme
+
+/** argument */
+std::string_view Lexer::argument() const {
+
+	return argument_;
+
+} // end of argument
+
+/** column */
+std::size_t Lexer::column() const {
+
+	return static_cast<std::size_t>(lexeme_.data() - lineStart_) + 1;
+
+} // end of column
+
+/** tokenCount */
+std::uint64_t Lexer::tokenCount() const {
+
+	return tokenCount_;
+
+} // end of tokenCount
+
+/** good */
+bool Lexer::good() const {
+
+	return pos_ < end_ || (is_ != nullptr && !eof_ && is_->good());
+
+} // end of good
+
+/** peekLine */
+std::string_view Lexer::peekLine() {
+
+	// the newline token was read, the next line starts here
+	if (lineEnd_ == nullptr || pos_ > lineEnd_) {
+		findLineEnd();
+	} // end if
+
+	return std::string_view(pos_, static_cast<std::size_t>(lineEnd_ - pos_));
+
+} // end of peekLine
+
+/** skipLine */
+bool Lexer::skipLine() {
+
+	bool ended = (lineEnd_ == end_);
+	pos_ = ended ? end_ : lineEnd_ + 1;
+
+	return ended;
+
+} // end of skipLine
+
+/** setWaitHook */
+void Lexer::setWaitHook(std::function<void()> hook) {
+
+	waitHook_ = std::move(hook);
+
+} // end of setWaitHook
+
+/** Lexer Class private methods */
+
+/** findLineEnd */
+void Lexer::findLineEnd() {
+
+	// characters already searched, kept across refills that move the buffer
+	std::size_t scanned = 0;
+
+	for (;;) {
+
+		std::size_t held = static_cast<std::size_t>(end_ - pos_);
+		const void* found = (held > scanned) ? std::memchr(pos_ + scanned, '\n', held - scanned) : nullptr;
+
+		if (found != nullptr) {
+			lineStart_ = pos_;
+			lineEnd_ = static_cast<const char*>(found);
+			return;
+		} // end if
+
+		scanned = held;
+
+		if (!refill()) {
+			lineStart_ = pos_;
+			lineEnd_ = end_;
+			return;
+		} // end if
+
+	} // end for
+
+} // end of findLineEnd
+
+/** refill */
+bool Lexer::refill() {
+
+	if (is_ == nullptr || eof_) {
+		return false;
+	} // end if
+
+	// keep the unread characters, a line longer than the buffer grows it
+	std::size_t kept = static_cast<std::size_t>(end_ - pos_);
+	std::memmove(storage_.data(), pos_, kept);
+
+	if (kept == storage_.size()) {
+		storage_.resize(storage_.size() * 2);
+	} // end if
+
+	std::streambuf* buffer = is_->rdbuf();
+	char* dest = storage_.data() + kept;
+	std::size_t room = storage_.size() - kept;
+	std::size_t count = 0;
+
+	// take what the stream already has, but wait for at least one character
+	std::streamsize available = buffer->in_avail();
+
+	if (available <= 0) {
+
+		// let the caller finish what it holds before the read blocks
+		if (waitHook_) {
+			waitHook_();
+		} // end if
+
+		int nextChar = buffer->sbumpc();
+		if (nextChar == std::char_traits<char>::eof()) {
+			eof_ = true;
+			is_->setstate(std::ios::eofbit);
+		}
+		else {
+			dest[count++] = static_cast<char>(nextChar);
+			available = buffer->in_avail();
+		} // end if
+
+	} // end if
+
+	if (available > 0 && count < room) {
+		std::streamsize wanted = std::min<std::streamsize>(available, static_cast<std::streamsize>(room - count));
+		count += static_cast<std::size_t>(buffer->sgetn(dest + count, wanted));
+	} // end if
+
+	pos_ = storage_.data();
+	end_ = pos_ + kept + count;
+
+	return count > 0;
+
+} // end of refill
+
+/** tokenTable */
+const Token* Lexer::tokenTable() {
+
+	static const std::vector<Token> table = [] {
+
+		std::vector<Token> tokens(256);
+
+		for (int input = 0; input < 256; ++input) {
+
+			Token& curToken = tokens[static_cast<std::size_t>(input)];
+			char inputChar = static_cast<char>(input);
+			determineTokenType(inputChar, curToken);
+
+			if (curToken.getType() == TokType::variable) {
+				// variables are interned, a to z are the symbols 0 to 25
+				curToken.setSymbol(static_cast<std::uint32_t>(tolower(input) - 'a'));
+			}
+			else if (curToken.getType() == TokType::unknown) {
+				// keep the character for error reporting
+				curToken.setNumber(input);
+			} // end if
+
+		} // end for
+
+		return tokens;
+
+	}();
+
+	return table.data();
+
+} // end of tokenTable
+
+/**  determineTokenType */
+void Lexer::determineTokenType(char input, Token& curToken) {
+
+	// operators carry their exact operation
+	curToken.setOp(OpCode::none);
+
+	// determine Token type
+	if (isdigit(static_cast<unsigned char>(input))) {
+		curToken.setType(TokType::number);
+	}
+	else if (isalpha(static_cast<unsigned char>(input))) {
+		curToken.setType(TokType::variable);
+	}
+	else if (input == '+' || input == '-') {
+		curToken.setType(TokType::addminusop);
+		curToken.setOp(input == '+' ? OpCode::add : OpCode::sub);
+	}
+	else if (input == '*' || input == '/') {
+		curToken.setType(TokType::muldivop);
+		curToken.setOp(input == '*' ? OpCode::mul : OpCode::div);
+	}
+	else if (input == '^') {
+		curToken.setType(TokType::powop);
+		curToken.setOp(OpCode::pow);
+	}
+	else if (input == '(') {
+		curToken.setType(TokType::lparen);
+	}
+	else if (input == ')') {
+		curToken.setType(TokType::rparen);
+	}
+	else if (input == ':') {
+		curToken.setType(TokType::assign);
+	}
+	else if (input == '.') { // is end
+		curToken.setType(TokType::end);
+	}
+	else if (input == '\n') {
+		curToken.setType(TokType::newline);
+	}
+	else {
+		curToken.setType(TokType::unknown);
+	} // end if
+
+} // end determineTokenType
@@ -0,0 +1,139 @@
+/** @file Lexer.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a tokenizer that scans a contiguous
+   buffer of algebraic expressions, either a caller's buffer or blocks
+   read from a stream, without copying the text of each token */
+
+#pragma once
+
+// included classes
+#include "Token.h"
+
+// included libraries
+#include <istream>
+#include <functional>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+
+/** Lexer Class
+ Tokens never span a line, so before scanning a line the lexer makes sure
+ the whole line is in its buffer, reading from the stream only what is
+ already available plus at least one character, which keeps interactive
+ input responsive. Before a read that may wait for input it calls the wait
+ hook, so the caller can flush what it has buffered. The text of the last token is a view into the buffer.*/
+class Lexer {
+
+public:
+
+   /** Lexer constructor over a caller's buffer
+   @parm std::string_view [buffer] text to scan, must outlive the lexer*/
+   explicit Lexer(std::string_view buffer);
+
+   /** Lexer constructor over a stream
+   @parm std::istream [inputStream] stream to read in blocks, std::size_t [blockSize] bytes to hold at least*/
+   explicit Lexer(std::istream& inputStream, std::size_t blockSize = defaultBlockSize);
+
+   /** Lexer public methods*/
+
+   /** overloaded operator>> scans the next token, the end of input reads as "."
+   @post Token object's values set from the buffer
+   @return the lexer*/
+   Lexer& operator>>(Token& rhs);
+
+   /** lexeme
+   @return the text of the last token read, valid until the next token is read*/
+   std::string_view lexeme() const;
+
+   /** argument
+   @return the argument following the name of the last command token read, as entered without the white space
+   around it, valid until the next token is read*/
+   std::string_view argument() const;
+
+   /** column
+   @return the 1 based column of the last token read within its line*/
+   std::size_t column() const;
+
+   /** tokenCount
+   @return the number of tokens read*/
+   std::uint64_t tokenCount() const;
+
+   /** good
+   @return true while input remains to be read*/
+   bool good() const;
+
+   /** peekLine finds the rest of the current line without reading a token
+   @return the characters up to the newline ending the line, valid until the next token is read*/
+   std::string_view peekLine();
+
+   /** skipLine moves past the current line and its newline without reading its tokens
+   @return true if the input ended the line*/
+   bool skipLine();
+
+   /** setWaitHook sets what is called before a read from the stream that may wait for input
+   @parm std::function<void()> [hook] function to call, empty for none*/
+   void setWaitHook(std::function<void()> hook);
+
+   // bytes read from a stream at a time at most, longer lines grow the buffer
+   static constexpr std::size_t defaultBlockSize = 1 << 20;
+
+private:
+
+   /** Lexer Attributes*/
+
+   // stream to read from, nullptr when scanning a caller's buffer
+   std::istream* is_;
+
+   // buffer holding the unread part of the stream
+   std::vector<char> storage_;
+
+   // next character to scan
+   const char* pos_;
+
+   // one past the last character held
+   const char* end_;
+
+   // first character of the current line
+   const char* lineStart_;
+
+   // the newline ending the current line, or end_ if the input ends first
+   const char* lineEnd_;
+
+   // true once the stream has no more characters
+   bool eof_;
+
+   // text of the last token
+   std::string_view lexeme_;
+
+   // argument of the last command token
+   std::string_view argument_;
+
+   // number of tokens read
+   std::uint64_t tokenCount_;
+
+   // called before a read that may wait
+   std::function<void()> waitHook_;
+
+   /** Lexer private methods*/
+
+   /** findLineEnd finds the newline ending the current line, reading more of the stream if needed
+   @post lineStart_ points at the start of the line, lineEnd_ at the newline, or at end_ if the input ends first*/
+   void findLineEnd();
+
+   /** refill moves the unread characters to the front of the buffer and reads more
+   @return true if any character was read*/
+   bool refill();
+
+   /** tokenTable a token for each character, with its type, operation and
+   the payload a token of that single character has
+   @return the table indexed by unsigned char*/
+   static const Token* tokenTable();
+
+   /** determineTokenType
+   @post the token's type_ and op_ set per the provided char
+   @param char [input], curToken [Token]*/
+   static void determineTokenType(char input, Token& curToken);
+
+}; // end of Lexer
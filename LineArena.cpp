@@ -0,0 +1,63 @@
+/** @file LineArena.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a per thread monotonic arena that the
+	scratch containers used while processing one input line allocate from */
+
+#include "LineArena.h"
+
+
+/** LineArena Class public methods */
+
+/** Scope constructor */
+LineArena::Scope::Scope() {
+
+	++local().depth_;
+
+} // end constructor
+
+/** Scope destructor */
+LineArena::Scope::~Scope() {
+
+	LineArena& arena = local();
+
+	// what the line allocated is dead, start over from the initial buffer
+	if (--arena.depth_ == 0) {
+		arena.arena_.release();
+	} // end if
+
+} // end destructor
+
+/** resource */
+std::pmr::memory_resource* LineArena::resource() {
+
+	LineArena& arena = local();
+	return (arena.depth_ > 0) ? &arena.arena_ : std::pmr::new_delete_resource();
+
+} // end of resource
+
+/** LineArena Class private methods */
+
+/** LineArena constructor */
+LineArena::LineArena()
+	:upstream_(MemoryAccount::Origin::lineScratch, std::pmr::new_delete_resource()), buffer_(new std::byte[initialSize]),
+	arena_(buffer_.get(), initialSize, &upstream_), depth_(0) {
+
+	MemoryAccount::allocated(MemoryAccount::Origin::lineScratch, initialSize);
+
+} // end constructor
+
+/** LineArena destructor */
+LineArena::~LineArena() {
+
+	MemoryAccount::deallocated(MemoryAccount::Origin::lineScratch, initialSize);
+
+} // end destructor
+
+/** local */
+LineArena& LineArena::local() {
+
+	thread_local LineArena arena;
+	return arena;
+
+} // end of local
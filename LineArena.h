@@ -0,0 +1,83 @@
+/** @file LineArena.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a per thread monotonic arena that the
+   scratch containers used while processing one input line allocate from */
+
+#pragma once
+
+// included libraries
+#include "MemoryAccount.h"
+
+#include <memory_resource>
+#include <memory>
+#include <cstddef>
+
+
+/** LineArena Class
+ Inside a Scope, resource() hands out a monotonic buffer that only grows
+ until the outermost Scope ends and rewinds it, so the vectors, stacks and
+ maps a line needs cost a pointer bump instead of a heap call. The buffer
+ each thread starts with is kept, so a line that fits in it allocates
+ nothing from the heap. The initial buffer and what the arena grows by are
+ counted as line scratch. Outside a Scope resource() is the heap, so code
+ that runs without one keeps working.*/
+class LineArena {
+
+public:
+
+   /** Scope Class the processing of one line*/
+   class Scope {
+
+   public:
+
+      /** Scope constructor starts using the calling thread's arena*/
+      Scope();
+
+      /** Scope destructor rewinds the arena when the outermost scope ends*/
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   }; // end of Scope
+
+   /** LineArena public methods*/
+
+   /** resource
+   @return the calling thread's arena inside a Scope, otherwise the heap. A container
+   allocating from the arena must not outlive the Scope it was made in*/
+   static std::pmr::memory_resource* resource();
+
+   // bytes each thread's arena holds before it grows from the heap
+   static constexpr std::size_t initialSize = 64 * 1024;
+
+private:
+
+   /** LineArena constructor*/
+   LineArena();
+
+   /** LineArena destructor*/
+   ~LineArena();
+
+   /** LineArena Attributes*/
+
+   // heap the arena grows from, counted as line scratch
+   MemoryAccount::Resource upstream_;
+
+   // buffer the arena starts from and rewinds to
+   std::unique_ptr<std::byte[]> buffer_;
+
+   // monotonic resource over buffer_
+   std::pmr::monotonic_buffer_resource arena_;
+
+   // number of open scopes
+   int depth_;
+
+   /** LineArena private methods*/
+
+   /** local
+   @return the calling thread's arena*/
+   static LineArena& local();
+
+}; // end of LineArena
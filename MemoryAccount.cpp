@@ -0,0 +1,210 @@
+/** @file MemoryAccount.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements the calculator's memory accounting: the
+	bytes in use, the peak and the number of allocations of each origin */
+
+#include "MemoryAccount.h"
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+
+namespace {
+
+	// number of origins
+	const int originCount = static_cast<int>(MemoryAccount::Origin::count);
+
+	// names printed by report, in enum order
+	const char* const originNames[originCount] = { "nodes", "layouts", "intern table", "programs", "big numbers", "symbols",
+		"node pool", "line scratch" };
+
+} // end namespace
+
+
+/** Registry Struct */
+struct MemoryAccount::Registry {
+
+	// guards the list and the finished counts
+	std::mutex mutex_;
+
+	// blocks of the threads still running
+	std::vector<const Block*> blocks_;
+
+	// counts of the threads that have finished, bytes in use are kept for the big numbers they left
+	std::uint64_t current_[originCount] = {};
+	std::uint64_t peak_[originCount] = {};
+	std::uint64_t allocations_[originCount] = {};
+
+};
+
+
+/** MemoryAccount Class public methods */
+
+/** allocated */
+void MemoryAccount::allocated(Origin origin, std::size_t bytes) {
+
+	Block& block = local();
+	int index = static_cast<int>(origin);
+
+	// only the owning thread writes, so a load and a store do not lose an add
+	std::uint64_t current = block.current_[index].load(std::memory_order_relaxed) + bytes;
+	block.current_[index].store(current, std::memory_order_relaxed);
+	block.allocations_[index].store(block.allocations_[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	if (current > block.peak_[index].load(std::memory_order_relaxed)) {
+		block.peak_[index].store(current, std::memory_order_relaxed);
+	} // end if
+
+} // end of allocated
+
+/** deallocated */
+void MemoryAccount::deallocated(Origin origin, std::size_t bytes) {
+
+	Block& block = local();
+	int index = static_cast<int>(origin);
+
+	block.current_[index].store(block.current_[index].load(std::memory_order_relaxed) - bytes, std::memory_order_relaxed);
+
+} // end of deallocated
+
+/** usage */
+MemoryAccount::Usage MemoryAccount::usage(Origin origin) {
+
+	int index = static_cast<int>(origin);
+	Usage sum;
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+
+	sum.current_ = reg.current_[index];
+	sum.peak_ = reg.peak_[index];
+	sum.allocations_ = reg.allocations_[index];
+
+	// a thread's bytes in use wrap below zero when it frees what another thread made, the sum does not
+	for (const Block* block : reg.blocks_) {
+		sum.current_ += block->current_[index].load(std::memory_order_relaxed);
+		sum.peak_ += block->peak_[index].load(std::memory_order_relaxed);
+		sum.allocations_ += block->allocations_[index].load(std::memory_order_relaxed);
+	} // end for
+
+	return sum;
+
+} // end of usage
+
+/** report */
+void MemoryAccount::report(std::ostream& out) {
+
+	std::uint64_t totalCurrent = 0;
+	std::uint64_t totalPeak = 0;
+
+	for (int origin = 0; origin < originCount; ++origin) {
+
+		Usage counts = usage(static_cast<Origin>(origin));
+
+		out << "mem [" << originNames[origin] << "]: " << counts.current_ << " bytes, peak " << counts.peak_
+			<< " bytes, " << counts.allocations_ << " allocations\n";
+
+		// the pools' own bytes are already counted by what they hold from the heap
+		if (origin != static_cast<int>(Origin::nodes) && origin != static_cast<int>(Origin::layouts)
+			&& origin != static_cast<int>(Origin::internTable)) {
+			totalCurrent += counts.current_;
+			totalPeak += counts.peak_;
+		} // end if
+
+	} // end for
+
+	out << "mem: " << totalCurrent << " bytes from the heap, peak " << totalPeak << " bytes" << std::endl;
+
+} // end of report
+
+/** MemoryAccount Class private methods */
+
+/** registry */
+MemoryAccount::Registry& MemoryAccount::registry() {
+
+	// never destroyed, so threads that end after main can still retire their blocks
+	static Registry* reg = new Registry();
+	return *reg;
+
+} // end of registry
+
+/** local */
+MemoryAccount::Block& MemoryAccount::local() {
+
+	thread_local Block block;
+	return block;
+
+} // end of local
+
+
+/** Resource Class  */
+
+/** Resource constructor */
+MemoryAccount::Resource::Resource(Origin origin, std::pmr::memory_resource* upstream)
+	:origin_(origin), upstream_(upstream) {
+
+	// the thread's block is made first, so it outlives the resource
+	local();
+
+} // end constructor
+
+/** do_allocate */
+void* MemoryAccount::Resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+
+	void* pointer = upstream_->allocate(bytes, alignment);
+	allocated(origin_, bytes);
+
+	return pointer;
+
+} // end of do_allocate
+
+/** do_deallocate */
+void MemoryAccount::Resource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) {
+
+	upstream_->deallocate(pointer, bytes, alignment);
+	deallocated(origin_, bytes);
+
+} // end of do_deallocate
+
+/** do_is_equal */
+bool MemoryAccount::Resource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+
+	return this == &other;
+
+} // end of do_is_equal
+
+
+/** Block Class  */
+
+/** Block constructor */
+MemoryAccount::Block::Block() {
+
+	for (int origin = 0; origin < originCount; ++origin) {
+		current_[origin].store(0, std::memory_order_relaxed);
+		peak_[origin].store(0, std::memory_order_relaxed);
+		allocations_[origin].store(0, std::memory_order_relaxed);
+	} // end for
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+	reg.blocks_.push_back(this);
+
+} // end constructor
+
+/** Block destructor */
+MemoryAccount::Block::~Block() {
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+
+	for (int origin = 0; origin < originCount; ++origin) {
+		reg.current_[origin] += current_[origin].load(std::memory_order_relaxed);
+		reg.peak_[origin] = std::max(reg.peak_[origin], peak_[origin].load(std::memory_order_relaxed));
+		reg.allocations_[origin] += allocations_[origin].load(std::memory_order_relaxed);
+	} // end for
+
+	reg.blocks_.erase(std::find(reg.blocks_.begin(), reg.blocks_.end(), this));
+
+} // end destructor
@@ -0,0 +1,129 @@
+/** @file MemoryAccount.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements the calculator's memory accounting: the
+   bytes in use, the peak and the number of allocations of each origin */
+
+#pragma once
+
+// included libraries
+#include <memory_resource>
+#include <atomic>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+
+/** MemoryAccount Class
+ The calculator's long lived memory comes from a few memory resources, and
+ each is wrapped in a Resource that counts what passes through it under an
+ origin. Nodes, layouts and intern table entries are counted as the bytes
+ they use, while the node pool and line scratch are counted as the bytes
+ they hold from the heap, so the two show how much the pools keep spare.
+ Programs and big numbers are heap objects and are added and removed by
+ hand, and the symbol table allocates through a Resource over the heap.
+ Every thread counts into its own block, like Stats, and report sums the
+ blocks, so the peak reported is the sum of each thread's own peak. A big
+ number may be freed on another thread than the one that made it, so a
+ finished thread's bytes in use are kept and only the sum is exact.*/
+class MemoryAccount {
+
+public:
+
+   /** Origin of memory*/
+   enum class Origin : std::uint8_t { nodes, layouts, internTable, programs, bigNumbers, symbols, nodePool, lineScratch, count };
+
+   /** Usage Struct the counts of one origin over every thread*/
+   struct Usage {
+
+      // bytes in use
+      std::uint64_t current_ = 0;
+
+      // sum of each thread's most bytes in use at once
+      std::uint64_t peak_ = 0;
+
+      // allocations made
+      std::uint64_t allocations_ = 0;
+
+   };
+
+   /** Resource Class a memory resource counting what it passes to its upstream under an origin,
+    used only on the thread that made it*/
+   class Resource : public std::pmr::memory_resource {
+
+   public:
+
+      /** Resource constructor
+      @parm Origin [origin] origin to count under, std::pmr::memory_resource* [upstream] resource that allocates*/
+      Resource(Origin origin, std::pmr::memory_resource* upstream);
+
+   private:
+
+      // origin counted
+      Origin origin_;
+
+      // resource that allocates
+      std::pmr::memory_resource* upstream_;
+
+      /** memory_resource overrides*/
+      void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+      void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+      bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+   }; // end of Resource
+
+   /** MemoryAccount public methods*/
+
+   /** allocated counts memory taken outside a Resource on the calling thread
+   @parm Origin [origin] origin to count under, std::size_t [bytes] bytes taken*/
+   static void allocated(Origin origin, std::size_t bytes);
+
+   /** deallocated counts memory given back outside a Resource on the calling thread
+   @parm Origin [origin] origin to count under, std::size_t [bytes] bytes given back*/
+   static void deallocated(Origin origin, std::size_t bytes);
+
+   /** usage
+   @parm Origin [origin] origin to sum
+   @return the counts of the origin over every thread*/
+   static Usage usage(Origin origin);
+
+   /** report writes the current bytes, peak bytes and allocations of each origin over every thread
+   @parm std::ostream [out] stream to write to*/
+   static void report(std::ostream& out);
+
+private:
+
+   /** Block Struct one thread's counts, atomic only so report can read them while the thread runs*/
+   struct Block {
+
+      /** Block constructor adds the block to the list report sums*/
+      Block();
+
+      /** Block destructor keeps the counts of a finished thread*/
+      ~Block();
+
+      // bytes in use of each origin
+      std::atomic<std::uint64_t> current_[static_cast<int>(Origin::count)];
+
+      // most bytes in use at once of each origin
+      std::atomic<std::uint64_t> peak_[static_cast<int>(Origin::count)];
+
+      // allocations made of each origin
+      std::atomic<std::uint64_t> allocations_[static_cast<int>(Origin::count)];
+
+   }; // end of Block
+
+   /** Registry Struct the blocks of running threads and the counts of finished ones*/
+   struct Registry;
+
+   /** MemoryAccount private methods*/
+
+   /** registry
+   @return the list of blocks report sums*/
+   static Registry& registry();
+
+   /** local
+   @return the calling thread's block*/
+   static Block& local();
+
+}; // end of MemoryAccount
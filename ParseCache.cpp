@@ -0,0 +1,170 @@
+/** @file ParseCache.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a bounded cache of parsed lines, so a
+	line seen before skips the lexer and the parser */
+
+#include "ParseCache.h"
+
+#include <algorithm>
+
+
+namespace {
+
+	/** isDigit
+	@parm char [c] character to check
+	@return true for 0 to 9*/
+	bool isDigit(char c) {
+
+		return c >= '0' && c <= '9';
+
+	} // end of isDigit
+
+} // end namespace
+
+
+/** ParseCache Class public methods */
+
+/** ParseCache constructor */
+ParseCache::ParseCache(std::size_t capacity)
+	:capacity_(std::max<std::size_t>(capacity, 1)) {
+
+	index_.reserve(capacity_);
+
+} // end constructor
+
+/** normalize */
+bool ParseCache::normalize(std::string_view line, std::string& key) {
+
+	key.clear();
+	bool spaced = false;
+
+	for (char c : line) {
+
+		if (c == ' ') {
+			spaced = true;
+			continue;
+		} // end if
+
+		// a "." ends the script and ":" before a letter starts a command, neither is parsed as a line
+		if (c == '.' || (!key.empty() && key.back() == ':' && !spaced && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')))) {
+			return false;
+		} // end if
+
+		// spaces only split two numbers or a ":" from what follows it
+		if (spaced && !key.empty() && (key.back() == ':' || (isDigit(key.back()) && isDigit(c)))) {
+			key += ' ';
+		} // end if
+
+		// variables are case insensitive
+		key += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+		spaced = false;
+
+	} // end for
+
+	return !key.empty();
+
+} // end of normalize
+
+/** errorIndex */
+std::size_t ParseCache::errorIndex(std::string_view line, std::size_t column) {
+
+	std::size_t end = std::min(column - 1, line.size());
+	return static_cast<std::size_t>(end - std::count(line.begin(), line.begin() + end, ' '));
+
+} // end of errorIndex
+
+/** errorColumn */
+std::size_t ParseCache::errorColumn(std::string_view line, std::size_t index) {
+
+	for (std::size_t i = 0; i < line.size(); ++i) {
+
+		if (line[i] == ' ') {
+			continue;
+		} // end if
+
+		if (index == 0) {
+			return i + 1;
+		} // end if
+
+		--index;
+
+	} // end for
+
+	// the error was found at the end of the line
+	return line.size() + 1;
+
+} // end of errorColumn
+
+/** find */
+const ParseCache::Entry* ParseCache::find(std::string_view key) {
+
+	auto found = index_.find(key);
+
+	if (found == index_.end()) {
+		++misses_;
+		return nullptr;
+	} // end if
+
+	++hits_;
+	items_.splice(items_.begin(), items_, found->second);
+
+	return &found->second->entry_;
+
+} // end of find
+
+/** insert */
+ParseCache::Entry& ParseCache::insert(std::string_view key) {
+
+	if (items_.size() < capacity_) {
+
+		items_.emplace_front();
+		Item& item = items_.front();
+		item.key_.assign(key.data(), key.size());
+		index_.emplace(item.key_, items_.begin());
+
+		return item.entry_;
+	} // end if
+
+	// reuse the least recently used line's item, key buffer and index node, so a full cache does not allocate
+	auto node = index_.extract(items_.back().key_);
+	items_.splice(items_.begin(), items_, std::prev(items_.end()));
+
+	Item& item = items_.front();
+	item.key_.assign(key.data(), key.size());
+	item.entry_.expression_ = AST();
+	node.key() = item.key_;
+	node.mapped() = items_.begin();
+	index_.insert(std::move(node));
+
+	return item.entry_;
+
+} // end of insert
+
+/** hits */
+std::uint64_t ParseCache::hits() const {
+
+	return hits_;
+
+} // end of hits
+
+/** misses */
+std::uint64_t ParseCache::misses() const {
+
+	return misses_;
+
+} // end of misses
+
+/** size */
+std::size_t ParseCache::size() const {
+
+	return items_.size();
+
+} // end of size
+
+/** capacity */
+std::size_t ParseCache::capacity() const {
+
+	return capacity_;
+
+} // end of capacity
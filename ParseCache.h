@@ -0,0 +1,141 @@
+/** @file ParseCache.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a bounded cache of parsed lines, so a
+   line seen before skips the lexer and the parser */
+
+#pragma once
+
+// included classes
+#include "Parser.h"
+#include "AST.h"
+
+// included libraries
+#include <list>
+#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+
+/** ParseCache Class
+ A line is looked up by its normalized text: its spaces dropped except
+ where they split two tokens, and its letters lowercased, which is exactly
+ what the lexer ignores, so every line with the same key parses to the same
+ tokens. An entry holds the parse of such a line, its expression tree
+ shared with every tree using the same nodes, or its syntax error. The
+ error is kept as the number of characters other than spaces before it, so
+ the column reported is the one of the line as it was typed. Once capacity
+ lines are held, the line used least recently is dropped and its entry is
+ reused for the new one. Lines holding a command or a "." are not cached.
+ The trees are made of the calling thread's nodes, so a cache is used and
+ destroyed on one thread.*/
+class ParseCache {
+
+public:
+
+   /** Entry Struct the parse of a line*/
+   struct Entry {
+
+      // kind of the line, an expression or a syntax error
+      Parser::Kind kind_ = Parser::Kind::blank;
+
+      // true if the line is an assignment, and the variable it assigns
+      bool assignment_ = false;
+      std::uint32_t variable_ = 0;
+
+      // expression of the line, without the assignment
+      AST expression_;
+
+      // tokens of the line separated by single spaces
+      std::string text_;
+
+      // characters other than spaces before a syntax error
+      std::size_t errorIndex_ = 0;
+
+   };
+
+   /** ParseCache constructor
+   @parm std::size_t [capacity] most lines held*/
+   explicit ParseCache(std::size_t capacity = defaultCapacity);
+
+   ParseCache(const ParseCache&) = delete;
+   ParseCache& operator=(const ParseCache&) = delete;
+
+   /** ParseCache public methods*/
+
+   /** normalize builds the key of a line
+   @parm std::string_view [line] text of the line without its newline, std::string [key] set to the line's key
+   @return false if the line is blank or must not be cached*/
+   static bool normalize(std::string_view line, std::string& key);
+
+   /** errorIndex
+   @parm std::string_view [line] text of the line, std::size_t [column] 1 based column in the line
+   @return the characters other than spaces before the column*/
+   static std::size_t errorIndex(std::string_view line, std::size_t column);
+
+   /** errorColumn
+   @parm std::string_view [line] text of the line, std::size_t [index] characters other than spaces before the error
+   @return the 1 based column of the error in the line*/
+   static std::size_t errorColumn(std::string_view line, std::size_t index);
+
+   /** find looks up a line and marks it as the most recently used
+   @parm std::string_view [key] key of the line
+   @return the line's entry, nullptr if it is not held*/
+   const Entry* find(std::string_view key);
+
+   /** insert adds a line, dropping the least recently used one if the cache is full
+   @pre the key is not held
+   @parm std::string_view [key] key of the line
+   @return the entry to fill in*/
+   Entry& insert(std::string_view key);
+
+   /** hits
+   @return the number of lookups that found their line*/
+   std::uint64_t hits() const;
+
+   /** misses
+   @return the number of lookups that did not*/
+   std::uint64_t misses() const;
+
+   /** size
+   @return the number of lines held*/
+   std::size_t size() const;
+
+   /** capacity
+   @return the most lines held*/
+   std::size_t capacity() const;
+
+   // lines held by default
+   static constexpr std::size_t defaultCapacity = 1024;
+
+private:
+
+   /** Item Struct a held line*/
+   struct Item {
+
+      // key of the line, the index points into it
+      std::string key_;
+
+      // parse of the line
+      Entry entry_;
+
+   };
+
+   /** ParseCache Attributes*/
+
+   // most lines held
+   std::size_t capacity_;
+
+   // lines held, the most recently used first
+   std::list<Item> items_;
+
+   // each held line by key
+   std::unordered_map<std::string_view, std::list<Item>::iterator> index_;
+
+   // lookups that found and did not find their line
+   std::uint64_t hits_ = 0;
+   std::uint64_t misses_ = 0;
+
+}; // end of ParseCache
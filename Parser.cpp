@@ -0,0 +1,342 @@
+/** @file Parser.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a parser that reads one line of tokens
+	from a Lexer, checks its syntax and builds its AST in a single pass */
+
+#include "Parser.h"
+#include "ParseCache.h"
+#include "Tracer.h"
+
+
+/** Parser Class public methods */
+
+/** Parser constructor */
+Parser::Parser(Lexer& lexer)
+	:lexer_(lexer), kind_(Kind::blank), atEnd_(false), assignment_(false), variable_(0), errorColumn_(0), cache_(nullptr) {
+} // end constructor
+
+/** parseLine */
+Parser::Kind Parser::parseLine() {
+
+	Tracer::Span span("Parser::parseLine");
+
+	std::string_view line;
+	if (cache_ == nullptr || !ParseCache::normalize(line = lexer_.peekLine(), key_)) {
+		return parseTokens();
+	} // end if
+
+	// a line seen before is not lexed again, its error is placed in the line as typed
+	if (const ParseCache::Entry* entry = cache_->find(key_)) {
+
+		kind_ = entry->kind_;
+		assignment_ = entry->assignment_;
+		variable_ = entry->variable_;
+		expression_ = entry->expression_;
+		text_ = entry->text_;
+		errorColumn_ = (kind_ == Kind::syntaxError) ? ParseCache::errorColumn(line, entry->errorIndex_) : 0;
+		atEnd_ = lexer_.skipLine();
+
+		return kind_;
+	} // end if
+
+	parseTokens();
+
+	ParseCache::Entry& entry = cache_->insert(key_);
+	entry.kind_ = kind_;
+	entry.assignment_ = assignment_;
+	entry.variable_ = variable_;
+	entry.expression_ = expression_;
+	entry.text_ = text_;
+	entry.errorIndex_ = (kind_ == Kind::syntaxError) ? ParseCache::errorIndex(line, errorColumn_) : 0;
+
+	return kind_;
+
+} // end of parseLine
+
+/** setCache */
+void Parser::setCache(ParseCache* cache) {
+
+	cache_ = cache;
+
+} // end of setCache
+
+/** kind */
+Parser::Kind Parser::kind() const {
+
+	return kind_;
+
+} // end of kind
+
+/** atEnd */
+bool Parser::atEnd() const {
+
+	return atEnd_;
+
+} // end of atEnd
+
+/** expression */
+const AST& Parser::expression() const {
+
+	return expression_;
+
+} // end of expression
+
+/** isAssignment */
+bool Parser::isAssignment() const {
+
+	return assignment_;
+
+} // end of isAssignment
+
+/** variable */
+std::uint32_t Parser::variable() const {
+
+	return variable_;
+
+} // end of variable
+
+/** command */
+const Token& Parser::command() const {
+
+	return command_;
+
+} // end of command
+
+/** argument */
+const std::string& Parser::argument() const {
+
+	return argument_;
+
+} // end of argument
+
+/** text */
+const std::string& Parser::text() const {
+
+	return text_;
+
+} // end of text
+
+/** errorColumn */
+std::size_t Parser::errorColumn() const {
+
+	return errorColumn_;
+
+} // end of errorColumn
+
+/** Parser Class private methods */
+
+/** parseTokens */
+Parser::Kind Parser::parseTokens() {
+
+	builder_.clear();
+	pending_.clear();
+	text_.clear();
+	expression_ = AST();
+	assignment_ = false;
+	errorColumn_ = 0;
+
+	Token tok;
+	next(tok);
+
+	// empty line
+	if (isLineEnd(tok)) {
+		atEnd_ = (tok.getType() == TokType::end);
+		kind_ = Kind::blank;
+		return kind_;
+	} // end if
+
+	// a command takes the rest of the line
+	if (tok.getType() == TokType::command) {
+
+		// the argument is copied, the lexer's view of it ends with the next token
+		command_ = tok;
+		argument_.assign(lexer_.argument());
+
+		if (!argument_.empty()) {
+			text_ += ' ';
+			text_ += argument_;
+		} // end if
+
+		while (!isLineEnd(tok)) {
+			next(tok);
+		} // end while
+
+		atEnd_ = (tok.getType() == TokType::end);
+		kind_ = Kind::command;
+		return kind_;
+	} // end if
+
+	bool expectOperand = true;
+
+	// operator that requires a number after it, or forbids the number 0
+	OpCode lastOp = OpCode::none;
+
+	// a leading "variable :=" is the assignment, otherwise the variable is the first operand
+	if (tok.getType() == TokType::variable) {
+
+		Token second;
+		next(second);
+
+		if (second.getType() == TokType::assign) {
+			assignment_ = true;
+			variable_ = tok.getSymbol();
+			next(tok);
+		}
+		else {
+			builder_.operand(tok);
+			expectOperand = false;
+			tok = second;
+		} // end if
+
+	} // end if
+
+	while (!isLineEnd(tok)) {
+
+		TokType type = tok.getType();
+
+		if (expectOperand) {
+
+			if (lastOp == OpCode::pow && type != TokType::number) {
+				// the exponent must be a number
+				return fail(tok, lexer_.column());
+			} // end if
+
+			if (lastOp == OpCode::div && type == TokType::number && !tok.isBigNumber() && tok.getNumber() == 0) {
+				// division by the number 0
+				return fail(tok, lexer_.column());
+			} // end if
+
+			if (type == TokType::number || type == TokType::variable) {
+				builder_.operand(tok);
+				expectOperand = false;
+			}
+			else if (type == TokType::lparen) {
+				pending_.push_back({ tok, lexer_.column() });
+			}
+			else {
+				return fail(tok, lexer_.column());
+			} // end if
+
+			lastOp = OpCode::none;
+
+		}
+		else if (type == TokType::addminusop || type == TokType::muldivop || type == TokType::powop) {
+
+			// operators of higher or equal precedence are complete
+			popOperators(precedence(tok));
+			pending_.push_back({ tok, lexer_.column() });
+
+			expectOperand = true;
+			lastOp = tok.getOp();
+
+		}
+		else if (type == TokType::rparen) {
+
+			popOperators(1);
+
+			// no matching "("
+			if (pending_.empty()) {
+				return fail(tok, lexer_.column());
+			} // end if
+
+			pending_.pop_back();
+
+		}
+		else {
+			return fail(tok, lexer_.column());
+		} // end if
+
+		next(tok);
+
+	} // end while
+
+	atEnd_ = (tok.getType() == TokType::end);
+
+	// the line ended after an operator, "(" or ":="
+	if (expectOperand) {
+		return fail(tok, lexer_.column());
+	} // end if
+
+	popOperators(1);
+
+	// unmatched "("
+	if (!pending_.empty()) {
+		return fail(tok, pending_.back().column_);
+	} // end if
+
+	builder_.finish(expression_);
+	kind_ = Kind::expression;
+
+	return kind_;
+
+} // end of parseTokens
+
+/** next */
+void Parser::next(Token& tok) {
+
+	lexer_ >> tok;
+
+	if (!isLineEnd(tok)) {
+		if (!text_.empty()) {
+			text_ += ' ';
+		} // end if
+		tok.appendTo(text_);
+	} // end if
+
+} // end of next
+
+/** isLineEnd */
+bool Parser::isLineEnd(const Token& tok) {
+
+	return tok.getType() == TokType::newline || tok.getType() == TokType::end;
+
+} // end of isLineEnd
+
+/** precedence */
+int Parser::precedence(const Token& tok) {
+	// highest precendent is 3, lowest 1
+	switch (tok.getType()) {
+	case TokType::powop:
+		return 3;
+	case TokType::muldivop:
+		return 2;
+	case TokType::addminusop:
+		return 1;
+	default:
+		return 0;
+	} // end switch
+
+} // end of precedence
+
+/** popOperators */
+void Parser::popOperators(int minPrecedence) {
+
+	while (!pending_.empty() && pending_.back().tok_.getType() != TokType::lparen &&
+		precedence(pending_.back().tok_) >= minPrecedence) {
+
+		builder_.apply(pending_.back().tok_);
+		pending_.pop_back();
+
+	} // end while
+
+} // end of popOperators
+
+/** fail */
+Parser::Kind Parser::fail(Token tok, std::size_t column) {
+
+	errorColumn_ = column;
+
+	// skip the rest of the line
+	while (!isLineEnd(tok)) {
+		next(tok);
+	} // end while
+
+	atEnd_ = (tok.getType() == TokType::end);
+	builder_.clear();
+	pending_.clear();
+	kind_ = Kind::syntaxError;
+
+	return kind_;
+
+} // end of fail
@@ -0,0 +1,174 @@
+/** @file Parser.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a parser that reads one line of tokens
+   from a Lexer, checks its syntax and builds its AST in a single pass */
+
+#pragma once
+
+// included classes
+#include "Token.h"
+#include "Lexer.h"
+#include "AST.h"
+
+class ParseCache;
+
+// included libraries
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+/** Parser Class
+ An operator precedence parser: operands are emitted to an AST::Builder as
+ they are read and operators wait on an explicit stack until an operator of
+ lower or equal precedence, a ")" or the end of the line pops them, so
+ nesting depth only grows the stack and no token vector is kept. Every
+ operator is left associative, a "^" must be followed by a number and a "/"
+ must not be followed by the number 0. With a ParseCache set, a line seen
+ before is taken from the cache without reading its tokens.*/
+class Parser {
+
+public:
+
+   /** Line Kind */
+   enum class Kind : std::uint8_t { blank, expression, command, syntaxError };
+
+   /** Parser constructor
+   @parm Lexer [lexer] lexer to read tokens from, must outlive the parser*/
+   explicit Parser(Lexer& lexer);
+
+   /** Parser public methods*/
+
+   /** parseLine reads and parses the tokens up to the next newline or end of input
+   @post kind() describes the line, the end of a line with a syntax error is skipped
+   @return the kind of the line*/
+   Kind parseLine();
+
+   /** setCache sets the cache lines are looked up in before they are parsed
+   @parm ParseCache* [cache] cache to use, nullptr for none*/
+   void setCache(ParseCache* cache);
+
+   /** kind
+   @return the kind of the last line parsed*/
+   Kind kind() const;
+
+   /** atEnd
+   @return true once the end of input or "." ended a line*/
+   bool atEnd() const;
+
+   /** expression
+   @return the expression of the last line, without the assignment*/
+   const AST& expression() const;
+
+   /** isAssignment
+   @return true if the last line started with "variable :="*/
+   bool isAssignment() const;
+
+   /** variable
+   @return the symbol id of the assigned variable*/
+   std::uint32_t variable() const;
+
+   /** command
+   @return the command token of a command line, holding the command name*/
+   const Token& command() const;
+
+   /** argument
+   @return the argument of a command line as entered, empty if it has none*/
+   const std::string& argument() const;
+
+   /** text
+   @return the tokens of the last line separated by single spaces*/
+   const std::string& text() const;
+
+   /** errorColumn
+   @return the 1 based column of the token where the syntax error was found*/
+   std::size_t errorColumn() const;
+
+private:
+
+   /** Pending Struct an operator or "(" waiting on the stack*/
+   struct Pending {
+
+      // operator or left parenthesis token
+      Token tok_;
+
+      // column of the token, to report an unmatched "("
+      std::size_t column_;
+
+   };
+
+   /** Parser Attributes*/
+
+   // lexer to read tokens from
+   Lexer& lexer_;
+
+   // operands and operators emitted in postfix order
+   AST::Builder builder_;
+
+   // operators and "(" not yet emitted
+   std::vector<Pending> pending_;
+
+   // kind of the last line
+   Kind kind_;
+
+   // true once the end of input was read
+   bool atEnd_;
+
+   // expression of the last line
+   AST expression_;
+
+   // true if the last line is an assignment
+   bool assignment_;
+
+   // symbol id of the assigned variable
+   std::uint32_t variable_;
+
+   // command token of a command line
+   Token command_;
+
+   // argument of a command line
+   std::string argument_;
+
+   // tokens of the last line separated by single spaces
+   std::string text_;
+
+   // column of the syntax error
+   std::size_t errorColumn_;
+
+   // cache of parsed lines, nullptr for none
+   ParseCache* cache_;
+
+   // key of the line being parsed
+   std::string key_;
+
+   /** Parser private methods*/
+
+   /** parseTokens reads and parses the tokens of a line
+   @return the kind of the line*/
+   Kind parseTokens();
+
+   /** next reads a token and adds it to the line's text
+   @parm Token [tok] token read*/
+   void next(Token& tok);
+
+   /** isLineEnd
+   @parm Token [tok] token to check
+   @return true for a newline or end token*/
+   static bool isLineEnd(const Token& tok);
+
+   /** precedence
+   @parm Token [tok] operator token
+   @return 1 for + and -, 2 for * and /, 3 for ^*/
+   static int precedence(const Token& tok);
+
+   /** popOperators emits the stacked operators down to the first "(" or one of lower precedence
+   @parm int [minPrecedence] lowest precedence to pop*/
+   void popOperators(int minPrecedence);
+
+   /** fail records a syntax error and skips the rest of the line
+   @parm Token [tok] last token read, std::size_t [column] column the error was found at
+   @return Kind::syntaxError*/
+   Kind fail(Token tok, std::size_t column);
+
+}; // end of Parser
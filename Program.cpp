@@ -0,0 +1,247 @@
+/** @file Program.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a compiled expression: a flat array
+	of register instructions lowered from an AST and the interpreter loop
+	that evaluates it with native integers, falling back to exact Integers
+	when a result overflows */
+
+#include "Program.h"
+#include "LineArena.h"
+
+#include <limits>
+
+
+/** Program Class public methods */
+
+/** emitConst */
+std::uint32_t Program::emitConst(const Integer& value) {
+
+	bigConstants_ = bigConstants_ || !value.isSmall();
+	constants_.push_back(value.isSmall() ? value.getSmall() : 0);
+	exactConstants_.push_back(value);
+	code_.push_back({ Kind::loadConst, static_cast<std::uint32_t>(constants_.size() - 1), 0 });
+
+	return static_cast<std::uint32_t>(code_.size() - 1);
+
+} // end of emitConst
+
+/** emitVar */
+std::uint32_t Program::emitVar(std::uint32_t symbol) {
+
+	usesVariables_ = true;
+	code_.push_back({ Kind::loadVar, symbol, 0 });
+
+	return static_cast<std::uint32_t>(code_.size() - 1);
+
+} // end of emitVar
+
+/** emitOp */
+std::uint32_t Program::emitOp(OpCode op, std::uint32_t left, std::uint32_t right) {
+
+	// operator kinds follow loadVar in the same order as OpCode
+	Kind kind = static_cast<Kind>(static_cast<int>(Kind::add) + static_cast<int>(op) - static_cast<int>(OpCode::add));
+	code_.push_back({ kind, left, right });
+
+	return static_cast<std::uint32_t>(code_.size() - 1);
+
+} // end of emitOp
+
+/** evaluate */
+Program::Status Program::evaluate(Integer& result, const std::int64_t* variables) const {
+
+	std::int64_t smallResult = 0;
+
+	// the common case never leaves int64, any overflow reruns exactly
+	if (runSmall(smallResult, variables)) {
+		result = Integer(smallResult);
+		return Status::ok;
+	} // end if
+
+	return runExact(result, variables);
+
+} // end of evaluate
+
+/** clear */
+void Program::clear() {
+
+	code_.clear();
+	constants_.clear();
+	exactConstants_.clear();
+	bigConstants_ = false;
+	usesVariables_ = false;
+
+} // end of clear
+
+/** runSmall */
+bool Program::runSmall(std::int64_t& result, const std::int64_t* variables) const {
+
+	if (code_.empty() || bigConstants_) {
+		result = 0;
+		return !bigConstants_;
+	} // end if
+
+	// one register per instruction, small programs stay on the native stack
+	std::int64_t localRegisters[64];
+	std::pmr::vector<std::int64_t> heapRegisters(LineArena::resource());
+	std::int64_t* registers = localRegisters;
+
+	if (code_.size() > 64) {
+		heapRegisters.resize(code_.size());
+		registers = heapRegisters.data();
+	} // end if
+
+	const Instruction* instr = code_.data();
+	const std::int64_t* constants = constants_.data();
+
+	for (std::size_t i = 0; i < code_.size(); ++i, ++instr) {
+
+		switch (instr->kind_)
+		{
+		case Kind::loadConst:
+			registers[i] = constants[instr->a_];
+			break;
+		case Kind::loadVar:
+			registers[i] = variables[instr->a_];
+			break;
+		case Kind::add:
+			if (__builtin_add_overflow(registers[instr->a_], registers[instr->b_], &registers[i])) {
+				return false;
+			} // end if
+			break;
+		case Kind::sub:
+			if (__builtin_sub_overflow(registers[instr->a_], registers[instr->b_], &registers[i])) {
+				return false;
+			} // end if
+			break;
+		case Kind::mul:
+			if (__builtin_mul_overflow(registers[instr->a_], registers[instr->b_], &registers[i])) {
+				return false;
+			} // end if
+			break;
+		case Kind::div:
+			// a zero divisor, and the one quotient that overflows, go to the exact path
+			if (registers[instr->b_] == 0 ||
+				(registers[instr->b_] == -1 && registers[instr->a_] == std::numeric_limits<std::int64_t>::min())) {
+				return false;
+			} // end if
+			registers[i] = registers[instr->a_] / registers[instr->b_];
+			break;
+		case Kind::pow: {
+			// ^ by squaring, the exponent is always a non negative constant
+			std::int64_t left = registers[instr->a_];
+			std::int64_t right = registers[instr->b_];
+			std::int64_t value = 1;
+			while (right > 0) {
+				if ((right & 1) && __builtin_mul_overflow(value, left, &value)) {
+					return false;
+				} // end if
+				right >>= 1;
+				if (right > 0 && __builtin_mul_overflow(left, left, &left)) {
+					return false;
+				} // end if
+			} // end while
+			registers[i] = value;
+			break;
+		}
+		} // end switch
+
+	} // end for
+
+	result = registers[code_.size() - 1];
+	return true;
+
+} // end of runSmall
+
+/** runExact */
+Program::Status Program::runExact(Integer& result, const std::int64_t* variables) const {
+
+	if (code_.empty()) {
+		result = Integer(0);
+		return Status::ok;
+	} // end if
+
+	std::pmr::vector<Integer> registers(code_.size(), LineArena::resource());
+
+	for (std::size_t i = 0; i < code_.size(); ++i) {
+
+		const Instruction& instr = code_[i];
+
+		switch (instr.kind_)
+		{
+		case Kind::loadConst:
+			registers[i] = exactConstants_[instr.a_];
+			break;
+		case Kind::loadVar:
+			registers[i] = Integer(variables[instr.a_]);
+			break;
+		case Kind::add:
+			registers[i] = Integer::add(registers[instr.a_], registers[instr.b_]);
+			break;
+		case Kind::sub:
+			registers[i] = Integer::sub(registers[instr.a_], registers[instr.b_]);
+			break;
+		case Kind::mul:
+			registers[i] = Integer::mul(registers[instr.a_], registers[instr.b_]);
+			break;
+		case Kind::div:
+			if (!Integer::div(registers[instr.a_], registers[instr.b_], registers[i])) {
+				return Status::divideByZero;
+			} // end if
+			break;
+		case Kind::pow:
+			if (!Integer::pow(registers[instr.a_], registers[instr.b_], registers[i], maxResultBits)) {
+				return Status::tooLarge;
+			} // end if
+			break;
+		} // end switch
+
+	} // end for
+
+	result = registers.back();
+	return Status::ok;
+
+} // end of runExact
+
+/** size */
+std::size_t Program::size() const {
+
+	return code_.size();
+
+} // end of size
+
+/** memoryBytes */
+std::size_t Program::memoryBytes() const {
+
+	return sizeof(Program) + code_.capacity() * sizeof(Instruction) + constants_.capacity() * sizeof(std::int64_t)
+		+ exactConstants_.capacity() * sizeof(Integer);
+
+} // end of memoryBytes
+
+/** usesVariables */
+bool Program::usesVariables() const {
+
+	return usesVariables_;
+
+} // end of usesVariables
+
+/** getCode */
+const std::vector<Program::Instruction>& Program::getCode() const {
+
+	return code_;
+
+} // end of getCode
+
+/** getConstants */
+const std::vector<std::int64_t>& Program::getConstants() const {
+
+	return constants_;
+
+} // end of getConstants
+
+/** hasBigConstants */
+bool Program::hasBigConstants() const {
+
+	return bigConstants_;
+
+} // end of hasBigConstants
@@ -0,0 +1,134 @@
+/** @file Program.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a compiled expression: a flat array
+   of register instructions lowered from an AST and the interpreter loop
+   that evaluates it with native integers, falling back to exact Integers
+   when a result overflows */
+
+#pragma once
+
+// included classes
+#include "Token.h"
+#include "Integer.h"
+
+// included libraries
+#include <vector>
+#include <cstdint>
+
+
+/** Program Class
+ Every instruction writes the register with its own index, so operands
+ always refer to earlier instructions and the last instruction holds the
+ result of the expression.*/
+class Program {
+
+public:
+
+   /** Instruction kinds, the operators match OpCode*/
+   enum class Kind : std::uint8_t { loadConst, loadVar, add, sub, mul, div, pow };
+
+   /** Status of an evaluation*/
+   enum class Status : std::uint8_t { ok, divideByZero, tooLarge };
+
+   // largest result in bits ^ will compute
+   static constexpr std::uint64_t maxResultBits = std::uint64_t(1) << 24;
+
+   /** Instruction Struct */
+   struct Instruction {
+
+      // what the instruction does
+      Kind kind_;
+
+      // constant index, symbol id or left operand register
+      std::uint32_t a_;
+
+      // right operand register
+      std::uint32_t b_;
+
+   };
+
+   /** Program constructor*/
+   Program() = default;
+
+   /** Program public methods*/
+
+   /** emitConst appends an instruction loading a constant
+   @parm Integer [value] constant to load
+   @return the register holding the constant*/
+   std::uint32_t emitConst(const Integer& value);
+
+   /** emitVar appends an instruction loading a variable's value
+   @parm std::uint32_t [symbol] symbol id of the variable
+   @return the register holding the variable*/
+   std::uint32_t emitVar(std::uint32_t symbol);
+
+   /** emitOp appends an operator instruction
+   @parm OpCode [op] operation, std::uint32_t [left] left operand register, std::uint32_t [right] right operand register
+   @return the register holding the result*/
+   std::uint32_t emitOp(OpCode op, std::uint32_t left, std::uint32_t right);
+
+   /** evaluate runs the program on int64 registers, and again on exact
+   Integers only if a result overflows
+   @parm Integer [result] value of the expression, 0 for an empty program,
+   std::int64_t* [variables] values indexed by symbol id, only read by loadVar instructions
+   @return ok, or why there is no result*/
+   Status evaluate(Integer& result, const std::int64_t* variables = nullptr) const;
+
+   /** runSmall the int64 interpreter loop
+   @parm std::int64_t [result] value of the expression, std::int64_t* [variables] values indexed by symbol id
+   @return false if a result overflowed, a divisor was zero or a constant is too large*/
+   bool runSmall(std::int64_t& result, const std::int64_t* variables = nullptr) const;
+
+   /** runExact the Integer interpreter loop
+   @parm Integer [result] value of the expression, std::int64_t* [variables] values indexed by symbol id
+   @return ok, or why there is no result*/
+   Status runExact(Integer& result, const std::int64_t* variables = nullptr) const;
+
+   /** clear removes every instruction and constant, keeping the memory for the next program*/
+   void clear();
+
+   /** size
+   @return the number of instructions*/
+   std::size_t size() const;
+
+   /** memoryBytes
+   @return the bytes the program and its arrays hold, a big constant's limbs are shared and not counted*/
+   std::size_t memoryBytes() const;
+
+   /** usesVariables
+   @return true if the program has a loadVar instruction*/
+   bool usesVariables() const;
+
+   /** getCode
+   @return the instruction array*/
+   const std::vector<Instruction>& getCode() const;
+
+   /** getConstants
+   @return the int64 constant pool indexed by loadConst instructions*/
+   const std::vector<std::int64_t>& getConstants() const;
+
+   /** hasBigConstants
+   @return true if a constant does not fit an int64, getConstants then holds 0 for it*/
+   bool hasBigConstants() const;
+
+private:
+
+   /** Program Attributes*/
+
+   // flat instruction array in evaluation order
+   std::vector<Instruction> code_;
+
+   // constant pool as int64
+   std::vector<std::int64_t> constants_;
+
+   // constant pool as exact Integers
+   std::vector<Integer> exactConstants_;
+
+   // true once a constant too large for int64 is emitted
+   bool bigConstants_ = false;
+
+   // true once a loadVar instruction is emitted
+   bool usesVariables_ = false;
+
+}; // end of Program
@@ -0,0 +1,362 @@
+/** @file ResultSink.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements the buffered sinks the calculator writes
+	the results of a script to, as text, JSON lines or binary records */
+
+#include "ResultSink.h"
+
+
+namespace {
+
+	/** appendNumber appends a number in decimal
+	@parm std::string [text] string to append to, std::uint64_t [number] number to append*/
+	void appendNumber(std::string& text, std::uint64_t number) {
+
+		char digits[20];
+		int count = 0;
+
+		do {
+			digits[count++] = static_cast<char>('0' + number % 10);
+			number /= 10;
+		} while (number != 0); // end do
+
+		while (count > 0) {
+			text += digits[--count];
+		} // end while
+
+	} // end of appendNumber
+
+	/** appendJsonString appends text as a quoted JSON string
+	@parm std::string [text] string to append to, std::string_view [value] text to quote*/
+	void appendJsonString(std::string& text, std::string_view value) {
+
+		const char* const hexDigits = "0123456789abcdef";
+
+		text += '"';
+
+		for (char c : value) {
+
+			unsigned char byte = static_cast<unsigned char>(c);
+
+			if (c == '"' || c == '\\') {
+				text += '\\';
+				text += c;
+			}
+			else if (c == '\n') {
+				text += "\\n";
+			}
+			else if (byte < 0x20) {
+				text += "\\u00";
+				text += hexDigits[byte >> 4];
+				text += hexDigits[byte & 0xf];
+			}
+			else {
+				text += c;
+			} // end if
+
+		} // end for
+
+		text += '"';
+
+	} // end of appendJsonString
+
+	/** appendUint32 appends a number as four little endian bytes
+	@parm std::string [text] string to append to, std::uint32_t [number] number to append*/
+	void appendUint32(std::string& text, std::uint32_t number) {
+
+		for (int shift = 0; shift < 32; shift += 8) {
+			text += static_cast<char>((number >> shift) & 0xff);
+		} // end for
+
+	} // end of appendUint32
+
+	/** appendBinaryRecord appends a record of the binary format
+	@parm std::string [text] string to append to, std::uint8_t [type] record type, std::uint32_t [number] expression
+	number or column, std::string_view [input] text of the line, std::string_view [result] result or report*/
+	void appendBinaryRecord(std::string& text, std::uint8_t type, std::uint32_t number, std::string_view input, std::string_view result) {
+
+		text += static_cast<char>(type);
+		appendUint32(text, number);
+		appendUint32(text, static_cast<std::uint32_t>(input.size()));
+		appendUint32(text, static_cast<std::uint32_t>(result.size()));
+		text.append(input.data(), input.size());
+		text.append(result.data(), result.size());
+
+	} // end of appendBinaryRecord
+
+} // end namespace
+
+
+/** ResultSink Class public methods */
+
+/** ResultSink constructor */
+ResultSink::ResultSink(std::ostream& out, std::size_t bufferSize)
+	:out_(out), bufferSize_(bufferSize), open_(Record::none), index_(0), start_(0), appender_(*this), stream_(&appender_) {
+
+	// a record may end past bufferSize_, so leave room for one
+	buffer_.reserve(bufferSize_ + 1024);
+
+} // end constructor
+
+/** ResultSink destructor */
+ResultSink::~ResultSink() {
+
+	flush();
+
+} // end destructor
+
+/** beginResult */
+std::ostream& ResultSink::beginResult(int index, std::string_view input) {
+
+	open_ = Record::result;
+	index_ = index;
+	input_ = input;
+	start_ = buffer_.size();
+
+	return stream_;
+
+} // end of beginResult
+
+/** endResult */
+void ResultSink::endResult(Kind kind) {
+
+	takeOpen();
+	appendResult(buffer_, index_, input_, kind, result_);
+	drain();
+
+} // end of endResult
+
+/** beginCommand */
+std::ostream& ResultSink::beginCommand(std::string_view input) {
+
+	open_ = Record::command;
+	input_ = input;
+	start_ = buffer_.size();
+
+	return stream_;
+
+} // end of beginCommand
+
+/** endCommand */
+void ResultSink::endCommand() {
+
+	takeOpen();
+	appendCommand(buffer_, input_, result_);
+	drain();
+
+} // end of endCommand
+
+/** syntaxError */
+void ResultSink::syntaxError(std::size_t column) {
+
+	appendSyntaxError(buffer_, column);
+	drain();
+
+} // end of syntaxError
+
+/** write */
+void ResultSink::write(std::string_view text) {
+
+	buffer_.append(text.data(), text.size());
+	drain();
+
+} // end of write
+
+/** flush */
+void ResultSink::flush() {
+
+	// the open record's result is still to be formatted, keep it
+	std::size_t held = (open_ == Record::none) ? buffer_.size() : start_;
+
+	out_.write(buffer_.data(), static_cast<std::streamsize>(held));
+	buffer_.erase(0, held);
+	start_ = 0;
+	out_.flush();
+
+} // end of flush
+
+/** make */
+std::unique_ptr<ResultSink> ResultSink::make(std::string_view format, std::ostream& out) {
+
+	if (format == "text") {
+		return std::make_unique<TextSink>(out);
+	} // end if
+
+	if (format == "json") {
+		return std::make_unique<JsonLinesSink>(out);
+	} // end if
+
+	if (format == "binary") {
+		return std::make_unique<BinarySink>(out);
+	} // end if
+
+	return nullptr;
+
+} // end of make
+
+/** ResultSink Class private methods */
+
+/** drain */
+void ResultSink::drain() {
+
+	if (buffer_.size() >= bufferSize_) {
+		out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+		buffer_.clear();
+	} // end if
+
+} // end of drain
+
+/** takeOpen */
+void ResultSink::takeOpen() {
+
+	result_.assign(buffer_, start_, std::string::npos);
+	buffer_.resize(start_);
+	open_ = Record::none;
+
+} // end of takeOpen
+
+
+/** Appender Class  */
+
+/** Appender constructor */
+ResultSink::Appender::Appender(ResultSink& sink)
+	:sink_(sink) {
+} // end constructor
+
+/** overflow */
+ResultSink::Appender::int_type ResultSink::Appender::overflow(int_type c) {
+
+	if (!traits_type::eq_int_type(c, traits_type::eof())) {
+		sink_.buffer_ += traits_type::to_char_type(c);
+	} // end if
+
+	return traits_type::not_eof(c);
+
+} // end of overflow
+
+/** xsputn */
+std::streamsize ResultSink::Appender::xsputn(const char* text, std::streamsize count) {
+
+	sink_.buffer_.append(text, static_cast<std::size_t>(count));
+	return count;
+
+} // end of xsputn
+
+/** sync */
+int ResultSink::Appender::sync() {
+
+	// a report ending its lines with std::endl does not flush every line
+	if (sink_.open_ == Record::none) {
+		sink_.flush();
+	} // end if
+
+	return 0;
+
+} // end of sync
+
+
+/** TextSink Class  */
+
+/** appendResult */
+void TextSink::appendResult(std::string& text, int index, std::string_view input, Kind, std::string_view result) const {
+
+	text += "in  [";
+	appendNumber(text, static_cast<std::uint64_t>(index));
+	text += "]: ";
+	text.append(input.data(), input.size());
+	text += "\nout [";
+	appendNumber(text, static_cast<std::uint64_t>(index));
+	text += "]: ";
+	text.append(result.data(), result.size());
+	text += '\n';
+
+} // end of appendResult
+
+/** appendCommand */
+void TextSink::appendCommand(std::string& text, std::string_view, std::string_view output) const {
+
+	text.append(output.data(), output.size());
+
+} // end of appendCommand
+
+/** appendSyntaxError */
+void TextSink::appendSyntaxError(std::string& text, std::size_t column) const {
+
+	text += "Syntax Error At Column ";
+	appendNumber(text, column);
+	text += ", Expression Skipped\n";
+
+} // end of appendSyntaxError
+
+
+/** JsonLinesSink Class  */
+
+/** appendResult */
+void JsonLinesSink::appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const {
+
+	text += "{\"index\":";
+	appendNumber(text, static_cast<std::uint64_t>(index));
+	text += ",\"input\":";
+	appendJsonString(text, input);
+
+	switch (kind) {
+	case Kind::value:
+		text += ",\"type\":\"value\",\"value\":";
+		break;
+	case Kind::expression:
+		text += ",\"type\":\"expression\",\"infix\":";
+		break;
+	default:
+		text += ",\"type\":\"error\",\"error\":";
+		break;
+	} // end switch
+
+	appendJsonString(text, result);
+	text += "}\n";
+
+} // end of appendResult
+
+/** appendCommand */
+void JsonLinesSink::appendCommand(std::string& text, std::string_view input, std::string_view output) const {
+
+	text += "{\"type\":\"command\",\"input\":";
+	appendJsonString(text, input);
+	text += ",\"output\":";
+	appendJsonString(text, output);
+	text += "}\n";
+
+} // end of appendCommand
+
+/** appendSyntaxError */
+void JsonLinesSink::appendSyntaxError(std::string& text, std::size_t column) const {
+
+	text += "{\"type\":\"syntax_error\",\"column\":";
+	appendNumber(text, column);
+	text += "}\n";
+
+} // end of appendSyntaxError
+
+
+/** BinarySink Class  */
+
+/** appendResult */
+void BinarySink::appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const {
+
+	appendBinaryRecord(text, static_cast<std::uint8_t>(kind), static_cast<std::uint32_t>(index), input, result);
+
+} // end of appendResult
+
+/** appendCommand */
+void BinarySink::appendCommand(std::string& text, std::string_view input, std::string_view output) const {
+
+	appendBinaryRecord(text, commandRecord, 0, input, output);
+
+} // end of appendCommand
+
+/** appendSyntaxError */
+void BinarySink::appendSyntaxError(std::string& text, std::size_t column) const {
+
+	appendBinaryRecord(text, syntaxErrorRecord, static_cast<std::uint32_t>(column), std::string_view(), std::string_view());
+
+} // end of appendSyntaxError
@@ -0,0 +1,212 @@
+/** @file ResultSink.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements the buffered sinks the calculator writes
+   the results of a script to, as text, JSON lines or binary records */
+
+#pragma once
+
+// included libraries
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+/** ResultSink Class
+ A sink formats each record of a script's output, an expression and its
+ result, a command's report or a syntax error, into its own buffer and
+ writes the buffer to the stream only once it holds bufferSize bytes, when
+ flush is called, or when the sink is destroyed. The result of an
+ expression is written through beginResult's stream straight into the
+ buffer, so a record costs no allocation once the buffer has grown. The
+ append methods only read the sink, so threads can format records into
+ their own strings and write them in order.*/
+class ResultSink {
+
+public:
+
+   /** Kind of result an expression line printed*/
+   enum class Kind : std::uint8_t { value, expression, error };
+
+   /** ResultSink constructor
+   @parm std::ostream [out] stream to write to, std::size_t [bufferSize] bytes held before they are written*/
+   explicit ResultSink(std::ostream& out, std::size_t bufferSize = defaultBufferSize);
+
+   /** ResultSink destructor writes what is still held and flushes the stream*/
+   virtual ~ResultSink();
+
+   ResultSink(const ResultSink&) = delete;
+   ResultSink& operator=(const ResultSink&) = delete;
+
+   /** ResultSink public methods*/
+
+   /** beginResult starts the record of an expression line
+   @parm int [index] number of the expression, std::string_view [input] text of the line, must live until endResult
+   @return stream to write the result to*/
+   std::ostream& beginResult(int index, std::string_view input);
+
+   /** endResult ends the record beginResult started
+   @parm Kind [kind] kind of the result written*/
+   void endResult(Kind kind);
+
+   /** beginCommand starts the record of a command line
+   @parm std::string_view [input] text of the line, must live until endCommand
+   @return stream to write the command's report to*/
+   std::ostream& beginCommand(std::string_view input);
+
+   /** endCommand ends the record beginCommand started*/
+   void endCommand();
+
+   /** syntaxError writes the record of a line that could not be parsed
+   @parm std::size_t [column] column of the error*/
+   void syntaxError(std::size_t column);
+
+   /** write writes records already formatted by the append methods
+   @parm std::string_view [text] formatted records*/
+   void write(std::string_view text);
+
+   /** flush writes what is held and flushes the stream, a record still open is kept*/
+   void flush();
+
+   /** appendResult formats the record of an expression line
+   @parm std::string [text] string to append to, int [index] number of the expression,
+   std::string_view [input] text of the line, Kind [kind] kind of result, std::string_view [result] result written*/
+   virtual void appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const = 0;
+
+   /** appendCommand formats the record of a command line
+   @parm std::string [text] string to append to, std::string_view [input] text of the line, std::string_view [output] report written*/
+   virtual void appendCommand(std::string& text, std::string_view input, std::string_view output) const = 0;
+
+   /** appendSyntaxError formats the record of a line that could not be parsed
+   @parm std::string [text] string to append to, std::size_t [column] column of the error*/
+   virtual void appendSyntaxError(std::string& text, std::size_t column) const = 0;
+
+   /** make creates the sink for a format name
+   @parm std::string_view [format] "text", "json" or "binary", std::ostream [out] stream to write to
+   @return the sink, nullptr for an unknown format*/
+   static std::unique_ptr<ResultSink> make(std::string_view format, std::ostream& out);
+
+   // bytes held before they are written
+   static constexpr std::size_t defaultBufferSize = 64 * 1024;
+
+private:
+
+   /** Appender Class a stream buffer appending to the sink's buffer*/
+   class Appender : public std::streambuf {
+
+   public:
+
+      /** Appender constructor
+      @parm ResultSink [sink] sink to append to*/
+      explicit Appender(ResultSink& sink);
+
+   protected:
+
+      /** streambuf overrides, sync flushes the sink unless a record is open*/
+      int_type overflow(int_type c) override;
+      std::streamsize xsputn(const char* text, std::streamsize count) override;
+      int sync() override;
+
+   private:
+
+      // sink appended to
+      ResultSink& sink_;
+
+   }; // end of Appender
+
+   /** Record of the line being written*/
+   enum class Record : std::uint8_t { none, result, command };
+
+   /** ResultSink Attributes*/
+
+   // stream written to
+   std::ostream& out_;
+
+   // bytes held before they are written
+   std::size_t bufferSize_;
+
+   // formatted records not yet written
+   std::string buffer_;
+
+   // result of the open record, moved out of buffer_ to be formatted
+   std::string result_;
+
+   // record begun and not yet ended
+   Record open_;
+
+   // number and text of the open record
+   int index_;
+   std::string_view input_;
+
+   // where the open record's result starts in buffer_
+   std::size_t start_;
+
+   // stream buffer and stream appending to buffer_
+   Appender appender_;
+   std::ostream stream_;
+
+   /** ResultSink private methods*/
+
+   /** drain writes what is held once it reaches bufferSize_*/
+   void drain();
+
+   /** takeOpen moves the open record's result from buffer_ into result_*/
+   void takeOpen();
+
+}; // end of ResultSink
+
+
+/** TextSink Class the calculator's text, "in  [n]: " and "out [n]: " lines*/
+class TextSink : public ResultSink {
+
+public:
+
+   using ResultSink::ResultSink;
+
+   void appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const override;
+   void appendCommand(std::string& text, std::string_view input, std::string_view output) const override;
+   void appendSyntaxError(std::string& text, std::size_t column) const override;
+
+}; // end of TextSink
+
+
+/** JsonLinesSink Class one JSON object per line, an expression as
+ {"index":n,"input":"...","type":"value","value":"..."} with "expression" and
+ "infix" or "error" and "error" for the other kinds, a command as
+ {"type":"command","input":"...","output":"..."} and a syntax error as
+ {"type":"syntax_error","column":n}*/
+class JsonLinesSink : public ResultSink {
+
+public:
+
+   using ResultSink::ResultSink;
+
+   void appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const override;
+   void appendCommand(std::string& text, std::string_view input, std::string_view output) const override;
+   void appendSyntaxError(std::string& text, std::size_t column) const override;
+
+}; // end of JsonLinesSink
+
+
+/** BinarySink Class one record per line, a type byte (0 value, 1 expression,
+ 2 error, 3 command, 4 syntax error), then the expression number or error
+ column, the input length and the result length as little endian uint32,
+ then the input and result bytes*/
+class BinarySink : public ResultSink {
+
+public:
+
+   using ResultSink::ResultSink;
+
+   void appendResult(std::string& text, int index, std::string_view input, Kind kind, std::string_view result) const override;
+   void appendCommand(std::string& text, std::string_view input, std::string_view output) const override;
+   void appendSyntaxError(std::string& text, std::size_t column) const override;
+
+   // record types after the result kinds
+   static constexpr std::uint8_t commandRecord = 3;
+   static constexpr std::uint8_t syntaxErrorRecord = 4;
+
+}; // end of BinarySink
@@ -0,0 +1,329 @@
+/** @file SessionRunner.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a runner for many independent calculator
+	sessions, each with its own Calculator, spread over a WorkStealingPool */
+
+#include "SessionRunner.h"
+#include "Tracer.h"
+
+#include <fstream>
+#include <sstream>
+#include <chrono>
+
+
+namespace {
+
+	/** readFile reads a whole file
+	@parm std::string [path] file to read, std::string [contents] contents read
+	@return true if the file was read*/
+	bool readFile(const std::string& path, std::string& contents) {
+
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			return false;
+		} // end if
+
+		std::ostringstream buffer;
+		buffer << file.rdbuf();
+		contents = buffer.str();
+
+		return !file.bad();
+
+	} // end of readFile
+
+	/** isOnlyDot
+	@parm std::string_view [line] line without its newline
+	@return true if the line holds "." and whitespace only*/
+	bool isOnlyDot(std::string_view line) {
+
+		bool dot = false;
+
+		for (char c : line) {
+			if (c == '.' && !dot) {
+				dot = true;
+			}
+			else if (c != ' ' && c != '\t' && c != '\r') {
+				return false;
+			} // end if
+		} // end for
+
+		return dot;
+
+	} // end of isOnlyDot
+
+	/** isBlank
+	@parm std::string_view [text] text to check
+	@return true if the text holds whitespace only*/
+	bool isBlank(std::string_view text) {
+
+		return text.find_first_not_of(" \t\r\n") == std::string_view::npos;
+
+	} // end of isBlank
+
+	/** rate
+	@parm double [count] amount done, double [seconds] time taken
+	@return count per second, 0 if no time was measured*/
+	double rate(double count, double seconds) {
+
+		return seconds > 0.0 ? count / seconds : 0.0;
+
+	} // end of rate
+
+} // end namespace
+
+
+/** SessionRunner Class public methods */
+
+/** SessionRunner constructor */
+SessionRunner::SessionRunner()
+	:nextToMerge_(0), wallSeconds_(0.0), threadCount_(0), steals_(0) {
+} // end constructor
+
+/** addManifest */
+bool SessionRunner::addManifest(const std::string& manifestPath, std::string& error) {
+
+	std::ifstream manifest(manifestPath);
+	if (!manifest) {
+		error = "Could not read " + manifestPath;
+		return false;
+	} // end if
+
+	std::string path;
+
+	while (std::getline(manifest, path)) {
+
+		// ignore blank lines and a trailing carriage return
+		while (!path.empty() && (path.back() == '\r' || path.back() == ' ' || path.back() == '\t')) {
+			path.pop_back();
+		} // end while
+
+		if (path.empty()) {
+			continue;
+		} // end if
+
+		Session session;
+		session.name_ = path;
+		session.path_ = path;
+		sessions_.push_back(std::move(session));
+
+	} // end while
+
+	return true;
+
+} // end of addManifest
+
+/** addSessionFile */
+bool SessionRunner::addSessionFile(const std::string& path, std::string& error) {
+
+	sessionFiles_.push_back(std::make_unique<std::string>());
+	if (!readFile(path, *sessionFiles_.back())) {
+		sessionFiles_.pop_back();
+		error = "Could not read " + path;
+		return false;
+	} // end if
+
+	std::string_view text = *sessionFiles_.back();
+	std::size_t sessionStart = 0;
+	std::size_t lineStart = 0;
+	std::size_t lineNumber = 1;
+	std::size_t sessionLine = 1;
+
+	while (lineStart < text.size()) {
+
+		std::size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos) {
+			lineEnd = text.size();
+		} // end if
+
+		std::size_t next = (lineEnd < text.size()) ? lineEnd + 1 : lineEnd;
+
+		if (isOnlyDot(text.substr(lineStart, lineEnd - lineStart))) {
+
+			// the session ends before its "." line
+			std::string_view script = text.substr(sessionStart, lineStart - sessionStart);
+			if (!isBlank(script)) {
+				Session session;
+				session.name_ = path + ":" + std::to_string(sessionLine);
+				session.script_ = script;
+				sessions_.push_back(std::move(session));
+			} // end if
+
+			sessionStart = next;
+			sessionLine = lineNumber + 1;
+
+		} // end if
+
+		lineStart = next;
+		++lineNumber;
+
+	} // end while
+
+	// the last session may end with the file instead of a "."
+	std::string_view script = text.substr(sessionStart);
+	if (!isBlank(script)) {
+		Session session;
+		session.name_ = path + ":" + std::to_string(sessionLine);
+		session.script_ = script;
+		sessions_.push_back(std::move(session));
+	} // end if
+
+	return true;
+
+} // end of addSessionFile
+
+/** size */
+std::size_t SessionRunner::size() const {
+
+	return sessions_.size();
+
+} // end of size
+
+/** run */
+std::size_t SessionRunner::run(WorkStealingPool& pool, std::ostream& merged, const std::string& outputDir) {
+
+	threadCount_ = pool.size();
+	nextToMerge_ = 0;
+	std::uint64_t stealsBefore = pool.steals();
+
+	auto start = std::chrono::steady_clock::now();
+
+	pool.run(sessions_.size(), [&](std::size_t index, std::size_t) {
+
+		if (outputDir.empty()) {
+			runSession(sessions_[index], std::string());
+			mergeCompleted(index, merged);
+		}
+		else {
+			runSession(sessions_[index], outputDir + "/" + std::to_string(index) + ".out");
+		} // end if
+
+	});
+
+	merged.flush();
+
+	wallSeconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	steals_ = pool.steals() - stealsBefore;
+
+	std::size_t failures = 0;
+	for (const Session& session : sessions_) {
+		failures += session.failed_ ? 1 : 0;
+	} // end for
+
+	return failures;
+
+} // end of run
+
+/** reportSessions */
+void SessionRunner::reportSessions(std::ostream& out) const {
+
+	for (std::size_t i = 0; i < sessions_.size(); ++i) {
+
+		const Session& session = sessions_[i];
+
+		out << "session [" << i << "]: " << session.name_;
+		if (session.failed_) {
+			out << ", could not be opened\n";
+			continue;
+		} // end if
+
+		out << ", " << session.lines_ << " lines, " << session.bytes_ << " bytes, " << session.seconds_ << " s, "
+			<< rate(static_cast<double>(session.lines_), session.seconds_) << " lines/s\n";
+
+	} // end for
+
+} // end of reportSessions
+
+/** reportTotals */
+void SessionRunner::reportTotals(std::ostream& out) const {
+
+	std::uint64_t lines = 0;
+	std::uint64_t bytes = 0;
+	double sessionSeconds = 0.0;
+
+	for (const Session& session : sessions_) {
+		lines += session.lines_;
+		bytes += session.bytes_;
+		sessionSeconds += session.seconds_;
+	} // end for
+
+	// the sessions' own times add up to what one thread would have taken
+	out << "sessions: " << sessions_.size() << " on " << threadCount_ << " threads, " << lines << " lines, "
+		<< bytes << " bytes in " << wallSeconds_ << " s, " << rate(static_cast<double>(lines), wallSeconds_) << " lines/s, "
+		<< rate(static_cast<double>(bytes), wallSeconds_) / 1e6 << " MB/s, speedup " << rate(sessionSeconds, wallSeconds_)
+		<< ", " << steals_ << " steals" << std::endl;
+
+} // end of reportTotals
+
+/** SessionRunner Class private methods */
+
+/** runSession */
+void SessionRunner::runSession(Session& session, const std::string& outputPath) {
+
+	Tracer::Span span("SessionRunner::runSession");
+
+	std::string scriptText;
+	std::string_view script = session.script_;
+
+	if (!session.path_.empty()) {
+
+		if (!readFile(session.path_, scriptText)) {
+			session.failed_ = true;
+			return;
+		} // end if
+
+		script = scriptText;
+
+	} // end if
+
+	session.bytes_ = script.size();
+
+	// a fresh calculator, so no variable leaks between sessions
+	Calculator calc;
+
+	if (outputPath.empty()) {
+
+		std::ostringstream out;
+
+		auto start = std::chrono::steady_clock::now();
+		session.lines_ = calc.echo(script, out);
+		session.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		session.output_ = out.str();
+
+	}
+	else {
+
+		std::ofstream out(outputPath, std::ios::binary);
+		if (!out) {
+			session.failed_ = true;
+			return;
+		} // end if
+
+		auto start = std::chrono::steady_clock::now();
+		session.lines_ = calc.echo(script, out);
+		session.seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	} // end if
+
+} // end of runSession
+
+/** mergeCompleted */
+void SessionRunner::mergeCompleted(std::size_t index, std::ostream& merged) {
+
+	std::lock_guard<std::mutex> lock(mergeMutex_);
+
+	sessions_[index].done_ = true;
+
+	while (nextToMerge_ < sessions_.size() && sessions_[nextToMerge_].done_) {
+
+		std::string& output = sessions_[nextToMerge_].output_;
+		merged.write(output.data(), static_cast<std::streamsize>(output.size()));
+
+		// written, so the buffer is no longer needed
+		std::string().swap(output);
+		++nextToMerge_;
+
+	} // end while
+
+} // end of mergeCompleted
@@ -0,0 +1,136 @@
+/** @file SessionRunner.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a runner for many independent calculator
+   sessions, each with its own Calculator, spread over a WorkStealingPool */
+
+#pragma once
+
+// included classes
+#include "Calculator.h"
+#include "WorkStealingPool.h"
+
+// included libraries
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <iostream>
+#include <cstdint>
+
+
+/** SessionRunner Class
+ A session is a script run by echo with a fresh Calculator, so sessions
+ share nothing and any worker can run any of them. A session's output is
+ buffered and either written to its own file or merged into one stream in
+ the order the sessions were added, as soon as every earlier session is
+ done, so the merged output is the same for any number of threads.*/
+class SessionRunner {
+
+public:
+
+   /** SessionRunner constructor*/
+   SessionRunner();
+
+   /** SessionRunner public methods*/
+
+   /** addManifest adds a session for every script path listed in a file, one per line
+   @parm std::string [manifestPath] file listing the scripts, std::string [error] error message
+   @return true if the manifest was read, the scripts are read when their session runs*/
+   bool addManifest(const std::string& manifestPath, std::string& error);
+
+   /** addSessionFile adds the sessions held in one file, each ending at a line holding only "."
+   @parm std::string [path] file holding the sessions, std::string [error] error message
+   @return true if the file was read*/
+   bool addSessionFile(const std::string& path, std::string& error);
+
+   /** size
+   @return the number of sessions added*/
+   std::size_t size() const;
+
+   /** run runs every session on the pool
+   @post each session's output is written to outputDir/<index>.out, or to merged in order if outputDir is empty
+   @parm WorkStealingPool [pool] workers to run on, std::ostream [merged] stream for the merged output,
+   std::string [outputDir] directory for one output file per session
+   @return the number of sessions whose script or output file could not be opened*/
+   std::size_t run(WorkStealingPool& pool, std::ostream& merged, const std::string& outputDir);
+
+   /** reportSessions writes the lines, bytes, time and throughput of every session
+   @parm std::ostream [out] stream to write the report to*/
+   void reportSessions(std::ostream& out) const;
+
+   /** reportTotals writes the aggregate throughput and the speedup over running the sessions one after another
+   @parm std::ostream [out] stream to write the report to*/
+   void reportTotals(std::ostream& out) const;
+
+private:
+
+   /** Session Struct a script and what running it produced*/
+   struct Session {
+
+      // script path, or file and first line of a session in a session file
+      std::string name_;
+
+      // script file read when the session runs, empty for a session held in memory
+      std::string path_;
+
+      // text of a session held in memory
+      std::string_view script_;
+
+      // buffered output waiting to be merged
+      std::string output_;
+
+      // lines that were not blank
+      std::uint64_t lines_ = 0;
+
+      // bytes of script
+      std::uint64_t bytes_ = 0;
+
+      // time spent running the script
+      double seconds_ = 0.0;
+
+      // true once the session has run
+      bool done_ = false;
+
+      // true if the script or output file could not be opened
+      bool failed_ = false;
+
+   }; // end of Session
+
+   /** SessionRunner Attributes*/
+
+   // every session in the order added
+   std::vector<Session> sessions_;
+
+   // contents of the session files the sessions view
+   std::vector<std::unique_ptr<std::string>> sessionFiles_;
+
+   // guards the merged output
+   std::mutex mergeMutex_;
+
+   // next session to write to the merged output
+   std::size_t nextToMerge_;
+
+   // time from the first session starting to the last finishing
+   double wallSeconds_;
+
+   // workers used by the last run
+   std::size_t threadCount_;
+
+   // tasks stolen during the last run
+   std::uint64_t steals_;
+
+   /** SessionRunner private methods*/
+
+   /** runSession runs one session with its own Calculator
+   @post the session's output is in its file or output_, lines_ and seconds_ are set
+   @parm Session [session] session to run, std::string [outputPath] file to write to, empty to buffer*/
+   static void runSession(Session& session, const std::string& outputPath);
+
+   /** mergeCompleted marks a session done and writes every finished session not yet
+   written, up to the first one still running
+   @parm std::size_t [index] session that finished, std::ostream [merged] stream for the merged output*/
+   void mergeCompleted(std::size_t index, std::ostream& merged);
+
+}; // end of SessionRunner
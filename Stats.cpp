@@ -0,0 +1,175 @@
+/** @file Stats.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements the calculator's instrumentation: time
+	spent in each stage of processing a line and counters of the work done */
+
+#include "Stats.h"
+
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+
+namespace {
+
+	// number of stages and counters
+	const int stageCount = static_cast<int>(Stats::Stage::count);
+	const int counterCount = static_cast<int>(Stats::Counter::count);
+
+	// names printed by report, in enum order
+	const char* const stageNames[stageCount] = { "parse", "assign", "simplify", "calculate", "print" };
+	const char* const counterNames[counterCount] = { "lines", "nodes created", "nodes shared", "substitutions", "store lookups" };
+
+} // end namespace
+
+
+/** Registry Struct */
+struct Stats::Registry {
+
+	// guards the list and the finished totals
+	std::mutex mutex_;
+
+	// blocks of the threads still running
+	std::vector<const Block*> blocks_;
+
+	// totals of the threads that have finished
+	std::uint64_t nanoseconds_[stageCount] = {};
+	std::uint64_t calls_[stageCount] = {};
+	std::uint64_t counters_[counterCount] = {};
+
+};
+
+// stats are off until main asks for them
+std::atomic<bool> Stats::enabled_(false);
+
+
+/** Stats Class public methods */
+
+/** enable */
+void Stats::enable(bool on) {
+
+	enabled_.store(on, std::memory_order_relaxed);
+
+} // end of enable
+
+/** report */
+void Stats::report(std::ostream& out) {
+
+	std::uint64_t nanoseconds[stageCount] = {};
+	std::uint64_t calls[stageCount] = {};
+	std::uint64_t counters[counterCount] = {};
+
+	{
+		Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.mutex_);
+
+		std::copy(reg.nanoseconds_, reg.nanoseconds_ + stageCount, nanoseconds);
+		std::copy(reg.calls_, reg.calls_ + stageCount, calls);
+		std::copy(reg.counters_, reg.counters_ + counterCount, counters);
+
+		// running threads may still be adding, each value read is one they wrote
+		for (const Block* block : reg.blocks_) {
+			for (int stage = 0; stage < stageCount; ++stage) {
+				nanoseconds[stage] += block->nanoseconds_[stage].load(std::memory_order_relaxed);
+				calls[stage] += block->calls_[stage].load(std::memory_order_relaxed);
+			} // end for
+			for (int counter = 0; counter < counterCount; ++counter) {
+				counters[counter] += block->counters_[counter].load(std::memory_order_relaxed);
+			} // end for
+		} // end for
+	}
+
+	out << "stats:";
+	for (int counter = 0; counter < counterCount; ++counter) {
+		out << (counter == 0 ? " " : ", ") << counters[counter] << ' ' << counterNames[counter];
+	} // end for
+	out << '\n';
+
+	std::uint64_t totalNanoseconds = 0;
+
+	for (int stage = 0; stage < stageCount; ++stage) {
+
+		totalNanoseconds += nanoseconds[stage];
+
+		out << "stats [" << stageNames[stage] << "]: " << calls[stage] << " calls, " << nanoseconds[stage] / 1000 << " us, "
+			<< (calls[stage] != 0 ? nanoseconds[stage] / calls[stage] : 0) << " ns per call\n";
+
+	} // end for
+
+	out << "stats: " << totalNanoseconds / 1000 << " us timed" << std::endl;
+
+} // end of report
+
+/** Stats Class private methods */
+
+/** registry */
+Stats::Registry& Stats::registry() {
+
+	// never destroyed, so threads that end after main can still retire their blocks
+	static Registry* reg = new Registry();
+	return *reg;
+
+} // end of registry
+
+/** local */
+Stats::Block& Stats::local() {
+
+	thread_local Block block;
+	return block;
+
+} // end of local
+
+/** bump */
+void Stats::bump(std::atomic<std::uint64_t>& value, std::uint64_t amount) {
+
+	// only the owning thread writes, so a load and a store do not lose an add
+	value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+
+} // end of bump
+
+
+/** Block Class  */
+
+/** Block constructor */
+Stats::Block::Block()
+	:current_(Stage::print), depth_(0) {
+
+	for (int stage = 0; stage < stageCount; ++stage) {
+		nanoseconds_[stage].store(0, std::memory_order_relaxed);
+		calls_[stage].store(0, std::memory_order_relaxed);
+	} // end for
+	for (int counter = 0; counter < counterCount; ++counter) {
+		counters_[counter].store(0, std::memory_order_relaxed);
+	} // end for
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+	reg.blocks_.push_back(this);
+
+} // end constructor
+
+/** Block destructor */
+Stats::Block::~Block() {
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+
+	for (int stage = 0; stage < stageCount; ++stage) {
+		reg.nanoseconds_[stage] += nanoseconds_[stage].load(std::memory_order_relaxed);
+		reg.calls_[stage] += calls_[stage].load(std::memory_order_relaxed);
+	} // end for
+	for (int counter = 0; counter < counterCount; ++counter) {
+		reg.counters_[counter] += counters_[counter].load(std::memory_order_relaxed);
+	} // end for
+
+	reg.blocks_.erase(std::find(reg.blocks_.begin(), reg.blocks_.end(), this));
+
+} // end destructor
+
+/** charge */
+void Stats::Block::charge(std::chrono::steady_clock::time_point now) {
+
+	bump(nanoseconds_[static_cast<int>(current_)], static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - since_).count()));
+
+} // end of charge
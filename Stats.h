@@ -0,0 +1,196 @@
+/** @file Stats.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements the calculator's instrumentation: time
+   spent in each stage of processing a line and counters of the work done */
+
+#pragma once
+
+// included libraries
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+
+/** Stats Class
+ Every thread adds to its own block of counters, and report sums the blocks
+ of all threads, so counting never contends between threads. A Timer charges
+ the time since it started to its stage, less the time of the timers started
+ inside it, so a line's time is split between the stages without counting
+ any of it twice. Until enable is called every Timer and add costs a branch,
+ and building with CALCULATOR_NO_STATS defined removes them entirely.*/
+class Stats {
+
+public:
+
+   /** Stage of processing a line, print is everything else done to evaluate and echo it*/
+   enum class Stage : std::uint8_t { parse, assign, simplify, calculate, print, count };
+
+   /** Counter of work done*/
+   enum class Counter : std::uint8_t { lines, nodesCreated, nodesShared, substitutions, storeLookups, count };
+
+   /** Timer Class times a stage from its construction to its destruction*/
+   class Timer {
+
+   public:
+
+      /** Timer constructor starts the stage, pausing the stage it is started in
+      @parm Stage [stage] stage to charge the time to*/
+      explicit Timer(Stage stage);
+
+      /** Timer destructor charges the stage and resumes the one it was started in*/
+      ~Timer();
+
+      Timer(const Timer&) = delete;
+      Timer& operator=(const Timer&) = delete;
+
+   private:
+
+      // false if stats were off when the timer started
+      bool active_;
+
+      // stage running when this timer started
+      Stage previous_;
+
+   }; // end of Timer
+
+   /** Stats public methods*/
+
+   /** enable turns the timers and counters on or off, before any thread uses them
+   @parm bool [on] true to collect stats*/
+   static void enable(bool on);
+
+   /** enabled
+   @return true if stats are being collected*/
+   static bool enabled();
+
+   /** add adds to a counter of the calling thread
+   @parm Counter [counter] counter to add to, std::uint64_t [amount] amount to add*/
+   static void add(Counter counter, std::uint64_t amount = 1);
+
+   /** report writes the totals of every thread so far
+   @parm std::ostream [out] stream to write to*/
+   static void report(std::ostream& out);
+
+private:
+
+   /** Block Struct one thread's totals, atomic only so report can read them while the thread runs */
+   struct Block {
+
+      /** Block constructor adds the block to the list report sums*/
+      Block();
+
+      /** Block destructor keeps the totals of a finished thread*/
+      ~Block();
+
+      // nanoseconds charged to each stage
+      std::atomic<std::uint64_t> nanoseconds_[static_cast<int>(Stage::count)];
+
+      // times each stage was started
+      std::atomic<std::uint64_t> calls_[static_cast<int>(Stage::count)];
+
+      // value of each counter
+      std::atomic<std::uint64_t> counters_[static_cast<int>(Counter::count)];
+
+      // stage being timed, only used by the owning thread
+      Stage current_;
+
+      // number of timers running on the owning thread
+      int depth_;
+
+      // when current_ last started or resumed
+      std::chrono::steady_clock::time_point since_;
+
+      /** charge adds the time since the stage last resumed to it
+      @parm std::chrono::steady_clock::time_point [now] current time*/
+      void charge(std::chrono::steady_clock::time_point now);
+
+   }; // end of Block
+
+   /** Stats Attributes*/
+
+   // true once enable turned stats on
+   static std::atomic<bool> enabled_;
+
+   /** Registry Struct the blocks of running threads and the totals of finished ones*/
+   struct Registry;
+
+   /** Stats private methods*/
+
+   /** registry
+   @return the list of blocks report sums*/
+   static Registry& registry();
+
+   /** local
+   @return the calling thread's block*/
+   static Block& local();
+
+   /** bump adds to a counter the owning thread alone writes, without a locked instruction
+   @parm std::atomic<std::uint64_t> [value] counter to add to, std::uint64_t [amount] amount to add*/
+   static void bump(std::atomic<std::uint64_t>& value, std::uint64_t amount);
+
+}; // end of Stats
+
+
+/** Stats Class inline methods */
+
+/** enabled */
+inline bool Stats::enabled() {
+
+#if defined(CALCULATOR_NO_STATS)
+   return false;
+#else
+   return enabled_.load(std::memory_order_relaxed);
+#endif
+
+} // end of enabled
+
+/** add */
+inline void Stats::add(Counter counter, std::uint64_t amount) {
+
+   if (enabled()) {
+      bump(local().counters_[static_cast<int>(counter)], amount);
+   } // end if
+
+} // end of add
+
+/** Timer constructor */
+inline Stats::Timer::Timer(Stage stage)
+   :active_(enabled()), previous_(stage) {
+
+   if (active_) {
+
+      Block& block = local();
+      auto now = std::chrono::steady_clock::now();
+
+      if (block.depth_ > 0) {
+         block.charge(now);
+         previous_ = block.current_;
+      } // end if
+
+      bump(block.calls_[static_cast<int>(stage)], 1);
+      block.current_ = stage;
+      block.since_ = now;
+      ++block.depth_;
+
+   } // end if
+
+} // end constructor
+
+/** Timer destructor */
+inline Stats::Timer::~Timer() {
+
+   if (active_) {
+
+      Block& block = local();
+      auto now = std::chrono::steady_clock::now();
+
+      block.charge(now);
+      block.current_ = previous_;
+      block.since_ = now;
+      --block.depth_;
+
+   } // end if
+
+} // end destructor
@@ -0,0 +1,512 @@
+/** @file StoreImage.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a flat binary image of the variable
+	store that is written once and mapped back into memory to be read in place */
+
+#include "StoreImage.h"
+#include "Program.h"
+#include "Token.h"
+
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+
+static_assert(sizeof(StoreImage::Header) == 56, "the image header is 56 bytes");
+static_assert(sizeof(StoreImage::Text) == 8, "an image text is 8 bytes");
+static_assert(sizeof(StoreImage::Variable) == 32, "an image variable is 32 bytes");
+static_assert(sizeof(StoreImage::Node) == 24, "an image node is 24 bytes");
+
+
+/** StoreImage Class public methods */
+
+/** StoreImage destructor */
+StoreImage::~StoreImage() {
+
+#ifndef _WIN32
+	if (data_ != nullptr && copy_.empty()) {
+		munmap(const_cast<char*>(data_), size_);
+	} // end if
+#endif
+
+} // end destructor
+
+/** open */
+std::shared_ptr<const StoreImage> StoreImage::open(const std::string& fileName, std::string& error) {
+
+	std::shared_ptr<StoreImage> image(new StoreImage());
+
+#ifndef _WIN32
+	int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+	struct stat fileStatus;
+
+	if (fileDescriptor < 0 || fstat(fileDescriptor, &fileStatus) != 0) {
+		if (fileDescriptor >= 0) {
+			close(fileDescriptor);
+		} // end if
+		error = "Could Not Open " + fileName;
+		return nullptr;
+	} // end if
+
+	image->size_ = static_cast<std::size_t>(fileStatus.st_size);
+
+	// the pages are only read when a variable's nodes or the checksum touch them
+	if (image->size_ >= sizeof(Header)) {
+		void* mapping = mmap(nullptr, image->size_, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		image->data_ = (mapping != MAP_FAILED) ? static_cast<const char*>(mapping) : nullptr;
+	} // end if
+
+	close(fileDescriptor);
+#else
+	std::ifstream imageFile(fileName, std::ios::binary);
+	image->copy_.assign(std::istreambuf_iterator<char>(imageFile), std::istreambuf_iterator<char>());
+	image->size_ = image->copy_.size();
+	image->data_ = imageFile ? image->copy_.data() : nullptr;
+#endif
+
+	if (image->data_ == nullptr) {
+		error = "Could Not Read " + fileName;
+		return nullptr;
+	} // end if
+
+	if (!image->locate(error)) {
+		error = fileName + " " + error;
+		return nullptr;
+	} // end if
+
+	return image;
+
+} // end of open
+
+/** readChecksum */
+bool StoreImage::readChecksum(const std::string& fileName, std::uint64_t& checksum) {
+
+	Header head;
+	std::ifstream imageFile(fileName, std::ios::binary);
+	imageFile.read(reinterpret_cast<char*>(&head), sizeof(head));
+
+	if (!imageFile || std::memcmp(head.magic_, magic, sizeof(magic)) != 0) {
+		return false;
+	} // end if
+
+	checksum = head.checksum_;
+	return true;
+
+} // end of readChecksum
+
+/** checksum */
+std::uint64_t StoreImage::checksum(const char* data, std::size_t size) {
+
+	std::uint64_t hash = 0xcbf29ce484222325ULL;
+
+	for (std::size_t i = 0; i < size; ++i) {
+		hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+	} // end for
+
+	return hash;
+
+} // end of checksum
+
+/** syncFile */
+bool StoreImage::syncFile(const std::string& fileName) {
+
+#ifndef _WIN32
+	int fileDescriptor = ::open(fileName.c_str(), O_RDONLY);
+
+	if (fileDescriptor < 0) {
+		return false;
+	} // end if
+
+	bool synced = (fsync(fileDescriptor) == 0);
+	close(fileDescriptor);
+#else
+	int fileDescriptor = _open(fileName.c_str(), _O_RDWR | _O_BINARY);
+
+	if (fileDescriptor < 0) {
+		return false;
+	} // end if
+
+	bool synced = (_commit(fileDescriptor) == 0);
+	_close(fileDescriptor);
+#endif
+
+	return synced;
+
+} // end of syncFile
+
+/** syncDirectory */
+bool StoreImage::syncDirectory(const std::string& fileName) {
+
+#ifndef _WIN32
+	std::filesystem::path directory = std::filesystem::path(fileName).parent_path();
+	return syncFile(directory.empty() ? std::string(".") : directory.string());
+#else
+	// a rename reaches the disk with the file on Windows
+	return true;
+#endif
+
+} // end of syncDirectory
+
+/** header */
+const StoreImage::Header& StoreImage::header() const {
+
+	return *reinterpret_cast<const Header*>(data_);
+
+} // end of header
+
+/** symbol */
+std::string_view StoreImage::symbol(std::uint32_t index) const {
+
+	return std::string_view(text_ + symbols_[index].offset_, symbols_[index].length_);
+
+} // end of symbol
+
+/** big */
+Integer StoreImage::big(std::uint32_t index) const {
+
+	std::string_view digits(text_ + bigs_[index].offset_, bigs_[index].length_);
+	bool negative = !digits.empty() && digits.front() == '-';
+	Integer value;
+
+	Integer::fromString(negative ? digits.substr(1) : digits, value);
+
+	return negative ? Integer::sub(Integer(0), value) : value;
+
+} // end of big
+
+/** variable */
+const StoreImage::Variable& StoreImage::variable(std::uint32_t index) const {
+
+	return variables_[index];
+
+} // end of variable
+
+/** nodes */
+const StoreImage::Node* StoreImage::nodes(const Variable& variable) const {
+
+	return nodes_ + variable.firstNode_;
+
+} // end of nodes
+
+/** references */
+const std::uint32_t* StoreImage::references(const Variable& variable) const {
+
+	return references_ + variable.firstReference_;
+
+} // end of references
+
+/** StoreImage Class private methods */
+
+/** arraySize */
+std::uint64_t StoreImage::arraySize(std::uint64_t count, std::size_t entrySize) {
+
+	return (count * entrySize + 7) / 8 * 8;
+
+} // end of arraySize
+
+/** locate */
+bool StoreImage::locate(std::string& error) {
+
+	if (size_ < sizeof(Header) || std::memcmp(header().magic_, magic, sizeof(magic)) != 0) {
+		error = "Is Not A Variable Store Image";
+		return false;
+	} // end if
+
+	const Header& head = header();
+
+	if (head.version_ != version || head.byteOrder_ != byteOrderMark) {
+		error = "Was Written By Another Version Or Machine";
+		return false;
+	} // end if
+
+	// the arrays follow the header in this order, each starting 8 byte aligned
+	std::uint64_t offsets[6];
+	std::uint64_t sizes[6] = { arraySize(head.symbolCount_, sizeof(Text)), arraySize(head.bigCount_, sizeof(Text)),
+		arraySize(head.variableCount_, sizeof(Variable)), arraySize(head.nodeCount_, sizeof(Node)),
+		arraySize(head.referenceCount_, sizeof(std::uint32_t)), arraySize(head.textBytes_, 1) };
+	std::uint64_t end = sizeof(Header);
+
+	for (int array = 0; array < 6; ++array) {
+		offsets[array] = end;
+		end += sizes[array];
+	} // end for
+
+	if (head.nodeCount_ > UINT32_MAX || head.textBytes_ > UINT32_MAX || end != size_) {
+		error = "Is Truncated Or Has Extra Bytes";
+		return false;
+	} // end if
+
+	if (checksum(data_ + sizeof(Header), size_ - sizeof(Header)) != head.checksum_) {
+		error = corruptError;
+		return false;
+	} // end if
+
+	symbols_ = reinterpret_cast<const Text*>(data_ + offsets[0]);
+	bigs_ = reinterpret_cast<const Text*>(data_ + offsets[1]);
+	variables_ = reinterpret_cast<const Variable*>(data_ + offsets[2]);
+	nodes_ = reinterpret_cast<const Node*>(data_ + offsets[3]);
+	references_ = reinterpret_cast<const std::uint32_t*>(data_ + offsets[4]);
+	text_ = data_ + offsets[5];
+
+	// every index is checked once here, so reading the image later needs no checks
+	bool valid = true;
+
+	for (std::uint32_t i = 0; i < head.symbolCount_ + head.bigCount_; ++i) {
+		const Text& text = (i < head.symbolCount_) ? symbols_[i] : bigs_[i - head.symbolCount_];
+		valid = valid && std::uint64_t(text.offset_) + text.length_ <= head.textBytes_;
+	} // end for
+
+	for (std::uint32_t i = 0; i < head.referenceCount_; ++i) {
+		valid = valid && references_[i] < head.symbolCount_;
+	} // end for
+
+	for (std::uint32_t i = 0; valid && i < head.variableCount_; ++i) {
+
+		const Variable& record = variables_[i];
+		valid = record.symbol_ < head.symbolCount_ && record.nodeCount_ != 0
+			&& std::uint64_t(record.firstNode_) + record.nodeCount_ <= head.nodeCount_
+			&& std::uint64_t(record.firstReference_) + record.referenceCount_ <= head.referenceCount_
+			&& (record.bigValue_ == 0 || (record.value_ >= 0 && record.value_ < head.bigCount_));
+
+		const Node* first = nodes_ + record.firstNode_;
+
+		for (std::uint32_t node = 0; valid && node < record.nodeCount_; ++node) {
+
+			const Node& entry = first[node];
+			TokType type = static_cast<TokType>(entry.type_);
+			bool isOp = (type == TokType::addminusop || type == TokType::muldivop || type == TokType::powop);
+
+			valid = (isOp && entry.left_ < node && entry.right_ < node && entry.op_ <= static_cast<std::uint8_t>(OpCode::pow))
+				|| (type == TokType::variable && entry.payload_ >= 0 && entry.payload_ < head.symbolCount_)
+				|| (type == TokType::number && (entry.bigNumber_ == 0 || (entry.payload_ >= 0 && entry.payload_ < head.bigCount_)));
+
+		} // end for
+
+	} // end for
+
+	if (!valid) {
+		error = "Has An Index Out Of Range";
+		return false;
+	} // end if
+
+	// contents a checksum cannot vouch for are as bad as a checksum that does not match
+	if (!consistent()) {
+		error = corruptError;
+		return false;
+	} // end if
+
+	return true;
+
+} // end of locate
+
+/** consistent */
+bool StoreImage::consistent() const {
+
+	const Header& head = header();
+
+	// every name is a variable, a single letter given once, so each symbol index is a bit of a mask
+	std::uint32_t named = 0;
+
+	if (head.symbolCount_ > 26) {
+		return false;
+	} // end if
+
+	for (std::uint32_t i = 0; i < head.symbolCount_; ++i) {
+
+		std::string_view name = symbol(i);
+		if (name.size() != 1 || name[0] < 'a' || name[0] > 'z' || (named & (std::uint32_t(1) << (name[0] - 'a'))) != 0) {
+			return false;
+		} // end if
+
+		named |= std::uint32_t(1) << (name[0] - 'a');
+
+	} // end for
+
+	// the variables the first record of each variable reads, load keeps the first of a variable written twice
+	std::uint32_t assigned = 0;
+	std::uint32_t reads[26] = {};
+
+	for (std::uint32_t i = 0; i < head.variableCount_; ++i) {
+
+		const Variable& record = variables_[i];
+
+		if (record.status_ > static_cast<std::uint8_t>(Program::Status::tooLarge) || record.closed_ > 1 || record.bigValue_ > 1) {
+			return false;
+		} // end if
+
+		// the references are the variables the nodes read, the graph of references is what load trusts
+		std::uint32_t fromNodes = 0;
+		std::uint32_t fromReferences = 0;
+		const Node* first = nodes(record);
+		const std::uint32_t* firstReference = references(record);
+
+		for (std::uint32_t node = 0; node < record.nodeCount_; ++node) {
+			if (static_cast<TokType>(first[node].type_) == TokType::variable) {
+				fromNodes |= std::uint32_t(1) << first[node].payload_;
+			} // end if
+		} // end for
+
+		for (std::uint32_t reference = 0; reference < record.referenceCount_; ++reference) {
+			fromReferences |= std::uint32_t(1) << firstReference[reference];
+		} // end for
+
+		if (fromNodes != fromReferences) {
+			return false;
+		} // end if
+
+		if ((assigned & (std::uint32_t(1) << record.symbol_)) == 0) {
+			assigned |= std::uint32_t(1) << record.symbol_;
+			reads[record.symbol_] = fromReferences;
+		} // end if
+
+	} // end for
+
+	// take away the variables that read no variable left until none can be, what is left reads itself
+	std::uint32_t left = assigned;
+	bool removed = true;
+
+	while (removed) {
+
+		removed = false;
+
+		for (std::uint32_t i = 0; i < head.symbolCount_; ++i) {
+			if ((left & (std::uint32_t(1) << i)) != 0 && (reads[i] & left) == 0) {
+				left &= ~(std::uint32_t(1) << i);
+				removed = true;
+			} // end if
+		} // end for
+
+	} // end while
+
+	return left == 0;
+
+} // end of consistent
+
+
+/** Writer Class  */
+
+/** addSymbol */
+std::uint32_t StoreImage::Writer::addSymbol(std::string_view name) {
+
+	symbols_.push_back(addText(name));
+	return static_cast<std::uint32_t>(symbols_.size() - 1);
+
+} // end of addSymbol
+
+/** addBig */
+std::uint32_t StoreImage::Writer::addBig(const Integer& value) {
+
+	bigs_.push_back(addText(value.toString()));
+	return static_cast<std::uint32_t>(bigs_.size() - 1);
+
+} // end of addBig
+
+/** addVariable */
+void StoreImage::Writer::addVariable(Variable variable) {
+
+	variable.firstNode_ = static_cast<std::uint32_t>(nextNode_);
+	variable.nodeCount_ = static_cast<std::uint32_t>(nodes_.size() - nextNode_);
+	variable.firstReference_ = static_cast<std::uint32_t>(nextReference_);
+	variable.referenceCount_ = static_cast<std::uint32_t>(references_.size() - nextReference_);
+	variables_.push_back(variable);
+
+	nextNode_ = nodes_.size();
+	nextReference_ = references_.size();
+
+} // end of addVariable
+
+/** addNode */
+void StoreImage::Writer::addNode(const Node& node) {
+
+	nodes_.push_back(node);
+
+} // end of addNode
+
+/** addReference */
+void StoreImage::Writer::addReference(std::uint32_t symbol) {
+
+	references_.push_back(symbol);
+
+} // end of addReference
+
+/** write */
+bool StoreImage::Writer::write(const std::string& fileName, std::string& error) const {
+
+	if (nodes_.size() > UINT32_MAX || text_.size() > UINT32_MAX) {
+		error = "Could Not Save " + fileName + ", The Store Is Too Large For An Image";
+		return false;
+	} // end if
+
+	// the arrays after the header, each padded to 8 bytes
+	std::string body;
+	auto appendArray = [&body](const void* data, std::size_t bytes) {
+		body.append(static_cast<const char*>(data), bytes);
+		body.append((8 - bytes % 8) % 8, '\0');
+	};
+
+	appendArray(symbols_.data(), symbols_.size() * sizeof(Text));
+	appendArray(bigs_.data(), bigs_.size() * sizeof(Text));
+	appendArray(variables_.data(), variables_.size() * sizeof(Variable));
+	appendArray(nodes_.data(), nodes_.size() * sizeof(Node));
+	appendArray(references_.data(), references_.size() * sizeof(std::uint32_t));
+	appendArray(text_.data(), text_.size());
+
+	Header head;
+	std::memset(&head, 0, sizeof(head));
+	std::memcpy(head.magic_, magic, sizeof(magic));
+	head.version_ = version;
+	head.byteOrder_ = byteOrderMark;
+	head.symbolCount_ = static_cast<std::uint32_t>(symbols_.size());
+	head.bigCount_ = static_cast<std::uint32_t>(bigs_.size());
+	head.variableCount_ = static_cast<std::uint32_t>(variables_.size());
+	head.referenceCount_ = static_cast<std::uint32_t>(references_.size());
+	head.nodeCount_ = nodes_.size();
+	head.textBytes_ = text_.size();
+	head.checksum_ = checksum(body.data(), body.size());
+
+	// the file may be mapped by the store being saved, truncating it would change what the mapping reads
+	std::string temp = fileName + ".tmp";
+	std::ofstream imageFile(temp, std::ios::binary | std::ios::trunc);
+	imageFile.write(reinterpret_cast<const char*>(&head), sizeof(head));
+	imageFile.write(body.data(), static_cast<std::streamsize>(body.size()));
+	imageFile.close();
+
+	if (!imageFile || !syncFile(temp)) {
+		error = "Could Not Save " + fileName;
+		return false;
+	} // end if
+
+	std::error_code renameError;
+	std::filesystem::rename(temp, fileName, renameError);
+
+	if (renameError || !syncDirectory(fileName)) {
+		error = "Could Not Replace " + fileName;
+		return false;
+	} // end if
+
+	return true;
+
+} // end of write
+
+/** Writer Class private methods */
+
+/** addText */
+StoreImage::Text StoreImage::Writer::addText(std::string_view text) {
+
+	Text where = { static_cast<std::uint32_t>(text_.size()), static_cast<std::uint32_t>(text.size()) };
+	text_.append(text.data(), text.size());
+
+	return where;
+
+} // end of addText
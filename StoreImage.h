@@ -0,0 +1,293 @@
+/** @file StoreImage.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a flat binary image of the variable
+   store that is written once and mapped back into memory to be read in place */
+
+#pragma once
+
+// included classes
+#include "Integer.h"
+
+// included libraries
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+/** StoreImage Class
+ An image is a header followed by fixed size arrays: the names of the
+ symbols it uses, big numbers as decimal text, one record per variable, the
+ nodes of every variable's flattened expression, the variables each one
+ reads, and the text the names and numbers point into. Everything is
+ addressed by index or offset, never by pointer, so the file is mapped and
+ read in place with no step per node. The header holds a checksum of the
+ rest of the file, checked when the image is opened.*/
+class StoreImage {
+
+public:
+
+   /** Header Struct start of the file*/
+   struct Header {
+
+      // "CALCSTOR"
+      char magic_[8];
+
+      // format version
+      std::uint32_t version_;
+
+      // byteOrderMark as written, an image is only read on a machine of the same byte order
+      std::uint32_t byteOrder_;
+
+      // entries of each array
+      std::uint32_t symbolCount_;
+      std::uint32_t bigCount_;
+      std::uint32_t variableCount_;
+      std::uint32_t referenceCount_;
+      std::uint64_t nodeCount_;
+      std::uint64_t textBytes_;
+
+      // FNV-1a hash of every byte after the header
+      std::uint64_t checksum_;
+
+   };
+
+   /** Text Struct a name or number in the text array*/
+   struct Text {
+
+      // first byte
+      std::uint32_t offset_;
+
+      // number of bytes
+      std::uint32_t length_;
+
+   };
+
+   /** Variable Struct an assigned variable*/
+   struct Variable {
+
+      // index of the variable's name in the symbols
+      std::uint32_t symbol_;
+
+      // the variable's expression, a run of the nodes
+      std::uint32_t firstNode_;
+      std::uint32_t nodeCount_;
+
+      // the variables it reads, a run of the references holding symbol indices
+      std::uint32_t firstReference_;
+      std::uint32_t referenceCount_;
+
+      // true if the value below was cached, false if the substituted expression still has a variable
+      std::uint8_t closed_;
+
+      // Program::Status of the cached value
+      std::uint8_t status_;
+
+      // true if value_ is the index of a big number
+      std::uint8_t bigValue_;
+
+      std::uint8_t padding_;
+
+      // cached value, or the index of a big number
+      std::int64_t value_;
+
+   };
+
+   /** Node Struct one entry of a flattened expression*/
+   struct Node {
+
+      // TokType and OpCode of the token
+      std::uint8_t type_;
+      std::uint8_t op_;
+
+      // true if payload_ is the index of a big number
+      std::uint8_t bigNumber_;
+
+      std::uint8_t padding_;
+
+      // indices of the operands within the variable's nodes, unused for a leaf
+      std::uint32_t left_;
+      std::uint32_t right_;
+
+      std::uint32_t padding2_;
+
+      // number, index of a variable's name in the symbols, or index of a big number
+      std::int64_t payload_;
+
+   };
+
+   /** Writer Class collects the arrays of an image and writes the file*/
+   class Writer {
+
+   public:
+
+      /** Writer public methods*/
+
+      /** addSymbol adds a name to the symbols
+      @parm std::string_view [name] name of a variable
+      @return its index*/
+      std::uint32_t addSymbol(std::string_view name);
+
+      /** addBig adds a big number
+      @parm Integer [value] number to add
+      @return its index*/
+      std::uint32_t addBig(const Integer& value);
+
+      /** addVariable adds a variable record, its nodes and references are the ones added since the last
+      @parm Variable [variable] record with symbol_, closed_, status_, bigValue_ and value_ set*/
+      void addVariable(Variable variable);
+
+      /** addNode adds a node of the next variable's expression
+      @parm Node [node] node to add*/
+      void addNode(const Node& node);
+
+      /** addReference adds a variable the next variable reads
+      @parm std::uint32_t [symbol] index of its name in the symbols*/
+      void addReference(std::uint32_t symbol);
+
+      /** write writes the image aside, syncs it and renames it over the file, so a store still
+      reading a mapping of the old image keeps reading the old image
+      @parm std::string [fileName] file to write, std::string [error] why the file was not written
+      @return true if the file was written*/
+      bool write(const std::string& fileName, std::string& error) const;
+
+   private:
+
+      /** Writer Attributes*/
+
+      // arrays of the image
+      std::vector<Text> symbols_;
+      std::vector<Text> bigs_;
+      std::vector<Variable> variables_;
+      std::vector<Node> nodes_;
+      std::vector<std::uint32_t> references_;
+      std::string text_;
+
+      // first node and reference of the next variable
+      std::size_t nextNode_ = 0;
+      std::size_t nextReference_ = 0;
+
+      /** addText appends to the text
+      @parm std::string_view [text] text to add
+      @return where it is*/
+      Text addText(std::string_view text);
+
+   }; // end of Writer
+
+   /** StoreImage destructor unmaps the file*/
+   ~StoreImage();
+
+   StoreImage(const StoreImage&) = delete;
+   StoreImage& operator=(const StoreImage&) = delete;
+
+   /** StoreImage public methods*/
+
+   /** open maps an image and checks its header and checksum
+   @parm std::string [fileName] file to open, std::string [error] why the image could not be opened
+   @return the image, nullptr on error*/
+   static std::shared_ptr<const StoreImage> open(const std::string& fileName, std::string& error);
+
+   /** readChecksum reads the checksum from an image's header without mapping the image
+   @parm std::string [fileName] image to read, std::uint64_t [checksum] checksum of the image
+   @return false if the file could not be read or is not an image*/
+   static bool readChecksum(const std::string& fileName, std::uint64_t& checksum);
+
+   /** checksum hashes bytes with FNV-1a
+   @parm char* [data] first byte, std::size_t [size] number of bytes
+   @return the hash*/
+   static std::uint64_t checksum(const char* data, std::size_t size);
+
+   /** syncFile waits for a file's contents, or a directory's entries, to reach the disk
+   @parm std::string [fileName] file or directory to sync
+   @return true if the file was synced*/
+   static bool syncFile(const std::string& fileName);
+
+   /** syncDirectory waits for a renamed file's directory entry to reach the disk
+   @parm std::string [fileName] file in the directory
+   @return true if the directory was synced*/
+   static bool syncDirectory(const std::string& fileName);
+
+   /** header
+   @return the image's header*/
+   const Header& header() const;
+
+   /** symbol
+   @parm std::uint32_t [index] index of a symbol
+   @return its name*/
+   std::string_view symbol(std::uint32_t index) const;
+
+   /** big
+   @parm std::uint32_t [index] index of a big number
+   @return its value*/
+   Integer big(std::uint32_t index) const;
+
+   /** variable
+   @parm std::uint32_t [index] index of a variable
+   @return its record*/
+   const Variable& variable(std::uint32_t index) const;
+
+   /** nodes
+   @parm Variable [variable] variable of the image
+   @return the first node of its expression*/
+   const Node* nodes(const Variable& variable) const;
+
+   /** references
+   @parm Variable [variable] variable of the image
+   @return the first symbol index of the variables it reads*/
+   const std::uint32_t* references(const Variable& variable) const;
+
+   // first bytes of an image
+   static constexpr char magic[8] = { 'C', 'A', 'L', 'C', 'S', 'T', 'O', 'R' };
+
+   // version written, images of another version are refused
+   static constexpr std::uint32_t version = 1;
+
+   // written as a number, reads back differently on a machine of the other byte order
+   static constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+   // error of an image whose checksum or contents do not match
+   static constexpr const char* corruptError = "Is Corrupt, Its Checksum Or Contents Do Not Match";
+
+private:
+
+   /** StoreImage constructor*/
+   StoreImage() = default;
+
+   /** StoreImage Attributes*/
+
+   // mapped file, or a copy of it where files cannot be mapped
+   const char* data_ = nullptr;
+   std::size_t size_ = 0;
+   std::vector<char> copy_;
+
+   // the arrays within data_
+   const Text* symbols_ = nullptr;
+   const Text* bigs_ = nullptr;
+   const Variable* variables_ = nullptr;
+   const Node* nodes_ = nullptr;
+   const std::uint32_t* references_ = nullptr;
+   const char* text_ = nullptr;
+
+   /** StoreImage private methods*/
+
+   /** arraySize the bytes an array takes in the file, rounded up so the next one is aligned
+   @parm std::uint64_t [count] entries, std::size_t [entrySize] bytes of one entry
+   @return bytes taken*/
+   static std::uint64_t arraySize(std::uint64_t count, std::size_t entrySize);
+
+   /** locate points the arrays into data_ and checks they and everything they index are in the file
+   @parm std::string [error] why the image is not valid
+   @return true if the image is valid*/
+   bool locate(std::string& error);
+
+   /** consistent checks what load reads without checking again: every name is a single letter
+   variable given once, every status is a Program::Status, each variable's references are the variables
+   its nodes read, and the references have no cycle, so substituting a loaded variable always ends
+   @pre locate found every index in range
+   @return true if the contents are consistent*/
+   bool consistent() const;
+
+}; // end of StoreImage
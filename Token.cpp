@@ -2,37 +2,241 @@
  @author Anthony Campos
  @date 12/07/2021
  This is implementation file implements a  data structure known as a
-	Token that holds a TokType and a std::string value */
+	Token that holds a TokType, an OpCode and a typed payload */
 
 #include "Token.h"
+#include "MemoryAccount.h"
+
+#include <atomic>
+#include <charconv>
+#include <deque>
+#include <unordered_map>
+#include <memory_resource>
+
+
+/**  Symbol Table */
+
+namespace {
+
+	/** SymbolTable interned names, stored in a deque so views stay valid.
+	 Each thread has its own table, so sessions on different threads never
+	 share a command's id; the single letters are the same ids on every thread.
+	 The table allocates through a resource that counts it as symbols */
+	struct SymbolTable {
+
+		SymbolTable()
+			:heap(MemoryAccount::Origin::symbols, std::pmr::new_delete_resource()), names(&heap), ids(&heap) {
+			// single letter variables are always the first 26 ids
+			for (char letter = 'a'; letter <= 'z'; ++letter) {
+				names.emplace_back(1, letter);
+				ids.emplace(names.back(), static_cast<std::uint32_t>(names.size() - 1));
+			} // end for
+		} // end SymbolTable constructor
+
+		MemoryAccount::Resource heap;
+		std::pmr::deque<std::pmr::string> names;
+		std::pmr::unordered_map<std::string_view, std::uint32_t> ids;
+
+	}; // end of SymbolTable
+
+	SymbolTable& symbolTable() {
+		thread_local SymbolTable table;
+		return table;
+	} // end of symbolTable
+
+} // end namespace
+
+
+/** BigNumber Struct */
+struct Token::BigNumber {
+
+	// tokens holding the value, atomic since copies may be released on other threads
+	mutable std::atomic<std::uint32_t> refCount_;
+
+	// the value
+	const Integer value_;
+
+	/** memoryBytes
+	@return the bytes of the block and its value's limbs, counted as big numbers*/
+	std::size_t memoryBytes() const {
+		return sizeof(BigNumber) + (value_.bitLength() + 31) / 32 * sizeof(std::uint32_t);
+	}
+
+};
 
 
 /**  Token Public Methods */
 
   /** Token constructors  */
-Token::Token(TokType t, std::string v)
-	:type_(t), value_(v) {}
+Token::Token(TokType t, OpCode op, std::int64_t payload)
+	:type_(t), op_(op), bigNumber_(false), payload_(payload) {}
+
+/** Token copy constructor */
+Token::Token(const Token& other)
+	:type_(other.type_), op_(other.op_), bigNumber_(other.bigNumber_), payload_(other.payload_) {
+
+	if (bigNumber_) {
+		big_->refCount_.fetch_add(1, std::memory_order_relaxed);
+	} // end if
+
+} // end copy constructor
+
+/** Token move constructor */
+Token::Token(Token&& other) noexcept
+	:type_(other.type_), op_(other.op_), bigNumber_(other.bigNumber_), payload_(other.payload_) {
+
+	other.bigNumber_ = false;
+
+} // end move constructor
+
+/** Token destructor */
+Token::~Token() {
+
+	if (bigNumber_) {
+		releaseBig();
+	} // end if
+
+} // end destructor
+
+/** Overloaded operator= */
+Token& Token::operator=(const Token& rhs) {
+
+	if (rhs.bigNumber_) {
+		rhs.big_->refCount_.fetch_add(1, std::memory_order_relaxed);
+	} // end if
+
+	if (bigNumber_) {
+		releaseBig();
+	} // end if
+
+	type_ = rhs.type_;
+	op_ = rhs.op_;
+	bigNumber_ = rhs.bigNumber_;
+	payload_ = rhs.payload_;
+
+	return *this;
+
+} // end of operator=
+
+/** Overloaded operator= */
+Token& Token::operator=(Token&& rhs) noexcept {
+
+	if (this != &rhs) {
+
+		if (bigNumber_) {
+			releaseBig();
+		} // end if
+
+		type_ = rhs.type_;
+		op_ = rhs.op_;
+		bigNumber_ = rhs.bigNumber_;
+		payload_ = rhs.payload_;
+		rhs.bigNumber_ = false;
+
+	} // end if
+
+	return *this;
+
+} // end of operator=
 
 /** Accessors */
 
 std::string Token::getValue() const {
-	return value_;
+	std::string value;
+	appendTo(value);
+	return value;
 } // end getValue
 
+/** appendTo */
+void Token::appendTo(std::string& str) const {
+
+	switch (type_) {
+	case TokType::number: {
+		if (bigNumber_) {
+			getInteger().appendTo(str);
+			break;
+		} // end if
+		char buffer[24];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), payload_);
+		str.append(buffer, result.ptr);
+		break;
+	}
+	case TokType::variable:
+	case TokType::command:
+		str += symbolName(static_cast<std::uint32_t>(payload_));
+		break;
+	case TokType::addminusop:
+	case TokType::muldivop:
+	case TokType::powop: {
+		static const char opChars[] = { '?', '+', '-', '*', '/', '^' };
+		str += opChars[static_cast<int>(op_)];
+		break;
+	}
+	case TokType::lparen:
+		str += '(';
+		break;
+	case TokType::rparen:
+		str += ')';
+		break;
+	case TokType::assign:
+		str += ":=";
+		break;
+	case TokType::end:
+		str += '.';
+		break;
+	case TokType::newline:
+		str += '\n';
+		break;
+	default:
+		// unknown tokens keep the character read
+		str += static_cast<char>(payload_);
+		break;
+	} // end switch
+
+} // end appendTo
+
 
 TokType Token::getType() const {
 	return type_;
 } // end getType
 
-/** mutators */
+OpCode Token::getOp() const {
+	return op_;
+} // end getOp
 
-/** setValue */
-bool Token::setValue(std::string value) {
+std::int64_t Token::getNumber() const {
+	return payload_;
+} // end getNumber
 
-	value_ = value;
-	return true;
+bool Token::isBigNumber() const {
+	return bigNumber_;
+} // end isBigNumber
 
-} // end setValue
+Integer Token::getInteger() const {
+	if (!bigNumber_) {
+		return Integer(payload_);
+	} // end if
+
+	return big_->value_;
+} // end getInteger
+
+std::size_t Token::payloadHash() const {
+	return bigNumber_ ? big_->value_.hash() : std::hash<std::int64_t>()(payload_);
+} // end payloadHash
+
+bool Token::samePayload(const Token& other) const {
+	if (bigNumber_ != other.bigNumber_) {
+		return false;
+	} // end if
+
+	return bigNumber_ ? (big_ == other.big_ || big_->value_ == other.big_->value_) : payload_ == other.payload_;
+} // end samePayload
+
+std::uint32_t Token::getSymbol() const {
+	return static_cast<std::uint32_t>(payload_);
+} // end getSymbol
+
+/** mutators */
 
 /** setType */
 bool Token::setType(TokType type) {
@@ -40,4 +244,99 @@ bool Token::setType(TokType type) {
 	type_ = type;
 	return true;
 
-} // end setType
\ No newline at end of file
+} // end setType
+
+/** setOp */
+bool Token::setOp(OpCode op) {
+
+	op_ = op;
+	return true;
+
+} // end setOp
+
+/** setNumber */
+bool Token::setNumber(std::int64_t value) {
+
+	if (bigNumber_) {
+		releaseBig();
+	} // end if
+
+	payload_ = value;
+	return true;
+
+} // end setNumber
+
+/** setInteger */
+bool Token::setInteger(const Integer& value) {
+
+	if (value.isSmall()) {
+		return setNumber(value.getSmall());
+	} // end if
+
+	// the block shares the value's limbs, so only the count and the pointer are new
+	const BigNumber* big = new BigNumber{ { 1 }, value };
+	MemoryAccount::allocated(MemoryAccount::Origin::bigNumbers, big->memoryBytes());
+
+	if (bigNumber_) {
+		releaseBig();
+	} // end if
+
+	bigNumber_ = true;
+	big_ = big;
+
+	return true;
+
+} // end setInteger
+
+/** setSymbol */
+bool Token::setSymbol(std::uint32_t symbol) {
+
+	if (bigNumber_) {
+		releaseBig();
+	} // end if
+
+	payload_ = symbol;
+	return true;
+
+} // end setSymbol
+
+/** internSymbol */
+std::uint32_t Token::internSymbol(std::string_view name) {
+
+	SymbolTable& table = symbolTable();
+	auto it = table.ids.find(name);
+
+	if (it != table.ids.end()) {
+		return it->second;
+	} // end if
+
+	table.names.emplace_back(name);
+	std::uint32_t symbol = static_cast<std::uint32_t>(table.names.size() - 1);
+	table.ids.emplace(table.names.back(), symbol);
+
+	return symbol;
+
+} // end internSymbol
+
+/** symbolName */
+std::string_view Token::symbolName(std::uint32_t symbol) {
+
+	return symbolTable().names[symbol];
+
+} // end symbolName
+
+/**  Token Private Methods */
+
+/** releaseBig */
+void Token::releaseBig() {
+
+	// the last token to let go sees every other token's release before it frees
+	if (big_->refCount_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		MemoryAccount::deallocated(MemoryAccount::Origin::bigNumbers, big_->memoryBytes());
+		delete big_;
+	} // end if
+
+	bigNumber_ = false;
+	payload_ = 0;
+
+} // end of releaseBig
@@ -2,17 +2,32 @@
  @author Anthony Campos
  @date 12/07/2021
  This header class file implements a  data structure known as a
-   Token that holds a TokType and a std::string value */
+   Token that holds a TokType, an OpCode and a typed payload */
 
 #pragma once
 
+// included classes
+#include "Integer.h"
+
 // include libraries
 #include <string>
+#include <string_view>
+#include <cstdint>
 
 /**  Global Variable */
-enum class TokType { addminusop, muldivop, powop, variable, number, lparen, rparen, assign, newline, end, unknown };
+enum class TokType : std::uint8_t { addminusop, muldivop, powop, variable, number, lparen, rparen, assign, command, newline, end, unknown };
+
+/** OpCode the exact operation of an operator token */
+enum class OpCode : std::uint8_t { none, add, sub, mul, div, pow };
 
-/**  Token Struct */
+/**  Token Struct
+ A Token is 16 bytes: numbers keep their value in the payload, variables and
+ commands keep an interned symbol id, so no strings are held after lexing.
+ A number too large for the payload is held in a reference counted block that
+ the payload points to, shared by the copies of the token and freed with the
+ last one; the count is atomic, so a tree built on one thread can be
+ evaluated on another. The symbol table is per thread, so a command's id is
+ only valid on its thread.*/
 
 class Token {
 
@@ -20,37 +35,132 @@ public:
    /**  Token Public Methods */
 
    /** Token constructors  */
-   Token(TokType t = TokType::unknown, std::string v = "");
+   Token(TokType t = TokType::unknown, OpCode op = OpCode::none, std::int64_t payload = 0);
+
+   /** Token copy constructor shares a big number's block*/
+   Token(const Token& other);
+
+   /** Token move constructor takes a big number's block*/
+   Token(Token&& other) noexcept;
+
+   /** Token destructor releases a big number's block*/
+   ~Token();
+
+   /** overloaded operator= shares a big number's block
+   @return the token*/
+   Token& operator=(const Token& rhs);
+
+   /** overloaded operator= takes a big number's block
+   @return the token*/
+   Token& operator=(Token&& rhs) noexcept;
 
    /** Accessors */
 
-   /** getValue
-   @return std::string value_*/
+   /** getValue builds the printable text of the token
+   @return std::string text of the token*/
    std::string getValue() const;
 
+   /** appendTo appends the printable text of the token
+   @post the token's text is added to the end of str
+   @parm std::string [str] string to append to*/
+   void appendTo(std::string& str) const;
+
    /** getType
    @return TokType type_*/
    TokType getType() const;
 
-   /** mutators */
+   /** getOp
+   @return OpCode op_*/
+   OpCode getOp() const;
 
-   /** setValue
-   @post If successful, value_ is set to std::string value
-   @return true if value was set*/
-   bool setValue(std::string value);
+   /** getNumber
+   @return the value of a number token that is not a big number*/
+   std::int64_t getNumber() const;
+
+   /** isBigNumber
+   @return true if the number did not fit the payload*/
+   bool isBigNumber() const;
+
+   /** getInteger
+   @return the exact value of a number token*/
+   Integer getInteger() const;
+
+   /** payloadHash
+   @return a hash of the payload, tokens with the same payload hash equal*/
+   std::size_t payloadHash() const;
+
+   /** samePayload
+   @parm Token [other] token to compare with
+   @return true if both hold the same number, big or not, or the same symbol*/
+   bool samePayload(const Token& other) const;
+
+   /** getSymbol
+   @return the interned symbol id of a variable or command token*/
+   std::uint32_t getSymbol() const;
+
+   /** mutators */
 
    /** setType
    @post if successful, type_ is set to the TokType std::string
    @return true if type was set*/
    bool setType(TokType type);
 
+   /** setOp
+   @post if successful, op_ is set to the OpCode op
+   @return true if op was set*/
+   bool setOp(OpCode op);
+
+   /** setNumber
+   @post if successful, the payload holds the number value
+   @return true if value was set*/
+   bool setNumber(std::int64_t value);
+
+   /** setInteger
+   @post if successful, the payload holds the value, or points to a new block holding it if it does not fit
+   @return true if value was set*/
+   bool setInteger(const Integer& value);
+
+   /** setSymbol
+   @post if successful, the payload holds the symbol id
+   @return true if symbol was set*/
+   bool setSymbol(std::uint32_t symbol);
+
+   /** internSymbol finds or adds a name to the calling thread's symbol table,
+   the single letters a to z are always the ids 0 to 25
+   @parm std::string_view [name] name to intern
+   @return the symbol id of name*/
+   static std::uint32_t internSymbol(std::string_view name);
+
+   /** symbolName
+   @parm std::uint32_t [symbol] id returned by internSymbol
+   @return the name of the symbol*/
+   static std::string_view symbolName(std::uint32_t symbol);
+
 private:
+   /** BigNumber Struct a number too large for the payload and the tokens holding it*/
+   struct BigNumber;
+
    /**  Token private attribute */
 
    // holds the token type
    TokType type_;
-   // hold the token value 
-   std::string value_;
+   // holds the exact operation of an operator
+   OpCode op_;
+   // true when big_ points to the value
+   bool bigNumber_;
+   union {
+      // hold the number value, symbol id or unknown character
+      std::int64_t payload_;
+      // holds the value of a big number, with one reference for this token
+      const BigNumber* big_;
+   };
+
+   /**  Token private methods */
+
+   /** releaseBig drops this token's reference to its big number, freeing the block with the last one
+   @post the token holds no big number*/
+   void releaseBig();
 
 }; // end of Token
 
+static_assert(sizeof(Token) == 16, "Token should stay 16 bytes");
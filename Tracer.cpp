@@ -0,0 +1,171 @@
+/** @file Tracer.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements an opt in tracer that records when each
+	method of the calculator's pipeline ran on each thread and writes them
+	as a Chrome trace event file */
+
+#include "Tracer.h"
+
+#include <mutex>
+#include <memory>
+#include <chrono>
+
+
+namespace {
+
+	/** writeMicroseconds writes nanoseconds as microseconds with three decimals, the unit trace events use
+	@parm std::ostream [out] stream to write to, std::uint64_t [nanoseconds] time to write*/
+	void writeMicroseconds(std::ostream& out, std::uint64_t nanoseconds) {
+
+		std::uint64_t fraction = nanoseconds % 1000;
+
+		out << nanoseconds / 1000 << '.' << static_cast<char>('0' + fraction / 100)
+			<< static_cast<char>('0' + fraction / 10 % 10) << static_cast<char>('0' + fraction % 10);
+
+	} // end of writeMicroseconds
+
+} // end namespace
+
+
+/** Registry Struct */
+struct Tracer::Registry {
+
+	// guards the list of buffers
+	std::mutex mutex_;
+
+	// buffer of every thread that recorded a span, kept after the thread ends
+	std::vector<std::unique_ptr<Buffer>> buffers_;
+
+	// time tracing was enabled, span times are measured from it
+	std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now();
+
+};
+
+// tracing is off until main asks for it
+std::atomic<bool> Tracer::enabled_(false);
+
+
+/** Tracer Class public methods */
+
+/** enable */
+void Tracer::enable(bool on) {
+
+	if (on) {
+		registry().epoch_ = std::chrono::steady_clock::now();
+	} // end if
+
+	enabled_.store(on, std::memory_order_relaxed);
+
+} // end of enable
+
+/** write */
+void Tracer::write(std::ostream& out) {
+
+	Registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex_);
+
+	out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+	bool first = true;
+
+	for (const std::unique_ptr<Buffer>& buffer : reg.buffers_) {
+
+		// name the thread's track
+		out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadId_
+			<< ",\"args\":{\"name\":\"thread " << buffer->threadId_ << "\"}}";
+		first = false;
+
+		for (const Event& event : buffer->events_) {
+
+			out << ",\n{\"name\":\"" << event.name_ << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId_ << ",\"ts\":";
+			writeMicroseconds(out, event.start_);
+			out << ",\"dur\":";
+			writeMicroseconds(out, event.duration_);
+
+			if (event.expression_ != 0) {
+				out << ",\"args\":{\"expression\":" << event.expression_ << "}";
+			} // end if
+
+			out << "}";
+
+		} // end for
+
+	} // end for
+
+	out << "\n]}" << std::endl;
+
+} // end of write
+
+/** Tracer Class private methods */
+
+/** registry */
+Tracer::Registry& Tracer::registry() {
+
+	// never destroyed, so threads that end after main can still find their buffers
+	static Registry* reg = new Registry();
+	return *reg;
+
+} // end of registry
+
+/** local */
+Tracer::Buffer& Tracer::local() {
+
+	thread_local Buffer* bufferPtr = nullptr;
+
+	if (bufferPtr == nullptr) {
+
+		Registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.mutex_);
+
+		reg.buffers_.push_back(std::make_unique<Buffer>());
+		bufferPtr = reg.buffers_.back().get();
+		bufferPtr->threadId_ = static_cast<std::uint32_t>(reg.buffers_.size());
+		bufferPtr->expression_ = 0;
+
+	} // end if
+
+	return *bufferPtr;
+
+} // end of local
+
+/** now */
+std::uint64_t Tracer::now() {
+
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now() - registry().epoch_).count());
+
+} // end of now
+
+
+/** Span Class  */
+
+/** begin */
+void Tracer::Span::begin(const char* name, int expression) {
+
+	name_ = name;
+
+	if (expression != 0) {
+		Buffer& buffer = local();
+		previousExpression_ = buffer.expression_;
+		buffer.expression_ = expression;
+		setsExpression_ = true;
+	} // end if
+
+	start_ = now();
+
+} // end of begin
+
+/** end */
+void Tracer::Span::end() {
+
+	std::uint64_t finish = now();
+	Buffer& buffer = local();
+
+	buffer.events_.push_back({ name_, start_, finish - start_, buffer.expression_ });
+
+	if (setsExpression_) {
+		buffer.expression_ = previousExpression_;
+	} // end if
+
+} // end of end
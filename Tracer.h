@@ -0,0 +1,180 @@
+/** @file Tracer.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements an opt in tracer that records when each
+   method of the calculator's pipeline ran on each thread and writes them
+   as a Chrome trace event file */
+
+#pragma once
+
+// included libraries
+#include <atomic>
+#include <vector>
+#include <iostream>
+#include <cstdint>
+
+
+/** Tracer Class
+ Every thread appends its spans to its own buffer, so recording takes no
+ lock and threads never wait for each other. A buffer is kept after its
+ thread ends and write reads the buffers of every thread once the work is
+ done, as complete events that chrome://tracing and Perfetto open. A span
+ started inside an expression line's span carries that line's expression
+ number. Until enable is called a Span costs a branch.*/
+class Tracer {
+
+public:
+
+   /** Span Class records the time from its construction to its destruction*/
+   class Span {
+
+   public:
+
+      /** Span constructor starts a span on the calling thread
+      @parm const char* [name] name of the method traced, must outlive the tracer*/
+      explicit Span(const char* name);
+
+      /** Span constructor starts the span of an expression line
+      @post spans started on this thread until this one ends carry the expression number
+      @parm const char* [name] name of the method traced, int [expression] number of the expression*/
+      Span(const char* name, int expression);
+
+      /** Span destructor appends the span to the thread's buffer*/
+      ~Span();
+
+      Span(const Span&) = delete;
+      Span& operator=(const Span&) = delete;
+
+   private:
+
+      // name of the span, nullptr if tracing was off when it started
+      const char* name_;
+
+      // when the span started, in nanoseconds since tracing was enabled
+      std::uint64_t start_;
+
+      // expression number of the enclosing line before this span, restored when it ends
+      int previousExpression_;
+
+      // true if this span set the expression number
+      bool setsExpression_;
+
+      /** begin starts recording the span
+      @parm const char* [name] name of the method traced, int [expression] number of the expression, 0 to keep the line's*/
+      void begin(const char* name, int expression);
+
+      /** end appends the span to the thread's buffer*/
+      void end();
+
+   }; // end of Span
+
+   /** Tracer public methods*/
+
+   /** enable starts tracing, before any thread records a span
+   @parm bool [on] true to record spans*/
+   static void enable(bool on);
+
+   /** enabled
+   @return true if spans are being recorded*/
+   static bool enabled();
+
+   /** write writes every span recorded as trace event JSON
+   @pre no thread is recording spans
+   @parm std::ostream [out] stream to write to*/
+   static void write(std::ostream& out);
+
+private:
+
+   /** Event Struct one recorded span*/
+   struct Event {
+
+      // name of the method
+      const char* name_;
+
+      // start in nanoseconds since tracing was enabled
+      std::uint64_t start_;
+
+      // length in nanoseconds
+      std::uint64_t duration_;
+
+      // expression number, 0 for none
+      int expression_;
+
+   };
+
+   /** Buffer Struct the spans of one thread*/
+   struct Buffer {
+
+      // spans in the order they ended
+      std::vector<Event> events_;
+
+      // thread number in the trace, from 1 in the order threads first record
+      std::uint32_t threadId_;
+
+      // expression number of the innermost line span running, 0 for none
+      int expression_;
+
+   };
+
+   /** Registry Struct the buffers of every thread that recorded*/
+   struct Registry;
+
+   /** Tracer Attributes*/
+
+   // true once enable turned tracing on
+   static std::atomic<bool> enabled_;
+
+   /** Tracer private methods*/
+
+   /** registry
+   @return the list of every thread's buffer*/
+   static Registry& registry();
+
+   /** local
+   @return the calling thread's buffer, registered the first time*/
+   static Buffer& local();
+
+   /** now
+   @return nanoseconds since tracing was enabled*/
+   static std::uint64_t now();
+
+}; // end of Tracer
+
+
+/** Tracer Class inline methods */
+
+/** enabled */
+inline bool Tracer::enabled() {
+
+   return enabled_.load(std::memory_order_relaxed);
+
+} // end of enabled
+
+/** Span constructor */
+inline Tracer::Span::Span(const char* name)
+   :name_(nullptr), start_(0), previousExpression_(0), setsExpression_(false) {
+
+   if (enabled()) {
+      begin(name, 0);
+   } // end if
+
+} // end constructor
+
+/** Span constructor */
+inline Tracer::Span::Span(const char* name, int expression)
+   :name_(nullptr), start_(0), previousExpression_(0), setsExpression_(false) {
+
+   if (enabled()) {
+      begin(name, expression);
+   } // end if
+
+} // end constructor
+
+/** Span destructor */
+inline Tracer::Span::~Span() {
+
+   if (name_ != nullptr) {
+      end();
+   } // end if
+
+} // end destructor
@@ -0,0 +1,471 @@
+/** @file VariableStore.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements the calculator's variable storage: each
+	variable's expression, a dependency graph between variables, and each
+	variable's cached substituted expression and value */
+
+#include "VariableStore.h"
+#include "LineArena.h"
+#include "Stats.h"
+
+#include <algorithm>
+
+
+/** VariableStore Class public methods */
+
+/** assign */
+bool VariableStore::assign(std::uint32_t symbol, const AST& expression, std::vector<std::uint32_t>& cycle) {
+
+	std::vector<std::uint32_t> references = expression.variables();
+
+	// refuse the expression if a variable it reads already depends on symbol
+	std::vector<std::uint32_t> path;
+	if (reaches(references, symbol, path)) {
+		cycle.assign(1, symbol);
+		cycle.insert(cycle.end(), path.begin(), path.end());
+		return false;
+	} // end if
+
+	std::uint32_t largest = symbol;
+	for (std::uint32_t reference : references) {
+		largest = std::max(largest, reference);
+	} // end for
+
+	if (largest >= entries_.size()) {
+		entries_.resize(largest + 1);
+	} // end if
+
+	invalidate(symbol);
+	setReferences(symbol, references);
+
+	Entry& entry = entries_[symbol];
+	entry.assigned_ = true;
+	entry.expression_ = expression;
+	entry.imageVariable_ = noImage;
+
+	return true;
+
+} // end of assign
+
+/** erase */
+void VariableStore::erase(std::uint32_t symbol) {
+
+	if (isAssigned(symbol)) {
+
+		invalidate(symbol);
+		setReferences(symbol, std::vector<std::uint32_t>());
+
+		// variables reading symbol keep their edges, it is now its own value
+		Entry& entry = entries_[symbol];
+		entry.assigned_ = false;
+		entry.expression_ = AST();
+		entry.imageVariable_ = noImage;
+
+	} // end if
+
+} // end of erase
+
+/** isAssigned */
+bool VariableStore::isAssigned(std::uint32_t symbol) const {
+
+	return symbol < entries_.size() && entries_[symbol].assigned_;
+
+} // end of isAssigned
+
+/** size */
+std::uint32_t VariableStore::size() const {
+
+	return static_cast<std::uint32_t>(entries_.size());
+
+} // end of size
+
+/** expression */
+const AST& VariableStore::expression(std::uint32_t symbol) {
+
+	Entry& entry = entries_[symbol];
+	copyOut(entry);
+
+	return entry.expression_;
+
+} // end of expression
+
+/** substituted */
+const AST* VariableStore::substituted(std::uint32_t symbol) {
+
+	Stats::add(Stats::Counter::storeLookups);
+
+	if (!isAssigned(symbol)) {
+		return nullptr;
+	} // end if
+
+	Entry& entry = entries_[symbol];
+
+	// the graph has no cycles, so this only recurses through the variables
+	// symbol reads that are not cached yet
+	if (!entry.substitutedValid_) {
+
+		// the same pass gives the value
+		copyOut(entry);
+		entry.closed_ = entry.expression_.partialEvaluate(*this, entry.substituted_, entry.value_, entry.status_, pool_);
+		entry.substitutedValid_ = true;
+		entry.valueValid_ = true;
+
+	} // end if
+
+	return &entry.substituted_;
+
+} // end of substituted
+
+/** value */
+bool VariableStore::value(std::uint32_t symbol, Integer& result, Program::Status& status) {
+
+	if (!isAssigned(symbol)) {
+		return false;
+	} // end if
+
+	Entry& entry = entries_[symbol];
+
+	// a value loaded from an image is valid before its substituted expression is built
+	if (!entry.valueValid_) {
+		substituted(symbol);
+	} // end if
+
+	result = entry.value_;
+	status = entry.status_;
+
+	return entry.closed_;
+
+} // end of value
+
+/** partialEvaluate */
+bool VariableStore::partialEvaluate(const AST& expression, AST& residual, Integer& value, Program::Status& status) {
+
+	return expression.partialEvaluate(*this, residual, value, status, pool_);
+
+} // end of partialEvaluate
+
+/** memoryBytes */
+std::size_t VariableStore::memoryBytes() const {
+
+	std::size_t bytes = entries_.capacity() * sizeof(Entry);
+
+	for (const Entry& entry : entries_) {
+		bytes += (entry.references_.capacity() + entry.dependents_.capacity()) * sizeof(std::uint32_t);
+	} // end for
+
+	return bytes;
+
+} // end of memoryBytes
+
+/** save */
+bool VariableStore::save(const std::string& fileName, std::string& error) {
+
+	StoreImage::Writer writer;
+
+	// index in the image of each symbol id, a name is added the first time it is used
+	std::vector<std::uint32_t> imageIndex;
+	auto indexOf = [&](std::uint32_t symbol) {
+		if (symbol >= imageIndex.size()) {
+			imageIndex.resize(symbol + 1, noImage);
+		} // end if
+		if (imageIndex[symbol] == noImage) {
+			imageIndex[symbol] = writer.addSymbol(Token::symbolName(symbol));
+		} // end if
+		return imageIndex[symbol];
+	};
+
+	for (std::uint32_t symbol = 0; symbol < size(); ++symbol) {
+
+		if (!isAssigned(symbol)) {
+			continue;
+		} // end if
+
+		// the image holds every value, so a store loaded from it calculates nothing
+		Integer result;
+		Program::Status status = Program::Status::ok;
+		bool closed = value(symbol, result, status);
+		Entry& entry = entries_[symbol];
+
+		if (entry.imageVariable_ != noImage) {
+
+			// an expression still only in the loaded image is copied node for node
+			const StoreImage::Variable& source = image_->variable(entry.imageVariable_);
+			const StoreImage::Node* nodes = image_->nodes(source);
+
+			for (std::uint32_t i = 0; i < source.nodeCount_; ++i) {
+				StoreImage::Node node = nodes[i];
+				if (static_cast<TokType>(node.type_) == TokType::variable) {
+					node.payload_ = indexOf(imageSymbols_[static_cast<std::size_t>(node.payload_)]);
+				}
+				else if (node.bigNumber_ != 0) {
+					node.payload_ = writer.addBig(image_->big(static_cast<std::uint32_t>(node.payload_)));
+				} // end if
+				writer.addNode(node);
+			} // end for
+
+		}
+		else {
+
+			for (const AST::Entry& flat : entry.expression_.flatten()) {
+
+				StoreImage::Node node = {};
+				node.type_ = static_cast<std::uint8_t>(flat.tok_.getType());
+				node.op_ = static_cast<std::uint8_t>(flat.tok_.getOp());
+				node.left_ = flat.left_;
+				node.right_ = flat.right_;
+
+				if (flat.tok_.getType() == TokType::variable) {
+					node.payload_ = indexOf(flat.tok_.getSymbol());
+				}
+				else if (flat.tok_.isBigNumber()) {
+					node.bigNumber_ = 1;
+					node.payload_ = writer.addBig(flat.tok_.getInteger());
+				}
+				else {
+					node.payload_ = flat.tok_.getNumber();
+				} // end if
+
+				writer.addNode(node);
+
+			} // end for
+
+		} // end if
+
+		for (std::uint32_t reference : entry.references_) {
+			writer.addReference(indexOf(reference));
+		} // end for
+
+		StoreImage::Variable record = {};
+		record.symbol_ = indexOf(symbol);
+		record.closed_ = closed ? 1 : 0;
+		record.status_ = static_cast<std::uint8_t>(status);
+
+		if (closed && result.isSmall()) {
+			record.value_ = result.getSmall();
+		}
+		else if (closed) {
+			record.bigValue_ = 1;
+			record.value_ = writer.addBig(result);
+		} // end if
+
+		writer.addVariable(record);
+
+	} // end for
+
+	return writer.write(fileName, error);
+
+} // end of save
+
+/** load */
+bool VariableStore::load(const std::string& fileName, std::string& error) {
+
+	std::shared_ptr<const StoreImage> image = StoreImage::open(fileName, error);
+
+	if (image == nullptr) {
+		return false;
+	} // end if
+
+	const StoreImage::Header& header = image->header();
+
+	// the image's names are interned on this thread once, its nodes are not read
+	std::vector<std::uint32_t> symbols(header.symbolCount_);
+	std::uint32_t largest = 0;
+
+	for (std::uint32_t i = 0; i < header.symbolCount_; ++i) {
+		symbols[i] = Token::internSymbol(image->symbol(i));
+		largest = std::max(largest, symbols[i]);
+	} // end for
+
+	// the previous variables are dropped with their nodes
+	entries_.clear();
+	entries_.resize((header.symbolCount_ != 0) ? largest + 1 : 0);
+	image_ = image;
+	imageSymbols_ = std::move(symbols);
+
+	std::vector<std::uint32_t> references;
+
+	for (std::uint32_t index = 0; index < header.variableCount_; ++index) {
+
+		const StoreImage::Variable& record = image->variable(index);
+		std::uint32_t symbol = imageSymbols_[record.symbol_];
+		Entry& entry = entries_[symbol];
+
+		// a variable written twice keeps its first record
+		if (entry.assigned_) {
+			continue;
+		} // end if
+
+		entry.assigned_ = true;
+		entry.imageVariable_ = index;
+		entry.valueValid_ = true;
+		entry.closed_ = (record.closed_ != 0);
+		entry.status_ = static_cast<Program::Status>(record.status_);
+		entry.value_ = (record.bigValue_ != 0) ? image->big(static_cast<std::uint32_t>(record.value_)) : Integer(record.value_);
+
+		const std::uint32_t* imageReferences = image->references(record);
+		references.clear();
+
+		for (std::uint32_t i = 0; i < record.referenceCount_; ++i) {
+			references.push_back(imageSymbols_[imageReferences[i]]);
+		} // end for
+
+		setReferences(symbol, references);
+
+	} // end for
+
+	return true;
+
+} // end of load
+
+/** setPool */
+void VariableStore::setPool(WorkStealingPool* pool) {
+
+	pool_ = pool;
+
+} // end of setPool
+
+/** VariableStore Class private methods */
+
+/** reaches */
+bool VariableStore::reaches(const std::vector<std::uint32_t>& from, std::uint32_t to, std::vector<std::uint32_t>& path) const {
+
+	// a variable that was never assigned has no edges
+	std::uint32_t count = std::max(size(), to + 1);
+	for (std::uint32_t start : from) {
+		count = std::max(count, start + 1);
+	} // end for
+
+	// the variable each visited one was reached from, count while unvisited
+	std::pmr::vector<std::uint32_t> parent(count, count, LineArena::resource());
+	std::pmr::vector<std::uint32_t> toVisit(LineArena::resource());
+
+	for (std::uint32_t start : from) {
+		if (parent[start] == count) {
+			parent[start] = start;
+			toVisit.push_back(start);
+		} // end if
+	} // end for
+
+	while (!toVisit.empty()) {
+
+		std::uint32_t cur = toVisit.back();
+		toVisit.pop_back();
+
+		if (cur == to) {
+
+			// walk back to the start variable
+			path.clear();
+			for (std::uint32_t step = cur; ; step = parent[step]) {
+				path.push_back(step);
+				if (parent[step] == step) {
+					break;
+				} // end if
+			} // end for
+			std::reverse(path.begin(), path.end());
+
+			return true;
+		} // end if
+
+		if (cur < entries_.size()) {
+			for (std::uint32_t next : entries_[cur].references_) {
+				if (parent[next] == count) {
+					parent[next] = cur;
+					toVisit.push_back(next);
+				} // end if
+			} // end for
+		} // end if
+
+	} // end while
+
+	return false;
+
+} // end of reaches
+
+/** invalidate */
+void VariableStore::invalidate(std::uint32_t symbol) {
+
+	if (symbol >= entries_.size()) {
+		return;
+	} // end if
+
+	std::pmr::vector<std::uint32_t> toVisit(1, symbol, LineArena::resource());
+	bool first = true;
+
+	while (!toVisit.empty()) {
+
+		std::uint32_t cur = toVisit.back();
+		toVisit.pop_back();
+
+		Entry& entry = entries_[cur];
+
+		// a cached form is only built from cached forms, so the dependents of
+		// a variable that is not cached are not cached either, a value loaded
+		// from an image counts as cached
+		if (!first && !entry.substitutedValid_ && !entry.valueValid_) {
+			continue;
+		} // end if
+		first = false;
+
+		entry.substitutedValid_ = false;
+		entry.valueValid_ = false;
+		entry.substituted_ = AST();
+
+		toVisit.insert(toVisit.end(), entry.dependents_.begin(), entry.dependents_.end());
+
+	} // end while
+
+} // end of invalidate
+
+/** copyOut */
+void VariableStore::copyOut(Entry& entry) {
+
+	if (entry.imageVariable_ == noImage) {
+		return;
+	} // end if
+
+	const StoreImage::Variable& record = image_->variable(entry.imageVariable_);
+	const StoreImage::Node* nodes = image_->nodes(record);
+
+	// the image's nodes become tokens of this thread, then nodes shared with every live tree
+	std::pmr::vector<AST::Entry> flat(LineArena::resource());
+	flat.reserve(record.nodeCount_);
+
+	for (std::uint32_t i = 0; i < record.nodeCount_; ++i) {
+
+		const StoreImage::Node& node = nodes[i];
+		Token tok(static_cast<TokType>(node.type_), static_cast<OpCode>(node.op_), node.payload_);
+
+		if (tok.getType() == TokType::variable) {
+			tok.setSymbol(imageSymbols_[static_cast<std::size_t>(node.payload_)]);
+		}
+		else if (node.bigNumber_ != 0) {
+			tok.setInteger(image_->big(static_cast<std::uint32_t>(node.payload_)));
+		} // end if
+
+		flat.push_back({ tok, node.left_, node.right_ });
+
+	} // end for
+
+	entry.expression_ = AST::fromEntries(flat.data(), flat.size());
+	entry.imageVariable_ = noImage;
+
+} // end of copyOut
+
+/** setReferences */
+void VariableStore::setReferences(std::uint32_t symbol, const std::vector<std::uint32_t>& references) {
+
+	Entry& entry = entries_[symbol];
+
+	for (std::uint32_t reference : entry.references_) {
+		std::vector<std::uint32_t>& dependents = entries_[reference].dependents_;
+		dependents.erase(std::find(dependents.begin(), dependents.end(), symbol));
+	} // end for
+
+	for (std::uint32_t reference : references) {
+		entries_[reference].dependents_.push_back(symbol);
+	} // end for
+
+	entry.references_ = references;
+
+} // end of setReferences
@@ -0,0 +1,179 @@
+/** @file VariableStore.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements the calculator's variable storage: each
+   variable's expression, a dependency graph between variables, and each
+   variable's cached substituted expression and value */
+
+#pragma once
+
+// included classes
+#include "AST.h"
+#include "Integer.h"
+#include "Program.h"
+#include "StoreImage.h"
+
+// included libraries
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+
+/** VariableStore Class
+ Assigning a variable only invalidates the cached forms of the variables
+ that transitively depend on it, and an assignment that would make a
+ variable depend on itself is refused. A store loaded from an image keeps
+ the image mapped: each variable's cached value and edges are read from it
+ at once, but its expression is only copied out of the image into nodes
+ the first time it is needed, and never if the variable is reassigned first.*/
+class VariableStore {
+
+public:
+
+   /** VariableStore constructor*/
+   VariableStore() = default;
+
+   /** VariableStore public methods*/
+
+   /** assign stores an expression for a variable
+   @post on success the variable's dependents are invalidated, on failure the store is unchanged
+   @parm std::uint32_t [symbol] variable's symbol id, AST [expression] expression as entered,
+   std::vector<std::uint32_t> [cycle] set to the variables around the cycle, starting and ending with symbol
+   @return false if the expression refers back to the variable*/
+   bool assign(std::uint32_t symbol, const AST& expression, std::vector<std::uint32_t>& cycle);
+
+   /** erase removes a variable's expression so it is its own value again
+   @post the variable's dependents are invalidated
+   @parm std::uint32_t [symbol] variable's symbol id*/
+   void erase(std::uint32_t symbol);
+
+   /** isAssigned
+   @parm std::uint32_t [symbol] variable's symbol id
+   @return true if the variable has an expression*/
+   bool isAssigned(std::uint32_t symbol) const;
+
+   /** size
+   @return one past the largest symbol id that was ever assigned*/
+   std::uint32_t size() const;
+
+   /** expression
+   @pre isAssigned(symbol)
+   @return the variable's expression as entered, copied out of a loaded image if it is still there*/
+   const AST& expression(std::uint32_t symbol);
+
+   /** substituted the variable's expression with every assigned variable replaced and every closed subtree
+   folded to its value, cached until invalidated along with the value
+   @parm std::uint32_t [symbol] variable's symbol id
+   @return the substituted expression, nullptr if the variable is not assigned*/
+   const AST* substituted(std::uint32_t symbol);
+
+   /** value the variable's value, cached until invalidated
+   @parm std::uint32_t [symbol] variable's symbol id, Integer [result] the value, Program::Status [status] ok or why there is no value
+   @return false if the substituted expression still has a variable*/
+   bool value(std::uint32_t symbol, Integer& result, Program::Status& status);
+
+   /** partialEvaluate replaces every assigned variable in an expression with its cached value or substituted
+   expression and folds every closed subtree, see AST::partialEvaluate
+   @parm AST [expression] expression to evaluate, AST [residual] expression left, Integer [value] value when
+   no variable is left, Program::Status [status] ok or why a closed expression has no value
+   @return true if no variable is left*/
+   bool partialEvaluate(const AST& expression, AST& residual, Integer& value, Program::Status& status);
+
+   /** memoryBytes
+   @return the bytes of the store's own arrays, the expressions' nodes are counted by the node pool*/
+   std::size_t memoryBytes() const;
+
+   /** save writes every assigned variable's expression, edges and value as an image
+   @parm std::string [fileName] file to write, std::string [error] why the file was not written
+   @return true if the file was written*/
+   bool save(const std::string& fileName, std::string& error);
+
+   /** load replaces the store with the variables of an image
+   @post on failure the store is unchanged
+   @parm std::string [fileName] image to map, std::string [error] why the image was not loaded
+   @return true if the image was loaded*/
+   bool load(const std::string& fileName, std::string& error);
+
+   /** setPool sets the workers value splits a large substituted expression across
+   @parm WorkStealingPool* [pool] workers, or nullptr to always calculate on the calling thread*/
+   void setPool(WorkStealingPool* pool);
+
+private:
+
+   // imageVariable_ of a variable whose expression is in expression_
+   static constexpr std::uint32_t noImage = UINT32_MAX;
+
+   /** Entry Struct */
+   struct Entry {
+
+      // true while the variable has an expression
+      bool assigned_ = false;
+
+      // expression as entered
+      AST expression_;
+
+      // variables the expression reads
+      std::vector<std::uint32_t> references_;
+
+      // variables whose expressions read this one
+      std::vector<std::uint32_t> dependents_;
+
+      // true while substituted_ is up to date
+      bool substitutedValid_ = false;
+
+      // expression with every assigned variable replaced and closed subtrees folded
+      AST substituted_;
+
+      // true while closed_, value_ and status_ are up to date
+      bool valueValid_ = false;
+
+      // true if substituted_ has no variables
+      bool closed_ = false;
+
+      // value of substituted_ when closed
+      Integer value_;
+
+      // ok or why there is no value
+      Program::Status status_ = Program::Status::ok;
+
+      // index of the variable in image_ while its expression is still only there, noImage otherwise
+      std::uint32_t imageVariable_ = noImage;
+
+   };
+
+   /** VariableStore Attributes*/
+
+   // entries indexed by symbol id
+   std::vector<Entry> entries_;
+
+   // workers for calculating large values, nullptr for none
+   WorkStealingPool* pool_ = nullptr;
+
+   // image the store was loaded from, kept mapped while an expression is still only there
+   std::shared_ptr<const StoreImage> image_;
+
+   // symbol id on this thread of each symbol of image_
+   std::vector<std::uint32_t> imageSymbols_;
+
+   /** VariableStore private methods*/
+
+   /** reaches searches the reference edges from several variables at once
+   @parm std::vector<std::uint32_t> [from] start variables, std::uint32_t [to] variable to find,
+   std::vector<std::uint32_t> [path] set to the variables from a start variable to to
+   @return true if any start variable reaches to, every edge is followed at most once*/
+   bool reaches(const std::vector<std::uint32_t>& from, std::uint32_t to, std::vector<std::uint32_t>& path) const;
+
+   /** invalidate clears the cached forms of a variable and everything depending on it
+   @parm std::uint32_t [symbol] variable's symbol id*/
+   void invalidate(std::uint32_t symbol);
+
+   /** copyOut builds a variable's expression from image_ if it is still only there
+   @parm Entry [entry] entry of the variable*/
+   void copyOut(Entry& entry);
+
+   /** setReferences replaces a variable's outgoing edges
+   @parm std::uint32_t [symbol] variable's symbol id, std::vector<std::uint32_t> [references] variables it now reads*/
+   void setReferences(std::uint32_t symbol, const std::vector<std::uint32_t>& references);
+
+}; // end of VariableStore
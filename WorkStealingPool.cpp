@@ -0,0 +1,185 @@
+/** @file WorkStealingPool.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This implementation file implements a fixed pool of worker threads that run
+	a batch of independent tasks, balancing them by work stealing */
+
+#include "WorkStealingPool.h"
+
+
+/** WorkStealingPool Class public methods */
+
+/** WorkStealingPool constructor */
+WorkStealingPool::WorkStealingPool(std::size_t threadCount)
+	:generation_(0), stopping_(false), task_(nullptr), remaining_(0), steals_(0) {
+
+	if (threadCount == 0) {
+		threadCount = std::thread::hardware_concurrency();
+	} // end if
+
+	if (threadCount == 0) {
+		threadCount = 1;
+	} // end if
+
+	for (std::size_t i = 0; i < threadCount; ++i) {
+		workers_.push_back(std::make_unique<Worker>());
+	} // end for
+
+	for (std::size_t i = 0; i < threadCount; ++i) {
+		threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+	} // end for
+
+} // end constructor
+
+/** WorkStealingPool destructor */
+WorkStealingPool::~WorkStealingPool() {
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex_);
+		stopping_ = true;
+	}
+	wake_.notify_all();
+
+	for (std::thread& thread : threads_) {
+		thread.join();
+	} // end for
+
+} // end destructor
+
+/** run */
+void WorkStealingPool::run(std::size_t taskCount, const std::function<void(std::size_t, std::size_t)>& task) {
+
+	if (taskCount == 0) {
+		return;
+	} // end if
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex_);
+		task_ = &task;
+		error_ = nullptr;
+		remaining_ = taskCount;
+	}
+
+	// each worker starts with a contiguous share, so tasks run roughly in order
+	std::size_t workerCount = workers_.size();
+
+	for (std::size_t w = 0; w < workerCount; ++w) {
+
+		std::lock_guard<std::mutex> lock(workers_[w]->mutex_);
+		for (std::size_t i = w * taskCount / workerCount; i < (w + 1) * taskCount / workerCount; ++i) {
+			workers_[w]->tasks_.push_back(i);
+		} // end for
+
+	} // end for
+
+	{
+		std::lock_guard<std::mutex> lock(stateMutex_);
+		++generation_;
+	}
+	wake_.notify_all();
+
+	std::unique_lock<std::mutex> lock(stateMutex_);
+	done_.wait(lock, [this] { return remaining_.load() == 0; });
+
+	if (error_) {
+		std::exception_ptr error = error_;
+		error_ = nullptr;
+		std::rethrow_exception(error);
+	} // end if
+
+} // end of run
+
+/** size */
+std::size_t WorkStealingPool::size() const {
+
+	return workers_.size();
+
+} // end of size
+
+/** steals */
+std::uint64_t WorkStealingPool::steals() const {
+
+	return steals_.load();
+
+} // end of steals
+
+/** WorkStealingPool Class private methods */
+
+/** workerLoop */
+void WorkStealingPool::workerLoop(std::size_t self) {
+
+	std::uint64_t seenGeneration = 0;
+
+	while (true) {
+
+		{
+			std::unique_lock<std::mutex> lock(stateMutex_);
+			wake_.wait(lock, [&] { return stopping_ || generation_ != seenGeneration; });
+
+			if (stopping_) {
+				return;
+			} // end if
+
+			seenGeneration = generation_;
+		}
+
+		std::size_t index = 0;
+
+		while (takeTask(self, index)) {
+
+			try {
+				(*task_)(index, self);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> lock(stateMutex_);
+				if (!error_) {
+					error_ = std::current_exception();
+				} // end if
+			} // end try
+
+			// the last task wakes run
+			if (remaining_.fetch_sub(1) == 1) {
+				std::lock_guard<std::mutex> lock(stateMutex_);
+				done_.notify_all();
+			} // end if
+
+		} // end while
+
+	} // end while
+
+} // end of workerLoop
+
+/** takeTask */
+bool WorkStealingPool::takeTask(std::size_t self, std::size_t& index) {
+
+	{
+		Worker& own = *workers_[self];
+		std::lock_guard<std::mutex> lock(own.mutex_);
+
+		if (!own.tasks_.empty()) {
+			index = own.tasks_.front();
+			own.tasks_.pop_front();
+			return true;
+		} // end if
+	}
+
+	// steal the task its owner would reach last
+	std::size_t workerCount = workers_.size();
+
+	for (std::size_t k = 1; k < workerCount; ++k) {
+
+		Worker& victim = *workers_[(self + k) % workerCount];
+		std::lock_guard<std::mutex> lock(victim.mutex_);
+
+		if (!victim.tasks_.empty()) {
+			index = victim.tasks_.back();
+			victim.tasks_.pop_back();
+			++steals_;
+			return true;
+		} // end if
+
+	} // end for
+
+	return false;
+
+} // end of takeTask
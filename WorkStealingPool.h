@@ -0,0 +1,116 @@
+/** @file WorkStealingPool.h
+ @author Anthony Campos
+ @date 12/07/2021
+ This header class file implements a fixed pool of worker threads that run
+   a batch of independent tasks, balancing them by work stealing */
+
+#pragma once
+
+// included libraries
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <cstdint>
+
+
+/** WorkStealingPool Class
+ Each worker owns a deque of task indices, seeded with a contiguous share of
+ the batch. A worker takes tasks from the front of its own deque, in order,
+ and when it runs dry steals from the back of another worker's deque, so
+ a worker stuck on one long task never leaves the others idle.*/
+class WorkStealingPool {
+
+public:
+
+   /** WorkStealingPool constructor starts the workers
+   @parm std::size_t [threadCount] number of workers, 0 for one per core*/
+   explicit WorkStealingPool(std::size_t threadCount = 0);
+
+   /** WorkStealingPool destructor stops and joins the workers*/
+   ~WorkStealingPool();
+
+   WorkStealingPool(const WorkStealingPool&) = delete;
+   WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+   /** WorkStealingPool public methods*/
+
+   /** run calls task(index, worker) once for every index below taskCount and waits for all of them
+   @post every task has run, an exception thrown by a task is rethrown once all have stopped
+   @parm std::size_t [taskCount] number of tasks, std::function [task] task to run by index,
+   given the index of the worker running it*/
+   void run(std::size_t taskCount, const std::function<void(std::size_t, std::size_t)>& task);
+
+   /** size
+   @return the number of workers*/
+   std::size_t size() const;
+
+   /** steals
+   @return the number of tasks taken from another worker's deque so far*/
+   std::uint64_t steals() const;
+
+private:
+
+   /** Worker Struct a worker's own task deque*/
+   struct Worker {
+
+      // guards tasks_
+      std::mutex mutex_;
+
+      // indices of the tasks not yet taken
+      std::deque<std::size_t> tasks_;
+
+   }; // end of Worker
+
+   /** WorkStealingPool Attributes*/
+
+   // task deques, one per worker
+   std::vector<std::unique_ptr<Worker>> workers_;
+
+   // worker threads
+   std::vector<std::thread> threads_;
+
+   // guards generation_, stopping_ and error_
+   std::mutex stateMutex_;
+
+   // wakes the workers for a new batch or to stop
+   std::condition_variable wake_;
+
+   // wakes run when the last task is done
+   std::condition_variable done_;
+
+   // incremented for every batch
+   std::uint64_t generation_;
+
+   // true once the destructor runs
+   bool stopping_;
+
+   // task of the current batch
+   const std::function<void(std::size_t, std::size_t)>* task_;
+
+   // tasks of the current batch not yet finished
+   std::atomic<std::size_t> remaining_;
+
+   // tasks stolen so far
+   std::atomic<std::uint64_t> steals_;
+
+   // first exception thrown by a task of the current batch
+   std::exception_ptr error_;
+
+   /** WorkStealingPool private methods*/
+
+   /** workerLoop runs batches on a worker thread until the pool stops
+   @parm std::size_t [self] index of the worker*/
+   void workerLoop(std::size_t self);
+
+   /** takeTask takes the next task of a worker's own deque, or steals one from another worker
+   @parm std::size_t [self] index of the worker, std::size_t [index] task taken
+   @return false once every deque is empty*/
+   bool takeTask(std::size_t self, std::size_t& index);
+
+}; // end of WorkStealingPool
@@ -1,22 +1,357 @@
 //classes to include
 #include "Calculator.h"
+#include "SessionRunner.h"
+#include "Stats.h"
+#include "Tracer.h"
 
 #include<iostream>
-#include<cmath>
+#include<fstream>
+#include<cstring>
+#include<cctype>
+#include<cstdlib>
+#include<sstream>
+#include<memory>
 
 
-int main() {
+/** readColumn reads whitespace separated integers from a file
+@parm std::string [fileName] file to read, std::vector<std::int64_t> [column] values read
+@return true if the file was read*/
+bool readColumn(const std::string& fileName, std::vector<std::int64_t>& column) {
+
+	std::ifstream columnFile(fileName);
+	std::int64_t value = 0;
+
+	while (columnFile >> value) {
+		column.push_back(value);
+	} // end while
+
+	return columnFile.eof();
+
+} // end readColumn
+
+/** writeTrace writes the spans the tracer recorded
+@parm std::string [fileName] file to write
+@return true if the file was written*/
+bool writeTrace(const std::string& fileName) {
+
+	std::ofstream traceFile(fileName);
+	if (!traceFile) {
+		std::cerr << "Could not write " << fileName << std::endl;
+		return false;
+	} // end if
+
+	Tracer::write(traceFile);
+	return true;
+
+} // end writeTrace
+
+
+int main(int argc, char* argv[]) {
+
+	// cin is not shared with stdio, so the lexer can take whole blocks of
+	// input that are already available instead of a character at a time
+	std::ios::sync_with_stdio(false);
 
 	//create calculator object
 	Calculator calc;
-	//begin use of the calculator by calling echo
-	calc.echo(std::cin);
 
+	// batch mode: --batch <expression> --bind <variable>=<file> ... [--out <file>]
+	std::string batchExpression;
+	std::string outFileName;
+	std::map<std::uint32_t, std::vector<std::int64_t>> columns;
+
+	// session mode: --sessions <manifest> | --session-file <file> ... [--threads <n>] [--out-dir <dir>] [--report <file>]
+	SessionRunner sessions;
+	bool sessionMode = false;
+	std::size_t threadCount = 0;
+	std::string outputDir;
+	std::string reportFileName;
+	std::string error;
+
+	// parallel mode: --parallel [--threads <n>], the script on cin is read whole and
+	// the lines that only read variables are evaluated on worker threads
+	bool parallelMode = false;
+
+	// --stats times each stage of every line and prints the totals to cerr at exit
+	bool statsMode = false;
+
+	// --latency <file> [--slowest <n>] writes percentiles of the time of each expression
+	// line and the n slowest lines as JSON at exit
+	std::string latencyFileName;
+	std::size_t slowestCount = 10;
+
+	// --trace <file> records when each method of every line ran on each thread and
+	// writes them at exit as trace event JSON for chrome://tracing or Perfetto
+	std::string traceFileName;
+
+	// --format <text|json|binary> writes each line's record as text, JSON lines or binary records
+	std::string formatName = "text";
+
+	// --snapshot <file> starts from the variables of an image written by :save
+	std::string snapshotFileName;
+
+	// --journal <file> [--journal-group <n>] [--journal-compact <bytes>] restores the variables
+	// from a journal and appends every accepted assignment to it, syncing once per group of n
+	// records and saving the store as the journal's image once the records reach the bytes given
+	std::string journalFileName;
+	std::size_t journalGroup = Journal::defaultGroupSize;
+	std::uint64_t journalCompact = Journal::defaultCompactBytes;
+
+	// --parse-cache <lines> keeps the parse of the last lines seen, so a repeated line is not parsed again
+	std::size_t parseCacheLines = 0;
+
+	for (int i = 1; i < argc; ++i) {
+
+		if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+			batchExpression = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--bind") == 0 && i + 1 < argc) {
+
+			std::string binding = argv[++i];
+			if (binding.size() < 3 || !isalpha(static_cast<unsigned char>(binding[0])) || binding[1] != '=') {
+				std::cerr << "Usage: --bind <variable>=<file>" << std::endl;
+				return 1;
+			} // end if
+
+			std::uint32_t symbol = static_cast<std::uint32_t>(tolower(static_cast<unsigned char>(binding[0])) - 'a');
+			if (!readColumn(binding.substr(2), columns[symbol])) {
+				std::cerr << "Could not read " << binding.substr(2) << std::endl;
+				return 1;
+			} // end if
+
+		}
+		else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+			outFileName = argv[++i];
+		}
+		else if ((std::strcmp(argv[i], "--sessions") == 0 || std::strcmp(argv[i], "--session-file") == 0) && i + 1 < argc) {
+
+			bool manifest = (std::strcmp(argv[i], "--sessions") == 0);
+			if (!(manifest ? sessions.addManifest(argv[i + 1], error) : sessions.addSessionFile(argv[i + 1], error))) {
+				std::cerr << error << std::endl;
+				return 1;
+			} // end if
+
+			sessionMode = true;
+			++i;
+
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threadCount = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--out-dir") == 0 && i + 1 < argc) {
+			outputDir = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--report") == 0 && i + 1 < argc) {
+			reportFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--parallel") == 0) {
+			parallelMode = true;
+		}
+		else if (std::strcmp(argv[i], "--stats") == 0) {
+			statsMode = true;
+		}
+		else if (std::strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+			latencyFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--slowest") == 0 && i + 1 < argc) {
+			slowestCount = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+			traceFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			formatName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+			snapshotFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+			journalFileName = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--journal-group") == 0 && i + 1 < argc) {
+			journalGroup = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--journal-compact") == 0 && i + 1 < argc) {
+			journalCompact = std::strtoull(argv[++i], nullptr, 10);
+		}
+		else if (std::strcmp(argv[i], "--parse-cache") == 0 && i + 1 < argc) {
+			parseCacheLines = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else {
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return 1;
+		} // end if
+
+	} // end for
+
+	Stats::enable(statsMode);
+	Tracer::enable(!traceFileName.empty());
+
+	// only lines echoed one at a time are timed
+	if (!latencyFileName.empty() && (sessionMode || parallelMode)) {
+		std::cerr << "--latency times lines run one at a time, it cannot be used with --sessions, --session-file or --parallel" << std::endl;
+		return 1;
+	} // end if
+
+	// sessions are merged as text
+	if (formatName != "text" && sessionMode) {
+		std::cerr << "--format cannot be used with --sessions or --session-file, sessions are written as text" << std::endl;
+		return 1;
+	} // end if
+
+	// every session starts empty, a session script can :load an image itself
+	if (!snapshotFileName.empty() && sessionMode) {
+		std::cerr << "--snapshot cannot be used with --sessions or --session-file, use :load in the scripts" << std::endl;
+		return 1;
+	} // end if
+
+	// the journal restores its own image
+	if (!journalFileName.empty() && (sessionMode || !snapshotFileName.empty())) {
+		std::cerr << "--journal cannot be used with --sessions, --session-file or --snapshot" << std::endl;
+		return 1;
+	} // end if
+
+	// every session parses with its own calculator
+	if (parseCacheLines != 0 && sessionMode) {
+		std::cerr << "--parse-cache cannot be used with --sessions or --session-file" << std::endl;
+		return 1;
+	} // end if
+
+	if (!snapshotFileName.empty() && !calc.load(snapshotFileName, error)) {
+		std::cerr << error << std::endl;
+		return 1;
+	} // end if
+
+	std::unique_ptr<Journal> journal;
+	if (!journalFileName.empty()) {
+
+		journal = std::make_unique<Journal>(journalFileName, journalGroup, journalCompact);
+		if (!calc.setJournal(journal.get(), error)) {
+			std::cerr << error << std::endl;
+			return 1;
+		} // end if
+
+	} // end if
+
+	// declared after the calculator, so it is destroyed first, on the thread its trees were built on
+	std::unique_ptr<ParseCache> parseCache;
+	if (parseCacheLines != 0) {
+		parseCache = std::make_unique<ParseCache>(parseCacheLines);
+		calc.setParseCache(parseCache.get());
+	} // end if
+
+	std::unique_ptr<ResultSink> sink = ResultSink::make(formatName, std::cout);
+	if (sink == nullptr) {
+		std::cerr << "Unknown format " << formatName << ", use text, json or binary" << std::endl;
+		return 1;
+	} // end if
+
+	LatencyRecorder latency(slowestCount);
+	if (!latencyFileName.empty()) {
+		calc.setLatency(&latency);
+	} // end if
+
+	// every session runs with its own calculator, cin is not read
+	if (sessionMode) {
+
+		WorkStealingPool pool(threadCount);
+		std::size_t failures = sessions.run(pool, std::cout, outputDir);
+
+		if (!reportFileName.empty()) {
+			std::ofstream reportFile(reportFileName);
+			sessions.reportSessions(reportFile);
+			sessions.reportTotals(reportFile);
+		} // end if
+
+		sessions.reportTotals(std::cerr);
+
+		if (statsMode) {
+			Stats::report(std::cerr);
+		} // end if
+
+		if (!traceFileName.empty() && !writeTrace(traceFileName)) {
+			return 1;
+		} // end if
+
+		if (failures != 0) {
+			std::cerr << failures << " sessions could not be opened" << std::endl;
+			return 1;
+		} // end if
+
+		return 0;
+
+	} // end if
+
+	//begin use of the calculator by calling echo, in batch mode
+	//this defines the variables the batch expression uses
+	// with --threads or --parallel, results with very large trees are calculated on a pool
+	std::unique_ptr<WorkStealingPool> pool;
+	if (parallelMode || threadCount != 0) {
+		pool = std::make_unique<WorkStealingPool>(threadCount);
+		calc.setPool(pool.get());
+	} // end if
+
+	if (parallelMode) {
+
+		std::ostringstream scriptBuffer;
+		scriptBuffer << std::cin.rdbuf();
+		std::string script = scriptBuffer.str();
+		calc.echo(script, *pool, *sink);
+
+	}
+	else {
+		calc.echo(std::cin, *sink);
+	} // end if
+
+	// the script's output goes before the batch results
+	sink->flush();
+
+	if (journal != nullptr && journal->failed()) {
+		std::cerr << journal->error() << ", Assignments Since Were Not Journaled" << std::endl;
+		return 1;
+	} // end if
+
+	if (!batchExpression.empty()) {
+
+		std::vector<std::int64_t> results;
+
+		if (!calc.evaluateBatch(batchExpression, columns, results, error)) {
+			std::cerr << error << std::endl;
+			return 1;
+		} // end if
+
+		std::ofstream outFile;
+		if (!outFileName.empty()) {
+			outFile.open(outFileName);
+		} // end if
+		std::ostream& out = outFile.is_open() ? outFile : std::cout;
+
+		for (std::int64_t value : results) {
+			out << value << '\n';
+		} // end for
+
+	} // end if
+
+	if (!latencyFileName.empty()) {
 
+		std::ofstream latencyFile(latencyFileName);
+		if (!latencyFile) {
+			std::cerr << "Could not write " << latencyFileName << std::endl;
+			return 1;
+		} // end if
 
+		latency.writeJson(latencyFile);
 
+	} // end if
 
+	if (statsMode) {
+		Stats::report(std::cerr);
+	} // end if
 
+	if (!traceFileName.empty() && !writeTrace(traceFileName)) {
+		return 1;
+	} // end if
 
+	return 0;
 
-} // end main
\ No newline at end of file
+} // end main
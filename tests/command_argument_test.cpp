@@ -0,0 +1,90 @@
+/** @file command_argument_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test runs commands that take a file name and checks that the name is
+	used as entered, in its own case, while the command name is not, and that
+	arguments are not added to the symbol table, so a long session of :save
+	and :load lines does not grow it. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/command_argument_test.cpp -o command_argument_test
+	./command_argument_test */
+
+#include "Calculator.h"
+#include "MemoryAccount.h"
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+
+namespace {
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a condition
+	@parm bool [condition] condition that must hold, std::string [what] what is checked*/
+	void check(bool condition, const std::string& what) {
+
+		std::cout << (condition ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += condition ? 0 : 1;
+
+	} // end of check
+
+	/** report runs a command line and gives what it printed
+	@parm Calculator [calc] calculator to run on, std::string [line] text of the line
+	@return the command's report*/
+	std::string report(Calculator& calc, const std::string& line) {
+
+		return calc.evaluate(line).text_;
+
+	} // end of report
+
+} // end namespace
+
+
+int main() {
+
+	namespace fs = std::filesystem;
+
+	fs::path directory = fs::temp_directory_path() / "command_argument_test";
+	fs::create_directories(directory);
+	std::string mixed = (directory / "Mixed.Case.img").string();
+	std::string lower = (directory / "mixed.case.img").string();
+	fs::remove(mixed);
+	fs::remove(lower);
+
+	Calculator calc;
+	calc.evaluate("x := 3");
+
+	// the file name keeps its case and the white space around it is dropped
+	check(report(calc, ":SAVE   " + mixed + "  \r") == "Saved Variables To " + mixed + "\n", "the command name is case insensitive");
+	check(fs::exists(mixed) && !fs::exists(lower), "the file name keeps its case");
+
+	calc.evaluate("x := 5");
+	check(report(calc, ":load " + mixed) == "Loaded Variables From " + mixed + "\n"
+		&& calc.evaluate("x").value_.toString() == "3", "the file saved is the file loaded");
+
+	// the echoed line holds the argument as entered
+	std::ostringstream out;
+	calc.echo(std::string_view(":Save " + mixed + "\n"), out);
+	check(out.str() == "Saved Variables To " + mixed + "\n", "the report names the file as entered");
+	check(report(calc, ":Nope Some Argument") == "Unknown Command, nope Some Argument Skipped\n",
+		"an unknown command shows its argument as entered");
+
+	// arguments never enter the symbol table
+	report(calc, ":load " + (directory / "missing-0.img").string());
+	std::uint64_t symbols = MemoryAccount::usage(MemoryAccount::Origin::symbols).allocations_;
+
+	for (int i = 1; i < 1000; ++i) {
+		report(calc, ":load " + (directory / ("missing-" + std::to_string(i) + ".img")).string());
+		report(calc, ":nope " + std::to_string(i));
+	} // end for
+
+	check(MemoryAccount::usage(MemoryAccount::Origin::symbols).allocations_ == symbols, "command arguments are not interned");
+
+	fs::remove_all(directory);
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
@@ -0,0 +1,165 @@
+/** @file deep_chain_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test builds, copies, simplifies, evaluates, prints and destroys a
+	chain of 10 million nodes on a thread with an 8 MiB stack, so a traversal
+	that recurses once per level crashes it. Build and run from the top
+	directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/deep_chain_test.cpp -o deep_chain_test
+	./deep_chain_test [terms]
+	The default 5 million terms need about 3 GB of memory */
+
+#include "AST.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "VariableStore.h"
+#include "LineArena.h"
+
+#include <pthread.h>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+
+namespace {
+
+	// terms of the chain, a chain of n terms is a tree of 2n - 1 nodes
+	std::uint64_t terms = 5000000;
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a failed condition
+	@parm bool [condition] condition that must hold, const char* [what] what is checked*/
+	void check(bool condition, const char* what) {
+
+		if (!condition) {
+			std::cerr << "FAIL: " << what << std::endl;
+			++failures;
+		} // end if
+
+	} // end of check
+
+	/** parse reads a single line that must be an expression
+	@parm std::string [line] text of the line, std::uint32_t [variable] set to the variable an assignment assigns
+	@return the line's expression*/
+	AST parse(const std::string& line, std::uint32_t& variable) {
+
+		Lexer lexer(line);
+		Parser parser(lexer);
+
+		check(parser.parseLine() == Parser::Kind::expression, "the line parses");
+		variable = parser.variable();
+
+		return parser.expression();
+
+	} // end of parse
+
+	/** chain builds the text of a left deep chain
+	@parm std::string [operand] text of each term
+	@return operand + operand + ... with terms operands*/
+	std::string chain(const std::string& operand) {
+
+		std::string line;
+		line.reserve(terms * (operand.size() + 3));
+		line += operand;
+
+		for (std::uint64_t i = 1; i < terms; ++i) {
+			line += " + ";
+			line += operand;
+		} // end for
+
+		return line;
+
+	} // end of chain
+
+	/** run does every step on the thread with the small stack
+	@return nullptr*/
+	void* run(void*) {
+
+		std::size_t liveBefore = AST::liveNodeCount();
+		std::uint32_t variable = 0;
+
+		{
+			LineArena::Scope scope;
+
+			// build
+			AST numbers = parse(chain("1"), variable);
+			check(numbers.expandedNodeCount() == 2 * terms - 1, "the chain has 2n - 1 nodes");
+
+			// copy
+			AST copy(numbers);
+			AST assigned;
+			assigned = copy;
+			check(assigned.uniqueNodeCount() == numbers.uniqueNodeCount(), "copies share the chain");
+
+			// evaluate
+			Integer value;
+			check(copy.calculate(value) == Program::Status::ok && value == Integer(static_cast<std::int64_t>(terms)),
+				"the chain of 1s adds up to n");
+
+			// print
+			std::string infix = assigned.toInfix();
+			check(infix.size() == 4 * terms - 3, "the infix text has every term");
+			check(numbers.toPostfix().size() == 4 * terms - 3, "the postfix text has every term");
+		}
+
+		{
+			LineArena::Scope scope;
+
+			VariableStore store;
+			std::vector<std::uint32_t> cycle;
+			AST x = parse("x := y * 2", variable);
+			check(store.assign(variable, x, cycle), "x is assigned");
+
+			// simplify to a chain still holding y
+			AST variables = parse(chain("x"), variable);
+			AST residual;
+			Integer value;
+			Program::Status status;
+			check(!store.partialEvaluate(variables, residual, value, status), "y is left in the chain");
+			check(residual.expandedNodeCount() == 4 * terms - 1, "every x is replaced by y * 2");
+			check(residual.toInfix().size() == 8 * terms - 3, "the residual prints every term");
+
+			// simplify to a value once y has one
+			AST y = parse("y := 5", variable);
+			check(store.assign(variable, y, cycle), "y is assigned");
+			check(store.partialEvaluate(variables, residual, value, status) && status == Program::Status::ok
+				&& value == Integer(static_cast<std::int64_t>(10 * terms)), "the chain of x adds up to 10n");
+		}
+
+		// destroy
+		check(AST::liveNodeCount() == liveBefore, "every node is freed");
+
+		return nullptr;
+
+	} // end of run
+
+} // end namespace
+
+
+int main(int argc, char* argv[]) {
+
+	if (argc > 1) {
+		terms = std::strtoull(argv[1], nullptr, 10);
+	} // end if
+
+	// the default stack of a Linux main thread
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, 8 * 1024 * 1024);
+
+	pthread_t thread;
+	if (pthread_create(&thread, &attributes, run, nullptr) != 0) {
+		std::cerr << "FAIL: cannot start the test thread" << std::endl;
+		return 1;
+	} // end if
+
+	pthread_join(thread, nullptr);
+	pthread_attr_destroy(&attributes);
+
+	std::cout << (failures == 0 ? "PASS" : "FAIL") << ": deep chain of " << 2 * terms - 1 << " nodes" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
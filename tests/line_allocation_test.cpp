@@ -0,0 +1,204 @@
+/** @file line_allocation_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test counts every call of the global operator new while a script
+	runs and checks that a line allocates nothing from the heap once the
+	calculator is warm: a script of 11000 lines must make exactly as many
+	allocations as one of 1000 lines. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/line_allocation_test.cpp -o line_allocation_test
+	./line_allocation_test */
+
+#include "Calculator.h"
+#include "ParseCache.h"
+
+#include <new>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+
+namespace {
+
+	// calls of the global operator new
+	std::uint64_t allocations = 0;
+
+	/** allocate counts one allocation
+	@parm std::size_t [bytes] bytes wanted
+	@return the memory*/
+	void* allocate(std::size_t bytes) {
+
+		++allocations;
+		void* pointer = std::malloc(bytes == 0 ? 1 : bytes);
+
+		if (pointer == nullptr) {
+			throw std::bad_alloc();
+		} // end if
+
+		return pointer;
+
+	} // end of allocate
+
+	/** allocateAligned counts one allocation with an alignment
+	@parm std::size_t [bytes] bytes wanted, std::align_val_t [alignment] alignment wanted
+	@return the memory*/
+	void* allocateAligned(std::size_t bytes, std::align_val_t alignment) {
+
+		++allocations;
+		std::size_t align = static_cast<std::size_t>(alignment);
+		void* pointer = std::aligned_alloc(align, (bytes + align - 1) / align * align);
+
+		if (pointer == nullptr) {
+			throw std::bad_alloc();
+		} // end if
+
+		return pointer;
+
+	} // end of allocateAligned
+
+	/** NullBuffer a stream buffer that drops what is written, so the output does not allocate*/
+	class NullBuffer : public std::streambuf {
+
+	protected:
+
+		int overflow(int c) override {
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char*, std::streamsize count) override {
+			return count;
+		}
+
+	};
+
+	/** script repeats lines
+	@parm std::function [line] text of the i-th line, int [count] lines to make
+	@return the script*/
+	std::string script(const std::function<std::string(int)>& line, int count) {
+
+		std::string text;
+		for (int i = 0; i < count; ++i) {
+			text += line(i);
+			text += '\n';
+		} // end for
+
+		return text;
+
+	} // end of script
+
+	/** perLine runs a script of 1000 lines and one of 11000 lines after a warm up run
+	@parm std::function [line] text of the i-th line, bool [cache] true to run with a parse cache
+	@return the allocations each of the extra 10000 lines made*/
+	double perLine(const std::function<std::string(int)>& line, bool cache) {
+
+		std::string small = script(line, 1000);
+		std::string large = script(line, 11000);
+		NullBuffer buffer;
+		std::ostream out(&buffer);
+
+		auto run = [&](const std::string& text) {
+			ParseCache parseCache(64);
+			Calculator calc;
+			if (cache) {
+				calc.setParseCache(&parseCache);
+			} // end if
+			calc.echo(std::string_view(text), out);
+		};
+
+		run(small);
+
+		std::uint64_t start = allocations;
+		run(small);
+		std::uint64_t middle = allocations;
+		run(large);
+		std::uint64_t end = allocations;
+
+		// what both runs allocate apart from their lines cancels out
+		return (static_cast<double>(end - middle) - static_cast<double>(middle - start)) / 10000.0;
+
+	} // end of perLine
+
+} // end namespace
+
+
+/** global operator new and delete, counted */
+void* operator new(std::size_t bytes) {
+	return allocate(bytes);
+}
+
+void* operator new[](std::size_t bytes) {
+	return allocate(bytes);
+}
+
+void* operator new(std::size_t bytes, std::align_val_t alignment) {
+	return allocateAligned(bytes, alignment);
+}
+
+void* operator new[](std::size_t bytes, std::align_val_t alignment) {
+	return allocateAligned(bytes, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+	std::free(pointer);
+}
+
+
+int main() {
+
+	struct Case {
+		const char* name_;
+		std::function<std::string(int)> line_;
+		bool cache_;
+	};
+
+	const Case cases[] = {
+		{ "the same line", [](int) { return std::string("12 + 34 * 5 - (6 - 7) / 2"); }, false },
+		{ "distinct lines", [](int i) { return std::to_string(i % 5000) + " + 34 * 5 - (6 - 7) / 2"; }, false },
+		{ "parse cache hits", [](int) { return std::string("12 + 34 * 5 - (6 - 7) / 2"); }, true },
+		{ "parse cache misses", [](int i) { return std::to_string(i % 5000) + " + 34 * 5 - (6 - 7) / 2"; }, true },
+	};
+
+	int failures = 0;
+
+	for (const Case& test : cases) {
+
+		double allocated = perLine(test.line_, test.cache_);
+		bool passed = (allocated == 0.0);
+
+		std::cout << (passed ? "PASS" : "FAIL") << ": " << test.name_ << ", " << allocated << " allocations per line" << std::endl;
+		failures += passed ? 0 : 1;
+
+	} // end for
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
@@ -0,0 +1,148 @@
+/** @file memory_account_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test checks the counts :mem reports: once the calculator is warm a
+	line must not make an allocation counted under any origin that takes
+	memory from the heap, and big numbers and the symbol table must be
+	counted and given back. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/memory_account_test.cpp -o memory_account_test
+	./memory_account_test */
+
+#include "Calculator.h"
+#include "MemoryAccount.h"
+#include "Token.h"
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+
+
+namespace {
+
+	using Origin = MemoryAccount::Origin;
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a condition
+	@parm bool [condition] condition that must hold, std::string [what] what is checked*/
+	void check(bool condition, const std::string& what) {
+
+		std::cout << (condition ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += condition ? 0 : 1;
+
+	} // end of check
+
+	/** NullBuffer a stream buffer that drops what is written*/
+	class NullBuffer : public std::streambuf {
+
+	protected:
+
+		int overflow(int c) override {
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char*, std::streamsize count) override {
+			return count;
+		}
+
+	};
+
+	/** run runs a script on a new calculator
+	@parm std::string [text] the script*/
+	void run(const std::string& text) {
+
+		NullBuffer buffer;
+		std::ostream out(&buffer);
+		Calculator calc;
+		calc.echo(std::string_view(text), out);
+
+	} // end of run
+
+	/** script makes count distinct expression lines
+	@parm int [count] lines to make
+	@return the script*/
+	std::string script(int count) {
+
+		std::string text;
+		for (int i = 0; i < count; ++i) {
+			text += std::to_string(i % 5000) + " + 34 * 5 - (6 - 7) / 2 + 2 ^ 70 / 2 ^ 68\n";
+		} // end for
+
+		return text;
+
+	} // end of script
+
+	/** allocations
+	@parm Origin [origin] origin to read
+	@return the allocations counted under it*/
+	std::uint64_t allocations(Origin origin) {
+
+		return MemoryAccount::usage(origin).allocations_;
+
+	} // end of allocations
+
+	/** current
+	@parm Origin [origin] origin to read
+	@return the bytes in use counted under it*/
+	std::uint64_t current(Origin origin) {
+
+		return MemoryAccount::usage(origin).current_;
+
+	} // end of current
+
+} // end namespace
+
+
+int main() {
+
+	// the origins that take memory from the heap, nodes, layouts and intern table entries come from the node pool
+	const std::pair<Origin, const char*> heapOrigins[] = {
+		{ Origin::programs, "programs" }, { Origin::bigNumbers, "big numbers" }, { Origin::symbols, "symbols" },
+		{ Origin::nodePool, "node pool" }, { Origin::lineScratch, "line scratch" }
+	};
+
+	// a warm calculator makes no heap allocation per line: 11000 lines allocate what 1000 lines do
+	std::string small = script(1000);
+	std::string large = script(11000);
+	run(small);
+
+	for (const auto& origin : heapOrigins) {
+
+		std::uint64_t start = allocations(origin.first);
+		run(small);
+		std::uint64_t middle = allocations(origin.first);
+		run(large);
+		std::uint64_t end = allocations(origin.first);
+
+		check(end - middle == middle - start, std::string(origin.second) + " allocations do not grow with the lines");
+
+	} // end for
+
+	// a big number is counted while a token holds it and given back with the last token
+	std::uint64_t bigBefore = current(Origin::bigNumbers);
+	std::uint64_t bigAllocations = allocations(Origin::bigNumbers);
+	{
+		NullBuffer buffer;
+		std::ostream out(&buffer);
+		Calculator calc;
+		calc.echo(std::string_view("x := 123456789012345678901234567890 * y\n"), out);
+		check(current(Origin::bigNumbers) > bigBefore, "a stored big number is counted");
+
+		std::string lines;
+		for (int i = 0; i < 1000; ++i) {
+			lines += std::to_string(i) + "123456789012345678901234567890 * 3\n";
+		} // end for
+		calc.echo(std::string_view(lines), out);
+		check(allocations(Origin::bigNumbers) >= bigAllocations + 1001, "every big literal is counted");
+	}
+	check(current(Origin::bigNumbers) == bigBefore, "big numbers are given back");
+
+	// the symbol table is counted as it grows
+	std::uint64_t symbolsBefore = current(Origin::symbols);
+	Token::internSymbol("a_name_never_used_before_by_this_test");
+	check(current(Origin::symbols) > symbolsBefore, "the symbol table is counted");
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
@@ -0,0 +1,94 @@
+/** @file parallel_echo_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test runs scripts through echo one line at a time and through the
+	parallel echo on a pool, and checks that both print the same text, for
+	scripts whose commands take file names with a "." in them and scripts
+	that a "." ends early. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/parallel_echo_test.cpp -o parallel_echo_test
+	./parallel_echo_test */
+
+#include "Calculator.h"
+#include "ResultSink.h"
+#include "WorkStealingPool.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+
+namespace {
+
+	// checks that failed
+	int failures = 0;
+
+	/** sequential runs a script one line at a time on a new calculator
+	@parm std::string [script] the script
+	@return the text echo printed*/
+	std::string sequential(const std::string& script) {
+
+		std::ostringstream out;
+		Calculator calc;
+		calc.echo(std::string_view(script), out);
+
+		return out.str();
+
+	} // end of sequential
+
+	/** parallel runs a script with the parallel echo on a new calculator
+	@parm std::string [script] the script, std::size_t [threads] workers of the pool
+	@return the text echo printed*/
+	std::string parallel(const std::string& script, std::size_t threads) {
+
+		std::ostringstream out;
+		{
+			WorkStealingPool pool(threads);
+			Calculator calc;
+			TextSink sink(out);
+			calc.echo(std::string_view(script), pool, sink);
+		}
+
+		return out.str();
+
+	} // end of parallel
+
+	/** same checks that the parallel echo prints what echo does and that the script got as far as expected
+	@parm std::string [script] the script, std::string [last] text the output must end with, const char* [what] what is checked*/
+	void same(const std::string& script, const std::string& last, const char* what) {
+
+		std::string expected = sequential(script);
+		bool passed = expected.size() >= last.size() && expected.compare(expected.size() - last.size(), last.size(), last) == 0;
+
+		for (std::size_t threads : { 1, 2, 4 }) {
+			passed = passed && parallel(script, threads) == expected;
+		} // end for
+
+		std::cout << (passed ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += passed ? 0 : 1;
+
+	} // end of same
+
+} // end namespace
+
+
+int main() {
+
+	std::string image = (std::filesystem::temp_directory_path() / "parallel_echo_test.img").string();
+
+	same("x := 3\nx + 1\n:save " + image + "\nx * 2\nx - 1\n.\n",
+		"out [4]: 2\n", "a file name with a \".\" does not end the script");
+	same("x := 3\n:save " + image + "\nx := 5\nx + 1\n:load " + image + "\nx + 1\nx * y\n",
+		"out [5]: 3 * y\n", "lines after :save and :load run on the variables as loaded");
+	same("x := 3\nx + 1\nx + 2 . x + 3\nx + 4\n",
+		"out [3]: 5\n", "a \".\" token ends the script on its line");
+	same("x := 3\nx + ) .\nx + 4\n", "Syntax Error At Column 5, Expression Skipped\n",
+		"a \".\" after a syntax error ends the script");
+	same("x := 3\n:unknown a.b\nx + 4\n.\nx + 5\n", "out [2]: 7\n", "an unknown command's argument is not read for a \".\"");
+
+	std::remove(image.c_str());
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
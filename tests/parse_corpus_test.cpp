@@ -0,0 +1,88 @@
+/** @file parse_corpus_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test parses every line of tests/parse_corpus.txt and checks that the
+	parser accepts it and builds the tree given, or rejects it at the column
+	given. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/parse_corpus_test.cpp -o parse_corpus_test
+	./parse_corpus_test [corpus] */
+
+#include "AST.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+int main(int argc, char* argv[]) {
+
+	const char* corpusName = (argc > 1) ? argv[1] : "tests/parse_corpus.txt";
+	std::ifstream corpus(corpusName);
+
+	if (!corpus) {
+		std::cerr << "FAIL: cannot open " << corpusName << std::endl;
+		return 1;
+	} // end if
+
+	std::string entry;
+	std::size_t lineNumber = 0;
+	std::size_t checked = 0;
+	std::size_t failures = 0;
+
+	while (std::getline(corpus, entry)) {
+
+		++lineNumber;
+		if (entry.empty() || entry[0] == '#') {
+			continue;
+		} // end if
+
+		// expected result, line and tree are separated by tabs
+		std::size_t first = entry.find('\t');
+		std::size_t second = (first == std::string::npos) ? first : entry.find('\t', first + 1);
+
+		if (second == std::string::npos) {
+			std::cerr << corpusName << ":" << lineNumber << ": FAIL: not three fields" << std::endl;
+			++failures;
+			continue;
+		} // end if
+
+		std::string expected = entry.substr(0, first);
+		std::string line = entry.substr(first + 1, second - first - 1);
+		std::string tree = entry.substr(second + 1);
+
+		Lexer lexer(line);
+		Parser parser(lexer);
+
+		std::string result;
+		std::string built;
+
+		if (parser.parseLine() == Parser::Kind::expression) {
+
+			result = "ok";
+			if (parser.isAssignment()) {
+				built = std::string(Token::symbolName(parser.variable())) + " := ";
+			} // end if
+			built += parser.expression().toPostfix();
+
+		}
+		else {
+			result = std::to_string(parser.errorColumn());
+		} // end if
+
+		if (result != expected || built != tree) {
+			std::cerr << corpusName << ":" << lineNumber << ": FAIL: [" << line << "] expected " << expected << " " << tree
+				<< ", got " << result << " " << built << std::endl;
+			++failures;
+		} // end if
+
+		++checked;
+
+	} // end while
+
+	std::cout << (failures == 0 ? "PASS" : "FAIL") << ": " << checked - failures << " of " << checked << " corpus lines" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
@@ -0,0 +1,134 @@
+/** @file partial_evaluate_bench.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This benchmark times lines that read chains of assigned variables, like the
+	z := x + y example of the README, through partial evaluation: queries that
+	fold to a number, queries that leave a residual, and queries after the end
+	of a chain is reassigned. It checks each answer before timing it and prints
+	the time per line. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/partial_evaluate_bench.cpp -o partial_evaluate_bench
+	./partial_evaluate_bench [lines] */
+
+#include "Calculator.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+	// lines timed for each workload
+	std::uint64_t lines = 200000;
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a condition
+	@parm bool [condition] condition that must hold, std::string [what] what is checked*/
+	void check(bool condition, const std::string& what) {
+
+		std::cout << (condition ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += condition ? 0 : 1;
+
+	} // end of check
+
+	/** answer runs a line and gives its result as text
+	@parm Calculator [calc] calculator to run on, std::string [line] text of the line
+	@return the value, the residual expression or the error of the line*/
+	std::string answer(Calculator& calc, const std::string& line) {
+
+		Calculator::Result result = calc.evaluate(line);
+
+		switch (result.kind_) {
+		case Calculator::Result::Kind::value:
+			return result.value_.toString();
+		case Calculator::Result::Kind::expression:
+			return result.expression_.toInfix();
+		default:
+			return "error " + result.text_;
+		} // end switch
+
+	} // end of answer
+
+	/** setUp runs lines whose answers are not checked
+	@parm Calculator [calc] calculator to run on, std::vector<std::string> [script] lines to run*/
+	void setUp(Calculator& calc, const std::vector<std::string>& script) {
+
+		for (const std::string& line : script) {
+			calc.evaluate(line);
+		} // end for
+
+	} // end of setUp
+
+	/** time runs the queries in turn until lines lines have run and prints the time per line
+	@parm Calculator [calc] calculator to run on, std::vector<std::string> [queries] lines to run in turn,
+	const char* [name] name of the workload*/
+	void time(Calculator& calc, const std::vector<std::string>& queries, const char* name) {
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (std::uint64_t i = 0; i < lines; ++i) {
+			calc.evaluate(queries[i % queries.size()]);
+		} // end for
+
+		auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+		std::cout << name << ": " << lines << " lines, " << elapsed.count() / static_cast<std::int64_t>(lines)
+			<< " ns per line" << std::endl;
+
+	} // end of time
+
+} // end namespace
+
+
+int main(int argc, char* argv[]) {
+
+	if (argc > 1) {
+		lines = std::strtoull(argv[1], nullptr, 10);
+	} // end if
+
+	// the chain of the README, x = 1, y = 8, z = 9, w = 19, v = 40
+	Calculator readme;
+	setUp(readme, { "x := 1", "z := x + y", "y := 8", "w := z * 2 + x", "v := (w - z) * (x + 3)" });
+
+	check(answer(readme, "z") == "9", "z := x + y folds to 9");
+	check(answer(readme, "z * w - v") == "131", "a query over the chain folds to a number");
+	check(answer(readme, "(z + q) * (w - 2) + v") == "( 9 + q ) * 17 + 40", "a query with a free variable folds around it");
+	check(answer(readme, "v - w * 3") == "-17", "a closed query with a negative value is a number");
+
+	time(readme, { "z", "x + 8", "z * w - v", "z * z + w * w + v * v" }, "README chain, numbers");
+	time(readme, { "(z + q) * (w - 2) + v", "w + k", "z * q - v" }, "README chain, residuals");
+
+	// a chain through every letter from a to x, each adding y, so x = 24 * y + 1
+	Calculator letters;
+	std::vector<std::string> chain = { "a := y + 1" };
+	for (char name = 'b'; name <= 'x'; ++name) {
+		chain.push_back(std::string(1, name) + " := " + std::string(1, name - 1) + " + y");
+	} // end for
+	setUp(letters, chain);
+
+	std::string residual = answer(letters, "x * 2 + z");
+	check(residual.find('y') != std::string::npos && residual.find('w') == std::string::npos,
+		"a chain with y free is substituted down to y");
+	time(letters, { "x", "x * 2 + z", "m + n" }, "letter chain, residuals");
+
+	setUp(letters, { "y := 3" });
+	check(answer(letters, "x") == "73", "the chain folds to 24 * y + 1 once y is assigned");
+	check(answer(letters, "x - 100 + z") == "0 - 27 + z", "a negative part of a residual is written 0 - n");
+	time(letters, { "x", "x * 2 + z", "m + n" }, "letter chain, numbers");
+
+	// reassigning the end of the chain drops every cached value above it
+	std::vector<std::string> reassigned;
+	for (int i = 1; i <= 8; ++i) {
+		reassigned.push_back("y := " + std::to_string(i));
+		reassigned.push_back("x * 2 + z");
+	} // end for
+	time(letters, reassigned, "letter chain, y reassigned every other line");
+	check(answer(letters, "x") == "193", "the last reassignment is read");
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
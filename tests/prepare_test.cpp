@@ -0,0 +1,89 @@
+/** @file prepare_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test prepares expressions through the library API and checks how
+	parameters are named: a single letter of either case, each given once.
+	Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/prepare_test.cpp -o prepare_test
+	./prepare_test */
+
+#include "Calculator.h"
+#include "MemoryAccount.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace {
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a condition
+	@parm bool [condition] condition that must hold, std::string [what] what is checked*/
+	void check(bool condition, const std::string& what) {
+
+		std::cout << (condition ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += condition ? 0 : 1;
+
+	} // end of check
+
+	/** evaluates prepares an expression and evaluates it once
+	@parm Calculator [calc] calculator to prepare with, std::string [expression] expression,
+	std::vector<std::string> [parameters] parameter names, std::vector<std::int64_t> [values] their values,
+	std::string [expected] value expected as text
+	@return true if the expression was prepared and has the value expected*/
+	bool evaluates(Calculator& calc, const std::string& expression, const std::vector<std::string>& parameters,
+		const std::vector<std::int64_t>& values, const std::string& expected) {
+
+		Calculator::Prepared prepared;
+		std::string error;
+		Integer result;
+
+		return calc.prepare(expression, parameters, prepared, error) && prepared.parameterCount() == values.size()
+			&& prepared.evaluate(values.data(), result) == Program::Status::ok && result.toString() == expected;
+
+	} // end of evaluates
+
+	/** refuses prepares an expression that must not be prepared
+	@parm Calculator [calc] calculator to prepare with, std::string [expression] expression,
+	std::vector<std::string> [parameters] parameter names, std::string [expected] start of the error expected
+	@return true if the expression was refused with the error expected*/
+	bool refuses(Calculator& calc, const std::string& expression, const std::vector<std::string>& parameters,
+		const std::string& expected) {
+
+		Calculator::Prepared prepared;
+		std::string error;
+
+		return !calc.prepare(expression, parameters, prepared, error) && error.compare(0, expected.size(), expected) == 0;
+
+	} // end of refuses
+
+} // end namespace
+
+
+int main() {
+
+	Calculator calc;
+	calc.evaluate("a := 5");
+	calc.evaluate("b := a * x");
+
+	check(evaluates(calc, "x + 1", { "x" }, { 41 }, "42"), "a parameter is read from the values");
+	check(evaluates(calc, "x + 1", { "X" }, { 41 }, "42"), "a parameter name is case insensitive");
+	check(evaluates(calc, "b + y", { "x", "Y" }, { 2, 3 }, "13"), "a stored variable is substituted around its parameters");
+	check(evaluates(calc, "a * x", { "A", "x" }, { 7, 2 }, "14"), "a parameter replaces a stored variable");
+	check(refuses(calc, "x + 1", { "xx" }, "Parameter \"xx\" Is Not A Variable"), "a longer name is refused");
+	check(refuses(calc, "x + 1", { "" }, "Parameter \"\" Is Not A Variable"), "an empty name is refused");
+	check(refuses(calc, "x + 1", { "1" }, "Parameter \"1\" Is Not A Variable"), "a digit is refused");
+	check(refuses(calc, "x + y", { "x", "X" }, "Parameter x Is Given Twice"), "a parameter given twice is refused");
+	check(refuses(calc, "x + y", { "x" }, "Variable y Has No Value"), "a free variable that is not a parameter is refused");
+
+	// a refused name is not added to the symbol table
+	std::uint64_t symbolAllocations = MemoryAccount::usage(MemoryAccount::Origin::symbols).allocations_;
+	refuses(calc, "x + 1", { "a_name_never_interned" }, "Parameter");
+	check(MemoryAccount::usage(MemoryAccount::Origin::symbols).allocations_ == symbolAllocations, "a refused name is not interned");
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main
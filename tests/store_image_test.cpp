@@ -0,0 +1,197 @@
+/** @file store_image_test.cpp
+ @author Anthony Campos
+ @date 12/07/2021
+ This test saves a store, changes the image the way a bad writer could and
+	writes a checksum that matches again, then checks that :load refuses it as
+	corrupt: a status out of range, references that are not the variables the
+	nodes read, references that make a cycle and a name that is not a
+	variable. Build and run from the top directory with
+	g++ -std=c++17 -O2 -pthread -I. $(ls *.cpp | grep -v main.cpp) tests/store_image_test.cpp -o store_image_test
+	./store_image_test */
+
+#include "Calculator.h"
+#include "StoreImage.h"
+#include "Token.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+
+namespace {
+
+	// checks that failed
+	int failures = 0;
+
+	/** check counts and reports a condition
+	@parm bool [condition] condition that must hold, std::string [what] what is checked*/
+	void check(bool condition, const std::string& what) {
+
+		std::cout << (condition ? "PASS" : "FAIL") << ": " << what << std::endl;
+		failures += condition ? 0 : 1;
+
+	} // end of check
+
+	/** Image Struct the arrays of an image file read into memory*/
+	struct Image {
+
+		std::string bytes_;
+		StoreImage::Header* head_ = nullptr;
+		StoreImage::Text* symbols_ = nullptr;
+		StoreImage::Variable* variables_ = nullptr;
+		StoreImage::Node* nodes_ = nullptr;
+		std::uint32_t* references_ = nullptr;
+		char* text_ = nullptr;
+
+		/** symbol
+		@parm char [name] letter of a variable
+		@return its index in the symbols*/
+		std::uint32_t symbol(char name) const {
+
+			for (std::uint32_t i = 0; i < head_->symbolCount_; ++i) {
+				if (text_[symbols_[i].offset_] == name) {
+					return i;
+				} // end if
+			} // end for
+
+			return UINT32_MAX;
+
+		} // end of symbol
+
+		/** variable
+		@parm char [name] letter of an assigned variable
+		@return its record*/
+		StoreImage::Variable& variable(char name) const {
+
+			std::uint32_t index = 0;
+			while (variables_[index].symbol_ != symbol(name)) {
+				++index;
+			} // end while
+
+			return variables_[index];
+
+		} // end of variable
+
+	};
+
+	/** read reads an image and points the arrays into it, in the order StoreImage writes them
+	@parm std::string [fileName] image to read, Image [image] image read*/
+	void read(const std::string& fileName, Image& image) {
+
+		std::ifstream file(fileName, std::ios::binary);
+		image.bytes_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		auto aligned = [](std::uint64_t bytes) { return (bytes + 7) / 8 * 8; };
+		char* at = image.bytes_.data();
+		image.head_ = reinterpret_cast<StoreImage::Header*>(at);
+		at += sizeof(StoreImage::Header);
+		image.symbols_ = reinterpret_cast<StoreImage::Text*>(at);
+		at += aligned(image.head_->symbolCount_ * sizeof(StoreImage::Text));
+		at += aligned(image.head_->bigCount_ * sizeof(StoreImage::Text));
+		image.variables_ = reinterpret_cast<StoreImage::Variable*>(at);
+		at += aligned(image.head_->variableCount_ * sizeof(StoreImage::Variable));
+		image.nodes_ = reinterpret_cast<StoreImage::Node*>(at);
+		at += aligned(image.head_->nodeCount_ * sizeof(StoreImage::Node));
+		image.references_ = reinterpret_cast<std::uint32_t*>(at);
+		at += aligned(image.head_->referenceCount_ * sizeof(std::uint32_t));
+		image.text_ = at;
+
+	} // end of read
+
+	/** write writes an image with a checksum of what it now holds
+	@parm Image [image] image to write, std::string [fileName] file to write*/
+	void write(Image& image, const std::string& fileName) {
+
+		image.head_->checksum_ = StoreImage::checksum(image.bytes_.data() + sizeof(StoreImage::Header),
+			image.bytes_.size() - sizeof(StoreImage::Header));
+
+		std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+		file.write(image.bytes_.data(), static_cast<std::streamsize>(image.bytes_.size()));
+
+	} // end of write
+
+	/** refused changes a copy of an image and checks that loading it is refused as corrupt
+	@parm std::string [good] image to change, std::string [bad] file to write the copy to,
+	std::function [change] change to make, std::string [what] what is checked*/
+	void refused(const std::string& good, const std::string& bad, const std::function<void(Image&)>& change, const std::string& what) {
+
+		Image image;
+		read(good, image);
+		change(image);
+		write(image, bad);
+
+		Calculator calc;
+		std::string report = calc.evaluate(":load " + bad).text_;
+		check(report.find(StoreImage::corruptError) != std::string::npos, what);
+
+	} // end of refused
+
+} // end namespace
+
+
+int main() {
+
+	namespace fs = std::filesystem;
+
+	fs::path directory = fs::temp_directory_path() / "store_image_test";
+	fs::create_directories(directory);
+	std::string good = (directory / "good.img").string();
+	std::string bad = (directory / "bad.img").string();
+
+	// x reads y, y reads the free variable z, d failed when it was saved
+	{
+		Calculator calc;
+		calc.evaluate("x := y + 1");
+		calc.evaluate("y := z * 2");
+		calc.evaluate("c := 0");
+		calc.evaluate("d := 1 / c");
+		check(calc.evaluate(":save " + good).text_ == "Saved Variables To " + good + "\n", "the store is saved");
+	}
+
+	// the image as written loads, and rewriting its checksum changes nothing
+	{
+		Image image;
+		read(good, image);
+		write(image, bad);
+
+		Calculator calc;
+		check(calc.evaluate(":load " + bad).text_ == "Loaded Variables From " + bad + "\n"
+			&& calc.evaluate("x").expression_.toInfix() == "z * 2 + 1", "an image as written loads");
+	}
+
+	refused(good, bad, [](Image& image) { image.variable('d').status_ = 9; }, "a status out of range is refused");
+
+	refused(good, bad, [](Image& image) { image.variable('x').closed_ = 2; }, "a closed flag out of range is refused");
+
+	refused(good, bad, [](Image& image) {
+		StoreImage::Variable& x = image.variable('x');
+		image.references_[x.firstReference_] = image.symbol('z');
+	}, "references that are not the variables the nodes read are refused");
+
+	refused(good, bad, [](Image& image) {
+		// y reads x instead of z in its nodes and references, so x and y read each other
+		StoreImage::Variable& y = image.variable('y');
+		for (std::uint32_t i = 0; i < y.nodeCount_; ++i) {
+			StoreImage::Node& node = image.nodes_[y.firstNode_ + i];
+			if (static_cast<TokType>(node.type_) == TokType::variable) {
+				node.payload_ = image.symbol('x');
+			} // end if
+		} // end for
+		image.references_[y.firstReference_] = image.symbol('x');
+	}, "references that make a cycle are refused");
+
+	refused(good, bad, [](Image& image) { image.text_[image.symbols_[image.symbol('z')].offset_] = 'x'; },
+		"a variable named twice is refused");
+
+	refused(good, bad, [](Image& image) { image.text_[image.symbols_[image.symbol('z')].offset_] = '_'; },
+		"a name that is not a variable is refused");
+
+	fs::remove_all(directory);
+
+	return failures == 0 ? 0 : 1;
+
+} // end of main